@@ -0,0 +1,645 @@
+// Microbenchmarks for the AyaMath primitives.
+//
+// The same file is built twice, once as is and once with AYA_BENCH_SCALAR defined, which
+// drops AYA_USE_SIMD after Config.h so the headers take their scalar paths:
+//
+//   AyaBench --csv simd.csv --dump simd.dump
+//   AyaBench_scalar --csv scalar.csv --dump scalar.dump
+//   AyaBench --compare simd.dump scalar.dump [tolerance]
+//
+// bench/CMakeLists.txt builds both executables and runs these three steps as ctest tests.
+//
+// Every operation reports the latency of a dependent chain (the result feeds the next call,
+// through at most one add or select of glue) and the throughput of independent calls over
+// an array, both in ns per call. --dump writes the outputs of the throughput run, --compare
+// checks two dumps element by element and exits non-zero when they disagree.
+//
+// Every header of src/ is included and exercised here (BBox8 and Vector3x8 only in AVX builds,
+// their entries fall back to pairs of 4-wide packets otherwise), so building it once at -O0 (or
+// with -fsanitize=address,undefined) turns members that are ODR-used without a definition into
+// link errors.
+
+#include "../Core/Config.h"
+#if defined(AYA_BENCH_SCALAR)
+#undef AYA_USE_SIMD
+#endif
+
+#include "../src/Transform.h"
+#include "../src/Quaternion.h"
+#include "../src/CpuFeatures.h"
+#include "../src/SimdMath.h"
+#include "../src/DirectionMap.h"
+#include "../src/Frame.h"
+#include "../src/Warp.h"
+#include "../src/Memory.h"
+#include "../src/AnimatedTransform.h"
+#include "../src/Transformd.h"
+#include "../src/Quaternionx4.h"
+#include "../src/Framex4.h"
+#include "../src/BBox4.h"
+#include "../src/BBox8.h"
+#include "../src/QBBox.h"
+#include "../src/BVH.h"
+#include "../src/OctNormal.h"
+#include "../src/SpatialKey.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Aya {
+	namespace Bench {
+#if defined(AYA_USE_SIMD)
+		static const char *s_mode = "simd";
+#else
+		static const char *s_mode = "scalar";
+#endif
+		static const size_t s_count = 4096;
+		static const int s_repeats = 200;
+
+		// Keeps a value alive without letting the compiler see through it
+		template<class T>
+		AYA_FORCE_INLINE void DoNotOptimize(const T &v) {
+#if defined(_MSC_VER)
+			static volatile char sink;
+			sink = *(const volatile char *)&v;
+#else
+			__asm__ volatile("" : : "r,m"(v) : "memory");
+#endif
+		}
+
+		// Best time over s_repeats runs of func, in ns per call
+		template<class Func>
+		double TimeBest(const size_t &calls, const Func &func) {
+			double best = 1e30;
+			for (int r = 0; r < s_repeats; r++) {
+				auto start = std::chrono::steady_clock::now();
+				func();
+				auto stop = std::chrono::steady_clock::now();
+				best = Min(best, std::chrono::duration<double, std::nano>(stop - start).count());
+			}
+			return best / double(calls);
+		}
+
+		class Inputs {
+		public:
+			std::vector<Vector3> m_a, m_b;
+			std::vector<Point3> m_p;
+			std::vector<float> m_t;
+			std::vector<Quaternion> m_q0, m_q1;
+			std::vector<Matrix3x3> m_m3;
+			std::vector<Matrix4x4> m_m4;
+			std::vector<BBox> m_box;
+			std::vector<Ray> m_ray;
+			Transform m_transform;
+
+			Inputs() {
+				std::mt19937 gen(0x41796141);
+				std::uniform_real_distribution<float> U(-1.f, 1.f);
+				auto vec = [&]() { return Vector3(U(gen), U(gen), U(gen)); };
+				auto quat = [&]() {
+					Quaternion q(U(gen), U(gen), U(gen), U(gen));
+					return q / q.length();
+				};
+
+				for (size_t i = 0; i < s_count; i++) {
+					m_a.push_back(vec());
+					m_b.push_back(vec());
+					m_p.push_back(Point3(U(gen), U(gen), U(gen)) * 4.f);
+					m_t.push_back(0.5f + 0.5f * U(gen));
+					m_q0.push_back(quat());
+					m_q1.push_back(quat());
+
+					// diagonally dominant, so the inverses are well conditioned in both modes
+					Matrix3x3 m3;
+					Matrix4x4 m4;
+					for (int r = 0; r < 4; r++)
+						for (int c = 0; c < 4; c++) {
+							float v = U(gen) * 0.25f + (r == c ? 2.f : 0.f);
+							if (r < 3 && c < 3) m3[r][c] = v;
+							m4[r][c] = v;
+						}
+					m_m3.push_back(m3);
+					m_m4.push_back(m4);
+
+					Point3 c(U(gen), U(gen), U(gen));
+					Vector3 e(0.1f + 0.5f * Abs(U(gen)), 0.1f + 0.5f * Abs(U(gen)), 0.1f + 0.5f * Abs(U(gen)));
+					m_box.push_back(BBox(c - e, c + e));
+					m_ray.push_back(Ray(Point3(U(gen), U(gen), U(gen)) * 3.f, vec().normalize()));
+				}
+
+				Matrix4x4 m(0.8f, -0.3f, 0.2f, 1.5f,
+					0.4f, 0.9f, -0.1f, -2.f,
+					-0.2f, 0.3f, 1.1f, 0.5f,
+					0.f, 0.f, 0.f, 1.f);
+				m_transform = Transform(m);
+			}
+		};
+
+		class Result {
+		public:
+			std::string m_name;
+			double m_latency, m_throughput;
+			std::vector<float> m_values;
+		};
+
+		// Registers one operation. chain(i) advances the dependent chain by one call,
+		// single(i, out) evaluates call i independently and appends its output floats.
+		template<class Chain, class Single>
+		Result Run(const char *name, const Chain &chain, const Single &single) {
+			Result res;
+			res.m_name = name;
+			res.m_latency = TimeBest(s_count, [&]() {
+				for (size_t i = 0; i < s_count; i++)
+					chain(i);
+			});
+
+			std::vector<float> scratch;
+			scratch.reserve(s_count * 8);
+			res.m_throughput = TimeBest(s_count, [&]() {
+				scratch.clear();
+				for (size_t i = 0; i < s_count; i++)
+					single(i, scratch);
+				DoNotOptimize(scratch.data());
+			});
+			res.m_values = scratch;
+			return res;
+		}
+
+		AYA_FORCE_INLINE void Push(std::vector<float> &out, const BaseVector3 &v) {
+			out.push_back(v.x());
+			out.push_back(v.y());
+			out.push_back(v.z());
+		}
+		AYA_FORCE_INLINE void Push(std::vector<float> &out, const Quaternion &q) {
+			out.push_back(q.x());
+			out.push_back(q.y());
+			out.push_back(q.z());
+			out.push_back(q.w());
+		}
+
+		std::vector<Result> RunAll(const Inputs &in) {
+			std::vector<Result> results;
+
+			Vector3 v = in.m_a[0];
+			float s = 0.f;
+			results.push_back(Run("vector3.dot3",
+				[&](const size_t &i) { s = in.m_a[i].dot(in.m_b[i] + Vector3(s, s, s)) * 0.25f; DoNotOptimize(s); },
+				[&](const size_t &i, std::vector<float> &out) { out.push_back(in.m_a[i].dot(in.m_b[i])); }));
+			results.push_back(Run("vector3.cross",
+				[&](const size_t &i) { v = v.cross(in.m_a[i]) + in.m_b[i]; DoNotOptimize(v); },
+				[&](const size_t &i, std::vector<float> &out) { Push(out, in.m_a[i].cross(in.m_b[i])); }));
+			results.push_back(Run("vector3.normalize",
+				[&](const size_t &i) { v = (v + in.m_a[i]).normalize(); DoNotOptimize(v); },
+				[&](const size_t &i, std::vector<float> &out) { Push(out, in.m_a[i].normalize()); }));
+
+			Matrix3x3 m3 = in.m_m3[0];
+			results.push_back(Run("matrix3x3.mul",
+				[&](const size_t &i) { m3 = (m3 * in.m_m3[i]) * 0.5f; DoNotOptimize(m3); },
+				[&](const size_t &i, std::vector<float> &out) {
+					Matrix3x3 r = in.m_m3[i] * in.m_m3[(i + 1) % s_count];
+					for (int k = 0; k < 3; k++) Push(out, r[k]);
+				}));
+			Matrix4x4 m4 = in.m_m4[0];
+			results.push_back(Run("matrix4x4.mul",
+				[&](const size_t &i) { m4 = (m4 * in.m_m4[i]) * 0.5f; DoNotOptimize(m4); },
+				[&](const size_t &i, std::vector<float> &out) {
+					Matrix4x4 r = in.m_m4[i] * in.m_m4[(i + 1) % s_count];
+					for (int k = 0; k < 4; k++) for (int c = 0; c < 4; c++) out.push_back(r[k][c]);
+				}));
+			results.push_back(Run("matrix4x4.inverse",
+				[&](const size_t &i) { m4 = (i & 1) ? m4.inverse() : in.m_m4[i].inverse(); DoNotOptimize(m4); },
+				[&](const size_t &i, std::vector<float> &out) {
+					Matrix4x4 r = in.m_m4[i].inverse();
+					for (int k = 0; k < 4; k++) for (int c = 0; c < 4; c++) out.push_back(r[k][c]);
+				}));
+
+			Quaternion q = in.m_q0[0];
+			results.push_back(Run("quaternion.mul",
+				[&](const size_t &i) { q = q * in.m_q0[i]; DoNotOptimize(q); },
+				[&](const size_t &i, std::vector<float> &out) { Push(out, in.m_q0[i] * in.m_q1[i]); }));
+			results.push_back(Run("quaternion.slerp",
+				[&](const size_t &i) { q = q.slerp(in.m_q1[i], in.m_t[i]); DoNotOptimize(q); },
+				[&](const size_t &i, std::vector<float> &out) { Push(out, in.m_q0[i].slerp(in.m_q1[i], in.m_t[i])); }));
+
+			float c = 0.f;
+			results.push_back(Run("simdmath.sincos",
+				[&](const size_t &i) { SimdMath::sincos(in.m_t[i] * 8.f + s, &s, &c); DoNotOptimize(c); },
+				[&](const size_t &i, std::vector<float> &out) {
+					float sv, cv;
+					SimdMath::sincos(in.m_a[i].x() * 10.f, &sv, &cv);
+					out.push_back(sv);
+					out.push_back(cv);
+				}));
+			results.push_back(Run("simdmath.atan2",
+				[&](const size_t &i) { s = SimdMath::atan2(in.m_a[i].y() + s, in.m_a[i].x()); DoNotOptimize(s); },
+				[&](const size_t &i, std::vector<float> &out) { out.push_back(SimdMath::atan2(in.m_a[i].y(), in.m_a[i].x())); }));
+			results.push_back(Run("simdmath.acos",
+				[&](const size_t &i) { s = SimdMath::acos(in.m_a[i].x() * (s - 2.f) * 0.2f); DoNotOptimize(s); },
+				[&](const size_t &i, std::vector<float> &out) { out.push_back(SimdMath::acos(in.m_a[i].x())); }));
+			results.push_back(Run("simdmath.exp",
+				[&](const size_t &i) { s = SimdMath::exp(in.m_a[i].x() - s); DoNotOptimize(s); },
+				[&](const size_t &i, std::vector<float> &out) { out.push_back(SimdMath::exp(in.m_a[i].x() * 20.f)); }));
+			results.push_back(Run("simdmath.log",
+				[&](const size_t &i) { s = SimdMath::log(in.m_t[i] + 1.f + s); DoNotOptimize(s); },
+				[&](const size_t &i, std::vector<float> &out) { out.push_back(SimdMath::log(in.m_t[i])); }));
+
+			Vector2f uv(0.f, 0.f);
+			results.push_back(Run("directionmap.equirect",
+				[&](const size_t &i) { uv = DirectionMap::toEquirect(in.m_a[i] + Vector3(uv.x, uv.y, 0.f)); DoNotOptimize(uv); },
+				[&](const size_t &i, std::vector<float> &out) {
+					Vector2f e = DirectionMap::toEquirect(in.m_a[i]);
+					out.push_back(e.x);
+					out.push_back(e.y);
+				}));
+			results.push_back(Run("directionmap.octahedral",
+				[&](const size_t &i) { uv = DirectionMap::toOctahedral(in.m_a[i] + Vector3(uv.x, uv.y, 0.f)); DoNotOptimize(uv); },
+				[&](const size_t &i, std::vector<float> &out) {
+					Vector2f o = DirectionMap::toOctahedral(in.m_a[i]);
+					out.push_back(o.x);
+					out.push_back(o.y);
+				}));
+
+			Frame frame;
+			results.push_back(Run("frame.fromz",
+				[&](const size_t &i) { frame = Frame((in.m_a[i] + frame.m_x * 1e-3f).normalize()); DoNotOptimize(frame); },
+				[&](const size_t &i, std::vector<float> &out) {
+					Frame f(in.m_a[i].normalize());
+					Push(out, f.m_x);
+					Push(out, f.m_y);
+				}));
+
+			BaseVector3 w(0.f, 0.f, 0.f);
+			results.push_back(Run("warp.cosinehemisphere",
+				[&](const size_t &i) { w = Warp::cosineHemisphere(Vector2f(in.m_t[i] * 2.f - 1.f, in.m_t[i] - Abs(w.z()) * 0.5f)); DoNotOptimize(w); },
+				[&](const size_t &i, std::vector<float> &out) { Push(out, Warp::cosineHemisphere(Vector2f(in.m_t[i] * 2.f - 1.f, in.m_t[(i + 1) % s_count] * 2.f - 1.f))); }));
+			results.push_back(Run("warp.uniformsphere",
+				[&](const size_t &i) { w = Warp::uniformSphere(Vector2f(in.m_t[i] * 2.f - 1.f, in.m_t[i] - Abs(w.z()) * 0.5f)); DoNotOptimize(w); },
+				[&](const size_t &i, std::vector<float> &out) { Push(out, Warp::uniformSphere(Vector2f(in.m_t[i] * 2.f - 1.f, in.m_t[(i + 1) % s_count] * 2.f - 1.f))); }));
+
+			// one frame per pass over the inputs, so the thread-local arena keeps recycling its block
+			Vector3 *cell = nullptr;
+			results.push_back(Run("memoryarena.create",
+				[&](const size_t &i) {
+					if (i == 0)
+						MemoryArena::nextFrame();
+					cell = MemoryArena::threadLocal().create<Vector3>(cell ? *cell : in.m_a[i]);
+					DoNotOptimize(cell);
+				},
+				[&](const size_t &i, std::vector<float> &out) {
+					MemoryArena arena(sizeof(Vector3) * 4);
+					Push(out, *arena.create<Vector3>(in.m_a[i]));
+				}));
+
+			bool hit = false;
+			results.push_back(Run("bbox.intersect",
+				[&](const size_t &i) { hit = in.m_box[(i + hit) % s_count].intersect(in.m_ray[i]); DoNotOptimize(hit); },
+				[&](const size_t &i, std::vector<float> &out) {
+					float t0 = 0.f, t1 = 0.f;
+					bool h = in.m_box[i].intersect(in.m_ray[i], &t0, &t1);
+					out.push_back(h ? 1.f : 0.f);
+					out.push_back(h ? t0 : 0.f);
+					out.push_back(h ? t1 : 0.f);
+				}));
+
+			BBox box = in.m_box[0];
+			results.push_back(Run("transform.bbox",
+				[&](const size_t &i) { box = in.m_transform(BBox(box.m_pmin * 0.5f, in.m_box[i].m_pmax)); DoNotOptimize(box); },
+				[&](const size_t &i, std::vector<float> &out) {
+					BBox r = in.m_transform(in.m_box[i]);
+					Push(out, r.m_pmin);
+					Push(out, r.m_pmax);
+				}));
+			Point3 p = in.m_p[0];
+			results.push_back(Run("transform.point",
+				[&](const size_t &) { p = in.m_transform(Point3(p * 0.5f)); DoNotOptimize(p); },
+				[&](const size_t &i, std::vector<float> &out) { Push(out, in.m_transform(in.m_p[i])); }));
+
+			// packet entries evaluate one packet on every 4th (or 8th) index
+			QuadWord d4(0.f, 0.f, 0.f, 0.f);
+			results.push_back(Run("vector3x4.dot",
+				[&](const size_t &i) {
+					if (i & 3) return;
+					d4 = Vector3x4::load(&in.m_a[i]).dot(Vector3x4::load(&in.m_b[i]) * d4);
+					DoNotOptimize(d4);
+				},
+				[&](const size_t &i, std::vector<float> &out) {
+					if (i & 3) return;
+					QuadWord r = Vector3x4::load(&in.m_a[i]).dot(Vector3x4::load(&in.m_b[i]));
+					for (int k = 0; k < 4; k++) out.push_back(r[k]);
+				}));
+#if defined(AYA_USE_AVX)
+			Vector3x8 v8 = Vector3x8::load(&in.m_a[0]);
+			results.push_back(Run("vector3x8.cross",
+				[&](const size_t &i) {
+					if (i & 7) return;
+					v8 = v8.cross(Vector3x8::load(&in.m_a[i])) + Vector3x8::load(&in.m_b[i]);
+					DoNotOptimize(v8);
+				},
+				[&](const size_t &i, std::vector<float> &out) {
+					if (i & 7) return;
+					Vector3x8 r = Vector3x8::load(&in.m_a[i]).cross(Vector3x8::load(&in.m_b[i]));
+					for (int k = 0; k < 8; k++) Push(out, r.getVector(k));
+				}));
+#else
+			Vector3x4 v4 = Vector3x4::load(&in.m_a[0]);
+			results.push_back(Run("vector3x8.cross",
+				[&](const size_t &i) {
+					if (i & 3) return;
+					v4 = v4.cross(Vector3x4::load(&in.m_a[i])) + Vector3x4::load(&in.m_b[i]);
+					DoNotOptimize(v4);
+				},
+				[&](const size_t &i, std::vector<float> &out) {
+					if (i & 3) return;
+					Vector3x4 r = Vector3x4::load(&in.m_a[i]).cross(Vector3x4::load(&in.m_b[i]));
+					for (int k = 0; k < 4; k++) Push(out, r.getVector(k));
+				}));
+#endif
+
+			int mask = 0;
+			results.push_back(Run("bbox4.intersect",
+				[&](const size_t &i) {
+					if (i & 3) return;
+					mask = BBox4(in.m_box[i], in.m_box[i + 1], in.m_box[i + 2], in.m_box[(i + 3 + mask) % s_count]).intersect(SlabRay(in.m_ray[i]));
+					DoNotOptimize(mask);
+				},
+				[&](const size_t &i, std::vector<float> &out) {
+					if (i & 3) return;
+					QuadWord t;
+					int m = BBox4(in.m_box[i], in.m_box[i + 1], in.m_box[i + 2], in.m_box[i + 3]).intersect(SlabRay(in.m_ray[i]), &t);
+					for (int k = 0; k < 4; k++) out.push_back(m & (1 << k) ? t[k] : -1.f);
+				}));
+			results.push_back(Run("bbox8.intersect",
+				[&](const size_t &i) {
+					if (i & 7) return;
+#if defined(AYA_USE_AVX)
+					mask = BBox8(&in.m_box[(i + mask) & ~size_t(7)]).intersect(SlabRay(in.m_ray[i]));
+#else
+					mask = BBox4(in.m_box[i], in.m_box[i + 1], in.m_box[i + 2], in.m_box[i + 3]).intersect(SlabRay(in.m_ray[i])) |
+						BBox4(in.m_box[i + 4], in.m_box[i + 5], in.m_box[i + 6], in.m_box[(i + 7 + mask) % s_count]).intersect(SlabRay(in.m_ray[i])) << 4;
+#endif
+					DoNotOptimize(mask);
+				},
+				[&](const size_t &i, std::vector<float> &out) {
+					if (i & 7) return;
+					float t[8];
+#if defined(AYA_USE_AVX)
+					__m256 t8;
+					int m = BBox8(&in.m_box[i]).intersect(SlabRay(in.m_ray[i]), &t8);
+					_mm256_storeu_ps(t, t8);
+#else
+					QuadWord lo, hi;
+					int m = BBox4(in.m_box[i], in.m_box[i + 1], in.m_box[i + 2], in.m_box[i + 3]).intersect(SlabRay(in.m_ray[i]), &lo) |
+						BBox4(in.m_box[i + 4], in.m_box[i + 5], in.m_box[i + 6], in.m_box[i + 7]).intersect(SlabRay(in.m_ray[i]), &hi) << 4;
+					for (int k = 0; k < 4; k++) {
+						t[k] = lo[k];
+						t[k + 4] = hi[k];
+					}
+#endif
+					for (int k = 0; k < 8; k++) out.push_back(m & (1 << k) ? t[k] : -1.f);
+				}));
+
+			// one node per 8 boxes, quantized against their union
+			std::vector<QBBox8> qnodes(s_count / 8);
+			for (size_t n = 0; n < qnodes.size(); n++) {
+				BBox parent = in.m_box[n * 8];
+				for (int k = 1; k < 8; k++) parent.unity(in.m_box[n * 8 + k]);
+				qnodes[n].setParent(parent);
+				for (int k = 0; k < 8; k++) qnodes[n].setBox(k, in.m_box[n * 8 + k]);
+			}
+			results.push_back(Run("qbbox8.intersect",
+				[&](const size_t &i) {
+					if (i & 7) return;
+					mask = qnodes[((i >> 3) + mask) % qnodes.size()].intersect(SlabRay(in.m_ray[i]));
+					DoNotOptimize(mask);
+				},
+				[&](const size_t &i, std::vector<float> &out) {
+					if (i & 7) return;
+					float t[8];
+					int m = qnodes[i >> 3].intersect(SlabRay(in.m_ray[i]), t);
+					for (int k = 0; k < 8; k++) out.push_back(m & (1 << k) ? t[k] : -1.f);
+				}));
+
+			BVH bvh;
+			bvh.buildLinear(in.m_box.data(), nullptr, uint32_t(s_count));
+			auto closest = [&](const Ray &ray, float *t_hit) {
+				SlabRay r(ray);
+				uint32_t prim = uint32_t(-1);
+				bvh.intersect(r, [&](const uint32_t &id) {
+					float t0, t1;
+					if (!in.m_box[id].intersect(ray, &t0, &t1) || t0 > r.m_maxt)
+						return false;
+					r.m_maxt = t0;
+					prim = id;
+					return true;
+				});
+				*t_hit = r.m_maxt;
+				return prim;
+			};
+			// the traversal and the motion bounds solve cost about a microsecond, these two
+			// entries sample every 8th index to keep the whole run short
+			uint32_t prim = 0;
+			results.push_back(Run("bvh.intersect",
+				[&](const size_t &i) {
+					if (i & 7) return;
+					float t;
+					prim = closest(in.m_ray[(i + prim) % s_count], &t);
+					DoNotOptimize(prim);
+				},
+				[&](const size_t &i, std::vector<float> &out) {
+					if (i & 7) return;
+					float t;
+					uint32_t id = closest(in.m_ray[i], &t);
+					out.push_back(float(int(id)));
+					out.push_back(id == uint32_t(-1) ? -1.f : t);
+				}));
+
+			Normal3 n(0.f, 0.f, 1.f);
+			results.push_back(Run("octnormal16.roundtrip",
+				[&](const size_t &i) { n = OctNormal16((in.m_a[i] + n).normalize()).toNormal(); DoNotOptimize(n); },
+				[&](const size_t &i, std::vector<float> &out) { Push(out, OctNormal16(in.m_a[i].normalize()).toNormal()); }));
+			results.push_back(Run("octnormal8.roundtrip",
+				[&](const size_t &i) { n = OctNormal8((in.m_a[i] + n).normalize()).toNormal(); DoNotOptimize(n); },
+				[&](const size_t &i, std::vector<float> &out) { Push(out, OctNormal8(in.m_a[i].normalize()).toNormal()); }));
+
+			// keys are split in 15 bit halves, which floats hold exactly
+			SpatialKey keys(BBox(Point3(-4.f, -4.f, -4.f), Point3(4.f, 4.f, 4.f)));
+			uint32_t key = 0;
+			results.push_back(Run("spatialkey.morton30",
+				[&](const size_t &i) { key = keys.morton30(in.m_p[(i + key) % s_count]); DoNotOptimize(key); },
+				[&](const size_t &i, std::vector<float> &out) {
+					uint32_t k = keys.morton30(in.m_p[i]);
+					out.push_back(float(k & 0x7fff));
+					out.push_back(float(k >> 15));
+				}));
+
+			Vector3d vd(in.m_a[0]);
+			results.push_back(Run("vector3d.cross",
+				[&](const size_t &i) { vd = vd.cross(Vector3d(in.m_a[i])) + Vector3d(in.m_b[i]); DoNotOptimize(vd); },
+				[&](const size_t &i, std::vector<float> &out) { Push(out, Vector3d(in.m_a[i]).cross(Vector3d(in.m_b[i])).toFloat()); }));
+			Matrix4x4d m4d(in.m_m4[0]);
+			results.push_back(Run("matrix4x4d.inverse",
+				[&](const size_t &i) { m4d = (i & 1) ? m4d.inverse() : Matrix4x4d(in.m_m4[i]).inverse(); DoNotOptimize(m4d); },
+				[&](const size_t &i, std::vector<float> &out) {
+					Matrix4x4 r = Matrix4x4d(in.m_m4[i]).inverse().toFloat();
+					for (int k = 0; k < 4; k++) for (int c = 0; c < 4; c++) out.push_back(r[k][c]);
+				}));
+			Transformd td(in.m_transform);
+			Point3d pd(in.m_p[0]);
+			results.push_back(Run("transformd.point",
+				[&](const size_t &) { pd = td(Point3d(pd * 0.5)); DoNotOptimize(pd); },
+				[&](const size_t &i, std::vector<float> &out) { Push(out, td(Point3d(in.m_p[i])).toFloat()); }));
+
+			AnimatedTransform animated(Transform(), 0.f, in.m_transform, 1.f);
+			results.push_back(Run("animatedtransform.interpolate",
+				[&](const size_t &i) { p = animated.interpolate(in.m_t[i])(Point3(p * 0.5f)); DoNotOptimize(p); },
+				[&](const size_t &i, std::vector<float> &out) { Push(out, animated.interpolate(in.m_t[i])(in.m_p[i])); }));
+			results.push_back(Run("animatedtransform.motionbounds",
+				[&](const size_t &i) {
+					if (i & 7) return;
+					box = animated.motionBounds(BBox(box.m_pmin * 0.5f, in.m_box[i].m_pmax));
+					DoNotOptimize(box);
+				},
+				[&](const size_t &i, std::vector<float> &out) {
+					if (i & 7) return;
+					BBox r = animated.motionBounds(in.m_box[i]);
+					Push(out, r.m_pmin);
+					Push(out, r.m_pmax);
+				}));
+
+			Quaternionx4 q4 = Quaternionx4::load(&in.m_q0[0]);
+			results.push_back(Run("quaternionx4.slerp",
+				[&](const size_t &i) {
+					if (i & 3) return;
+					q4 = q4.slerp(Quaternionx4::load(&in.m_q1[i]), QuadWord(in.m_t[i], in.m_t[i + 1], in.m_t[i + 2], in.m_t[i + 3]));
+					DoNotOptimize(q4);
+				},
+				[&](const size_t &i, std::vector<float> &out) {
+					if (i & 3) return;
+					Quaternion r[4];
+					Quaternionx4::load(&in.m_q0[i]).slerp(Quaternionx4::load(&in.m_q1[i]), QuadWord(in.m_t[i], in.m_t[i + 1], in.m_t[i + 2], in.m_t[i + 3])).store(r);
+					for (int k = 0; k < 4; k++) Push(out, r[k]);
+				}));
+
+			std::vector<Vector3> normals(s_count);
+			for (size_t k = 0; k < s_count; k++)
+				normals[k] = in.m_a[k].normalize();
+			Vector3x4 v4x = Vector3x4::load(&in.m_b[0]);
+			results.push_back(Run("framex4.tolocal",
+				[&](const size_t &i) {
+					if (i & 3) return;
+					v4x = Framex4::load(&normals[i]).toLocal(v4x + Vector3x4::load(&in.m_b[i]));
+					DoNotOptimize(v4x);
+				},
+				[&](const size_t &i, std::vector<float> &out) {
+					if (i & 3) return;
+					Vector3x4 r = Framex4::load(&normals[i]).toLocal(Vector3x4::load(&in.m_b[i]));
+					for (int k = 0; k < 4; k++) Push(out, r.getVector(k));
+				}));
+
+			return results;
+		}
+
+		bool WriteCsv(const char *path, const std::vector<Result> &results) {
+			FILE *f = strcmp(path, "-") ? fopen(path, "w") : stdout;
+			if (!f) return false;
+			fprintf(f, "op,mode,simd_level,latency_ns,throughput_ns\n");
+			for (auto &r : results)
+				fprintf(f, "%s,%s,%d,%.3f,%.3f\n", r.m_name.c_str(), s_mode,
+					(int)CpuFeatures::getLevel(), r.m_latency, r.m_throughput);
+			if (f != stdout) fclose(f);
+			return true;
+		}
+
+		// One line per operation: name, value count, then the values as hex floats
+		bool WriteDump(const char *path, const std::vector<Result> &results) {
+			FILE *f = fopen(path, "w");
+			if (!f) return false;
+			for (auto &r : results) {
+				fprintf(f, "%s %zu", r.m_name.c_str(), r.m_values.size());
+				for (float x : r.m_values)
+					fprintf(f, " %a", x);
+				fprintf(f, "\n");
+			}
+			fclose(f);
+			return true;
+		}
+		bool ReadDump(const char *path, std::map<std::string, std::vector<float>> &dump) {
+			FILE *f = fopen(path, "r");
+			if (!f) return false;
+			char name[128];
+			size_t count;
+			while (fscanf(f, "%127s %zu", name, &count) == 2) {
+				std::vector<float> &values = dump[name];
+				values.resize(count);
+				for (size_t i = 0; i < count; i++)
+					if (fscanf(f, "%a", &values[i]) != 1) {
+						fclose(f);
+						return false;
+					}
+			}
+			fclose(f);
+			return true;
+		}
+
+		// Compares |a - b| <= tol * (1 + |b|) for every value present in both dumps
+		int Compare(const char *path_a, const char *path_b, const float &tol) {
+			std::map<std::string, std::vector<float>> a, b;
+			if (!ReadDump(path_a, a) || !ReadDump(path_b, b)) {
+				fprintf(stderr, "cannot read dumps\n");
+				return 2;
+			}
+			int failures = 0;
+			printf("op,max_error,status\n");
+			for (auto &entry : a) {
+				auto other = b.find(entry.first);
+				if (other == b.end() || other->second.size() != entry.second.size()) {
+					printf("%s,nan,missing\n", entry.first.c_str());
+					failures++;
+					continue;
+				}
+				float worst = 0.f;
+				for (size_t i = 0; i < entry.second.size(); i++) {
+					float x = entry.second[i], y = other->second[i];
+					float err = Abs(x - y) / (1.f + Abs(y));
+					if (!(err <= worst)) worst = err;
+				}
+				bool ok = worst <= tol;
+				printf("%s,%g,%s\n", entry.first.c_str(), worst, ok ? "ok" : "FAIL");
+				failures += !ok;
+			}
+			return failures ? 1 : 0;
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	using namespace Aya::Bench;
+
+	const char *csv = "-", *dump = nullptr;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--compare") && i + 2 < argc)
+			return Compare(argv[i + 1], argv[i + 2], i + 3 < argc ? (float)atof(argv[i + 3]) : 1e-4f);
+		else if (!strcmp(argv[i], "--csv") && i + 1 < argc)
+			csv = argv[++i];
+		else if (!strcmp(argv[i], "--dump") && i + 1 < argc)
+			dump = argv[++i];
+		else {
+			fprintf(stderr, "usage: %s [--csv file] [--dump file] | --compare a b [tolerance]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	Inputs in;
+	std::vector<Result> results = RunAll(in);
+	if (!WriteCsv(csv, results) || (dump && !WriteDump(dump, results))) {
+		fprintf(stderr, "cannot write results\n");
+		return 2;
+	}
+	return 0;
+}
@@ -0,0 +1,301 @@
+#ifndef AYA_MATH_ANIMATEDTRANSFORM_H
+#define AYA_MATH_ANIMATEDTRANSFORM_H
+
+#include "Transform.h"
+
+namespace Aya {
+	// Closed float interval, only the operations the motion bound root finder needs.
+	// sin/cos assume the argument lies in [0, 2pi].
+	class Interval {
+	public:
+		float m_low, m_high;
+
+		Interval(const float &v) : m_low(v), m_high(v) {}
+		Interval(const float &v0, const float &v1) :
+			m_low(Min(v0, v1)), m_high(Max(v0, v1)) {}
+
+		AYA_FORCE_INLINE Interval operator + (const Interval &i) const {
+			return Interval(m_low + i.m_low, m_high + i.m_high);
+		}
+		AYA_FORCE_INLINE Interval operator - (const Interval &i) const {
+			return Interval(m_low - i.m_high, m_high - i.m_low);
+		}
+		AYA_FORCE_INLINE Interval operator * (const Interval &i) const {
+			float a = m_low * i.m_low, b = m_high * i.m_low;
+			float c = m_low * i.m_high, d = m_high * i.m_high;
+			return Interval(Min(Min(a, b), Min(c, d)), Max(Max(a, b), Max(c, d)));
+		}
+
+		AYA_FORCE_INLINE Interval sin() const {
+			assert(m_low >= 0.f && m_high <= 2.0001f * float(M_PI));
+			float sin_low = sinf(m_low), sin_high = sinf(m_high);
+			if (sin_low > sin_high) std::swap(sin_low, sin_high);
+			if (m_low < float(M_PI) / 2.f && m_high > float(M_PI) / 2.f) sin_high = 1.f;
+			if (m_low < 1.5f * float(M_PI) && m_high > 1.5f * float(M_PI)) sin_low = -1.f;
+			return Interval(sin_low, sin_high);
+		}
+		AYA_FORCE_INLINE Interval cos() const {
+			assert(m_low >= 0.f && m_high <= 2.0001f * float(M_PI));
+			float cos_low = cosf(m_low), cos_high = cosf(m_high);
+			if (cos_low > cos_high) std::swap(cos_low, cos_high);
+			if (m_low < float(M_PI) && m_high > float(M_PI)) cos_low = -1.f;
+			return Interval(cos_low, cos_high);
+		}
+	};
+
+	// Linear motion between two keyframe transforms. Each keyframe is decomposed into
+	// translation, rotation and scale (M = T * R * S), T and S are interpolated linearly and R
+	// with Quaternion::slerp, as in pbrt-v3.
+	//
+	// Along one axis a transformed point moves as
+	//   dp/dt = c1 + (c2 + c3 * t) * cos(2 * theta * t) + (c4 + c5 * t) * sin(2 * theta * t)
+	// for normalized t in [0, 1]. Every ck is linear in the point, so the constructor stores it
+	// as a 3x3 matrix (plus the constant translation speed for c1). Motion bounds only have to
+	// look for the zeros of the derivative.
+		class AYA_SIMD_ALIGN AnimatedTransform {
+		public:
+			Transform m_start_transform, m_end_transform;
+			float m_start_time, m_end_time;
+			bool m_actually_animated, m_has_rotation;
+			Vector3 m_trans[2];
+			Quaternion m_rot[2];
+			Matrix3x3 m_scale[2];
+			// dp/dt coefficients, ck = m_c[k - 1] * p, c1 also adds m_c1_trans
+			Matrix3x3 m_c[5];
+			Vector3 m_c1_trans;
+			float m_theta;
+
+			AnimatedTransform(const Transform &start_transform, const float &start_time,
+				const Transform &end_transform, const float &end_time) :
+				m_start_transform(start_transform), m_end_transform(end_transform),
+				m_start_time(start_time), m_end_time(end_time),
+				m_actually_animated(start_transform.m_mat != end_transform.m_mat) {
+				decompose(m_start_transform.m_mat, &m_trans[0], &m_rot[0], &m_scale[0]);
+				decompose(m_end_transform.m_mat, &m_trans[1], &m_rot[1], &m_scale[1]);
+				// take the shorter arc
+				if (m_rot[0].dot(m_rot[1]) < 0.f)
+					m_rot[1] = -m_rot[1];
+				m_has_rotation = m_rot[0].dot(m_rot[1]) < .9995f;
+
+				m_theta = 0.f;
+				if (m_has_rotation)
+					computeDerivativeTerms();
+			}
+#if defined(AYA_USE_SIMD)
+			AYA_FORCE_INLINE void  *operator new(size_t i) {
+				return _mm_malloc(i, 16);
+			}
+
+			AYA_FORCE_INLINE void operator delete(void *p) {
+				_mm_free(p);
+			}
+#endif
+
+			// Splits the affine part of m into translation, rotation and scale, the rotation is
+			// found by polar decomposition
+			static void decompose(const Matrix4x4 &m, Vector3 *trans, Quaternion *rot, Matrix3x3 *scale) {
+				*trans = Vector3(m[0][3], m[1][3], m[2][3]);
+
+				Matrix3x3 mat(m[0][0], m[0][1], m[0][2],
+					m[1][0], m[1][1], m[1][2],
+					m[2][0], m[2][1], m[2][2]);
+
+				// average with the inverse transpose until it converges to the rotation
+				Matrix3x3 r = mat;
+				float norm;
+				int count = 0;
+				do {
+					Matrix3x3 r_next = (r + r.transpose().inverse()) * .5f;
+					norm = 0.f;
+					for (int i = 0; i < 3; i++) {
+						float n = Abs(r[i][0] - r_next[i][0]) +
+							Abs(r[i][1] - r_next[i][1]) +
+							Abs(r[i][2] - r_next[i][2]);
+						norm = Max(norm, n);
+					}
+					r = r_next;
+				} while (++count < 100 && norm > .0001f);
+
+				*rot = Quaternion(r);
+				rot->normalize();
+				*scale = r.transpose() * mat;
+			}
+
+			AYA_FORCE_INLINE bool isAnimated() const {
+				return m_actually_animated;
+			}
+			AYA_FORCE_INLINE bool hasRotation() const {
+				return m_has_rotation;
+			}
+			bool hasScale() const {
+				const Vector3 x(1.f, 0.f, 0.f), y(0.f, 1.f, 0.f), z(0.f, 0.f, 1.f);
+				for (int i = 0; i < 2; i++) {
+					const Transform &t = i == 0 ? m_start_transform : m_end_transform;
+					if (Abs(t(x).length2() - 1.f) > 1e-3f ||
+						Abs(t(y).length2() - 1.f) > 1e-3f ||
+						Abs(t(z).length2() - 1.f) > 1e-3f)
+						return true;
+				}
+				return false;
+			}
+
+			Transform interpolate(const float &time) const {
+				if (!m_actually_animated || time <= m_start_time)
+					return m_start_transform;
+				if (time >= m_end_time)
+					return m_end_transform;
+
+				float dt = (time - m_start_time) / (m_end_time - m_start_time);
+				Vector3 trans = m_trans[0] * (1.f - dt) + m_trans[1] * dt;
+				Matrix3x3 scale = m_scale[0] * (1.f - dt) + m_scale[1] * dt;
+				Quaternion rot = m_rot[0].slerp(m_rot[1], dt);
+
+				Matrix3x3 m = AffineTransform(rot.normalize()).m_mat * scale;
+				return Transform(AffineTransform(m, trans));
+			}
+
+			AYA_FORCE_INLINE Point3 operator() (const float &time, const Point3 &p) const {
+				if (!m_actually_animated || time <= m_start_time)
+					return m_start_transform(p);
+				if (time >= m_end_time)
+					return m_end_transform(p);
+				return interpolate(time)(p);
+			}
+			AYA_FORCE_INLINE Vector3 operator() (const float &time, const Vector3 &v) const {
+				if (!m_actually_animated || time <= m_start_time)
+					return m_start_transform(v);
+				if (time >= m_end_time)
+					return m_end_transform(v);
+				return interpolate(time)(v);
+			}
+			AYA_FORCE_INLINE Ray operator() (const float &time, const Ray &r) const {
+				if (!m_actually_animated || time <= m_start_time)
+					return m_start_transform(r);
+				if (time >= m_end_time)
+					return m_end_transform(r);
+				return interpolate(time)(r);
+			}
+
+			// Bounds of b over the whole time range
+			BBox motionBounds(const BBox &b) const {
+				if (!m_actually_animated)
+					return m_start_transform(b);
+				if (!m_has_rotation) {
+					// translation and scale are lerped, so every corner moves on a line
+					BBox ret = m_start_transform(b);
+					ret.unity(m_end_transform(b));
+					return ret;
+				}
+
+				BBox ret;
+				for (int corner = 0; corner < 8; corner++)
+					ret.unity(boundPointMotion(Point3(
+						(corner & 1) ? b.m_pmax.x() : b.m_pmin.x(),
+						(corner & 2) ? b.m_pmax.y() : b.m_pmin.y(),
+						(corner & 4) ? b.m_pmax.z() : b.m_pmin.z())));
+				return ret;
+			}
+
+			// Bounds of the path of p, the endpoints plus every extremum of each coordinate
+			BBox boundPointMotion(const Point3 &p) const {
+				if (!m_actually_animated)
+					return BBox(m_start_transform(p));
+
+				BBox ret(m_start_transform(p));
+				ret.unity(m_end_transform(p));
+				if (!m_has_rotation)
+					return ret;
+
+				for (int a = 0; a < 3; a++) {
+					float c[5];
+					for (int k = 0; k < 5; k++)
+						c[k] = m_c[k][a].dot(p);
+					c[0] += m_c1_trans[a];
+
+					float zeros[8];
+					int zero_count = 0;
+					intervalFindZeros(c, m_theta, Interval(0.f, 1.f), zeros, &zero_count);
+					assert(zero_count <= 8);
+					for (int i = 0; i < zero_count; i++)
+						ret.unity((*this)(Lerp(zeros[i], m_start_time, m_end_time), p));
+				}
+				return ret;
+			}
+
+		private:
+			// Symmetric bilinear form whose diagonal B(q, q) is the rotation matrix of the unit q
+			static Matrix3x3 rotationForm(const Quaternion &a, const Quaternion &b) {
+				float ww = a.w() * b.w(), xx = a.x() * b.x(), yy = a.y() * b.y(), zz = a.z() * b.z();
+				float xy = a.x() * b.y() + a.y() * b.x();
+				float xz = a.x() * b.z() + a.z() * b.x();
+				float yz = a.y() * b.z() + a.z() * b.y();
+				float wx = a.w() * b.x() + a.x() * b.w();
+				float wy = a.w() * b.y() + a.y() * b.w();
+				float wz = a.w() * b.z() + a.z() * b.w();
+				return Matrix3x3(ww + xx - yy - zz, xy - wz, xz + wy,
+					xy + wz, ww - xx + yy - zz, yz - wx,
+					xz - wy, yz + wx, ww - xx - yy + zz);
+			}
+
+			void computeDerivativeTerms() {
+				float cos_theta = Clamp(m_rot[0].dot(m_rot[1]), -1.f, 1.f);
+				m_theta = acosf(cos_theta);
+
+				// q(t) = q0 * cos(theta * t) + q_perp * sin(theta * t), which makes
+				// R(t) = k0 + k1 * cos(2 * theta * t) + k2 * sin(2 * theta * t)
+				Quaternion q_perp = m_rot[1] - m_rot[0] * cos_theta;
+				q_perp.normalize();
+				Matrix3x3 r0 = rotationForm(m_rot[0], m_rot[0]);
+				Matrix3x3 r1 = rotationForm(q_perp, q_perp);
+				Matrix3x3 k0 = (r0 + r1) * .5f;
+				Matrix3x3 k1 = (r0 - r1) * .5f;
+				Matrix3x3 k2 = rotationForm(m_rot[0], q_perp);
+
+				// p(t) = T0 + t * dT + R(t) * (S0 + t * dS) * p
+				const Matrix3x3 &s0 = m_scale[0];
+				Matrix3x3 ds = m_scale[1] - m_scale[0];
+				float theta2 = 2.f * m_theta;
+
+				m_c1_trans = m_trans[1] - m_trans[0];
+				m_c[0] = k0 * ds;
+				m_c[1] = k1 * ds + k2 * s0 * theta2;
+				m_c[2] = k2 * ds * theta2;
+				m_c[3] = k2 * ds - k1 * s0 * theta2;
+				m_c[4] = k1 * ds * -theta2;
+			}
+
+			// Zeros of the derivative in t_interval, bisected with interval arithmetic down to
+			// 2^-depth and then refined with a few Newton steps
+			static void intervalFindZeros(const float c[5], const float &theta, const Interval &t_interval,
+				float *zeros, int *zero_count, const int &depth = 8) {
+				Interval theta2(2.f * theta);
+				Interval range = Interval(c[0]) +
+					(Interval(c[1]) + Interval(c[2]) * t_interval) * (theta2 * t_interval).cos() +
+					(Interval(c[3]) + Interval(c[4]) * t_interval) * (theta2 * t_interval).sin();
+				if (range.m_low > 0.f || range.m_high < 0.f || range.m_low == range.m_high)
+					return;
+
+				if (depth > 0) {
+					float mid = (t_interval.m_low + t_interval.m_high) * .5f;
+					intervalFindZeros(c, theta, Interval(t_interval.m_low, mid), zeros, zero_count, depth - 1);
+					intervalFindZeros(c, theta, Interval(mid, t_interval.m_high), zeros, zero_count, depth - 1);
+					return;
+				}
+
+				float t = (t_interval.m_low + t_interval.m_high) * .5f;
+				for (int i = 0; i < 4; i++) {
+					float cos_t = cosf(2.f * theta * t), sin_t = sinf(2.f * theta * t);
+					float f = c[0] + (c[1] + c[2] * t) * cos_t + (c[3] + c[4] * t) * sin_t;
+					float f_prime = (c[2] + 2.f * (c[3] + c[4] * t) * theta) * cos_t +
+						(c[4] - 2.f * (c[1] + c[2] * t) * theta) * sin_t;
+					if (f == 0.f || f_prime == 0.f)
+						break;
+					t = t - f / f_prime;
+				}
+				if (t >= t_interval.m_low - 1e-3f && t < t_interval.m_high + 1e-3f && *zero_count < 8)
+					zeros[(*zero_count)++] = t;
+			}
+	};
+}
+
+#endif
@@ -5,10 +5,55 @@
 #include "../Core/Ray.h"
 
 namespace Aya {
+	// Ray with precomputed reciprocal direction and direction signs, built once per ray
+	// and reused for every slab test during traversal.
+		class AYA_SIMD_ALIGN SlabRay {
+		public:
+			Point3 m_ori;
+			Vector3 m_inv_dir;
+#if defined(AYA_USE_SIMD)
+			__m128 m_neg_mask;
+#endif
+			float m_mint, m_maxt;
+			int m_dir_is_neg[3];
+
+			SlabRay() {}
+			AYA_FORCE_INLINE SlabRay(const Point3 &ori, const Vector3 &dir,
+				const float &mint = 0.f, const float &maxt = INFINITY) {
+				setValue(ori, dir, mint, maxt);
+			}
+			explicit AYA_FORCE_INLINE SlabRay(const Ray &r) {
+				setValue(r.m_ori, r.m_dir, 0.f, r.m_maxt);
+			}
+#if defined(AYA_USE_SIMD)
+			AYA_FORCE_INLINE void  *operator new(size_t i) {
+				return _mm_malloc(i, 16);
+			}
+
+			AYA_FORCE_INLINE void operator delete(void *p) {
+				_mm_free(p);
+			}
+#endif
+
+			AYA_FORCE_INLINE void setValue(const Point3 &ori, const Vector3 &dir,
+				const float &mint, const float &maxt) {
+				m_ori = ori;
+				m_mint = mint;
+				m_maxt = maxt;
 #if defined(AYA_USE_SIMD)
-	__declspec(align(16))
+				// zero components become +-inf, keeping the sign of the zero
+				m_inv_dir.m_val128 = _mm_and_ps(_mm_div_ps(v1_0, dir.m_val128), vFFF0fMask);
+				m_neg_mask = _mm_and_ps(_mm_cmplt_ps(m_inv_dir.m_val128, _mm_setzero_ps()), vFFF0fMask);
+#else
+				m_inv_dir = Vector3(1.f / dir.x(), 1.f / dir.y(), 1.f / dir.z());
 #endif
-		class BBox {
+				m_dir_is_neg[0] = m_inv_dir.x() < 0.f;
+				m_dir_is_neg[1] = m_inv_dir.y() < 0.f;
+				m_dir_is_neg[2] = m_inv_dir.z() < 0.f;
+			}
+	};
+
+		class AYA_SIMD_ALIGN BBox {
 		public:
 			Point3 m_pmin, m_pmax;
 
@@ -109,20 +154,72 @@ namespace Aya {
 				return *this;
 			}
 			AYA_FORCE_INLINE bool intersect(const Ray &r) const {
-				float t0, t1;
-				float tmin = 0.f, tmax = r.m_maxt;
+				return intersect(SlabRay(r));
+			}
+			AYA_FORCE_INLINE bool intersect(const Ray &r, float *t_near, float *t_far) const {
+				return intersect(SlabRay(r), t_near, t_far);
+			}
+			// Branchless slab test. Slabs producing NaN (an axis-parallel ray whose origin lies
+			// on the slab plane) are ignored, so such rays count as inside that slab.
+			AYA_FORCE_INLINE bool intersect(const SlabRay &r, float *t_near = nullptr, float *t_far = nullptr) const {
+#if defined(AYA_USE_SIMD)
+				__m128 near_p = _mm_or_ps(_mm_and_ps(r.m_neg_mask, m_pmax.m_val128),
+					_mm_andnot_ps(r.m_neg_mask, m_pmin.m_val128));
+				__m128 far_p = _mm_or_ps(_mm_and_ps(r.m_neg_mask, m_pmin.m_val128),
+					_mm_andnot_ps(r.m_neg_mask, m_pmax.m_val128));
+
+				__m128 t0 = _mm_mul_ps(_mm_sub_ps(near_p, r.m_ori.m_val128), r.m_inv_dir.m_val128);
+				__m128 t1 = _mm_mul_ps(_mm_sub_ps(far_p, r.m_ori.m_val128), r.m_inv_dir.m_val128);
+
+				// _mm_max_ps / _mm_min_ps return the second operand when the first is NaN
+				t0 = _mm_max_ps(t0, _mm_set1_ps(r.m_mint));
+				t1 = _mm_min_ps(t1, _mm_set1_ps(r.m_maxt));
+				// replace the unused w lane by x before the horizontal reduction
+				t0 = _mm_pshufd_ps(t0, __MM_SHUFFLE(0, 1, 2, 0));
+				t1 = _mm_pshufd_ps(t1, __MM_SHUFFLE(0, 1, 2, 0));
+				t0 = _mm_max_ps(t0, _mm_movehl_ps(t0, t0));
+				t1 = _mm_min_ps(t1, _mm_movehl_ps(t1, t1));
+				t0 = _mm_max_ss(t0, _mm_pshufd_ps(t0, 0x55));
+				t1 = _mm_min_ss(t1, _mm_pshufd_ps(t1, 0x55));
+
+				float tmin = _mm_cvtss_f32(t0);
+				float tmax = _mm_cvtss_f32(t1);
+#else
+				float tmin = r.m_mint, tmax = r.m_maxt;
 				for (int a = 0; a < 3; a++) {
-					t0 = Min((m_pmin[a] - r.m_ori[a]) / r.m_dir[a],
-						(m_pmax[a] - r.m_ori[a]) / r.m_dir[a]);
-					t1 = Max((m_pmin[a] - r.m_ori[a]) / r.m_dir[a],
-						(m_pmax[a] - r.m_ori[a]) / r.m_dir[a]);
-					tmin = Max(t0, tmin);
-					tmax = Min(t1, tmax);
-					if (tmax < tmin) {
-						return false;
-					}
+					float t0 = ((r.m_dir_is_neg[a] ? m_pmax[a] : m_pmin[a]) - r.m_ori[a]) * r.m_inv_dir[a];
+					float t1 = ((r.m_dir_is_neg[a] ? m_pmin[a] : m_pmax[a]) - r.m_ori[a]) * r.m_inv_dir[a];
+					tmin = t0 > tmin ? t0 : tmin;
+					tmax = t1 < tmax ? t1 : tmax;
 				}
-				return true;
+#endif
+				if (t_near) *t_near = tmin;
+				if (t_far) *t_far = tmax;
+				return tmin <= tmax;
+			}
+			AYA_FORCE_INLINE Vector3 diagonal() const {
+				return m_pmax - m_pmin;
+			}
+			AYA_FORCE_INLINE float surfaceArea() const {
+				Vector3 d = diagonal();
+				return 2.f * (d.x() * d.y() + d.x() * d.z() + d.y() * d.z());
+			}
+			AYA_FORCE_INLINE int maxExtent() const {
+				Vector3 d = diagonal();
+				if (d.x() > d.y() && d.x() > d.z())
+					return 0;
+				else if (d.y() > d.z())
+					return 1;
+				else
+					return 2;
+			}
+			// Position of p relative to the box corners, (0, 0, 0) at m_pmin and (1, 1, 1) at m_pmax
+			AYA_FORCE_INLINE Vector3 offset(const Point3 &p) const {
+				Vector3 o = p - m_pmin;
+				if (m_pmax.x() > m_pmin.x()) o[0] /= m_pmax.x() - m_pmin.x();
+				if (m_pmax.y() > m_pmin.y()) o[1] /= m_pmax.y() - m_pmin.y();
+				if (m_pmax.z() > m_pmin.z()) o[2] /= m_pmax.z() - m_pmin.z();
+				return o;
 			}
 			AYA_FORCE_INLINE void boundingSphere(Point3 *center, float *radius) {
 				*center = (m_pmin + m_pmax) * .5f;
@@ -0,0 +1,118 @@
+#ifndef AYA_MATH_BBOX4_H
+#define AYA_MATH_BBOX4_H
+
+#include "BBox.h"
+#include "Vector3x4.h"
+
+namespace Aya {
+	// Four BBox in structure-of-arrays layout (6 x __m128), tested against one SlabRay at once.
+	// Unused lanes should hold the empty box, which never reports a hit.
+		class AYA_SIMD_ALIGN BBox4 {
+		public:
+			Vector3x4 m_pmin, m_pmax;
+
+			BBox4() {
+				setEmpty();
+			}
+			AYA_FORCE_INLINE BBox4(const BBox &b0, const BBox &b1, const BBox &b2, const BBox &b3) :
+				m_pmin(b0.m_pmin, b1.m_pmin, b2.m_pmin, b3.m_pmin),
+				m_pmax(b0.m_pmax, b1.m_pmax, b2.m_pmax, b3.m_pmax) {}
+			AYA_FORCE_INLINE BBox4(const Vector3x4 &pmin, const Vector3x4 &pmax) :
+				m_pmin(pmin), m_pmax(pmax) {}
+#if defined(AYA_USE_SIMD)
+			AYA_FORCE_INLINE void  *operator new(size_t i) {
+				return _mm_malloc(i, 16);
+			}
+
+			AYA_FORCE_INLINE void operator delete(void *p) {
+				_mm_free(p);
+			}
+#endif
+
+			AYA_FORCE_INLINE void setEmpty() {
+				m_pmin = Vector3x4(BaseVector3(INFINITY, INFINITY, INFINITY));
+				m_pmax = Vector3x4(BaseVector3(-INFINITY, -INFINITY, -INFINITY));
+			}
+			AYA_FORCE_INLINE void setBox(const int &i, const BBox &b) {
+				assert(i >= 0 && i < 4);
+				for (int a = 0; a < 3; a++) {
+					m_pmin.m_val[a][i] = b.m_pmin[a];
+					m_pmax.m_val[a][i] = b.m_pmax[a];
+				}
+			}
+			AYA_FORCE_INLINE BBox getBox(const int &i) const {
+				assert(i >= 0 && i < 4);
+				BBox ret;
+				ret.m_pmin = m_pmin.getVector(i);
+				ret.m_pmax = m_pmax.getVector(i);
+				return ret;
+			}
+
+			// Union of the four boxes
+			AYA_FORCE_INLINE BBox unity() const {
+				BBox ret;
+#if defined(AYA_USE_SIMD)
+				__m128 v[6];
+				for (int a = 0; a < 3; a++) {
+					__m128 lo = m_pmin.m_val128[a];
+					__m128 hi = m_pmax.m_val128[a];
+					lo = _mm_min_ps(lo, _mm_pshufd_ps(lo, __MM_SHUFFLE(2, 3, 0, 1)));
+					hi = _mm_max_ps(hi, _mm_pshufd_ps(hi, __MM_SHUFFLE(2, 3, 0, 1)));
+					v[a] = _mm_min_ps(lo, _mm_pshufd_ps(lo, __MM_SHUFFLE(1, 0, 3, 2)));
+					v[a + 3] = _mm_max_ps(hi, _mm_pshufd_ps(hi, __MM_SHUFFLE(1, 0, 3, 2)));
+				}
+				ret.m_pmin.m_val128 = _mm_and_ps(_mm_movelh_ps(_mm_unpacklo_ps(v[0], v[1]), v[2]), vFFF0fMask);
+				ret.m_pmax.m_val128 = _mm_and_ps(_mm_movelh_ps(_mm_unpacklo_ps(v[3], v[4]), v[5]), vFFF0fMask);
+#else
+				for (int i = 0; i < 4; i++)
+					ret.unity(getBox(i));
+#endif
+				return ret;
+			}
+
+			// Slab test of one ray against the four boxes. Returns the hit mask (bit i for box i)
+			// and writes the per-lane entry distance to t_near. NaN slabs are ignored as in
+			// BBox::intersect(const SlabRay &).
+			AYA_FORCE_INLINE int intersect(const SlabRay &r, QuadWord *t_near = nullptr) const {
+#if defined(AYA_USE_SIMD)
+				__m128 tmin = _mm_set1_ps(r.m_mint);
+				__m128 tmax = _mm_set1_ps(r.m_maxt);
+				for (int a = 0; a < 3; a++) {
+					const __m128 &near_p = r.m_dir_is_neg[a] ? m_pmax.m_val128[a] : m_pmin.m_val128[a];
+					const __m128 &far_p = r.m_dir_is_neg[a] ? m_pmin.m_val128[a] : m_pmax.m_val128[a];
+					const __m128 ori = _mm_set1_ps(r.m_ori[a]);
+					const __m128 inv = _mm_set1_ps(r.m_inv_dir[a]);
+
+					tmin = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(near_p, ori), inv), tmin);
+					tmax = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(far_p, ori), inv), tmax);
+				}
+				if (t_near) t_near->m_val128 = tmin;
+				return _mm_movemask_ps(_mm_cmple_ps(tmin, tmax));
+#else
+				int mask = 0;
+				for (int i = 0; i < 4; i++) {
+					float tmin = r.m_mint, tmax = r.m_maxt;
+					for (int a = 0; a < 3; a++) {
+						float t0 = ((r.m_dir_is_neg[a] ? m_pmax.m_val[a][i] : m_pmin.m_val[a][i]) - r.m_ori[a]) * r.m_inv_dir[a];
+						float t1 = ((r.m_dir_is_neg[a] ? m_pmin.m_val[a][i] : m_pmax.m_val[a][i]) - r.m_ori[a]) * r.m_inv_dir[a];
+						tmin = t0 > tmin ? t0 : tmin;
+						tmax = t1 < tmax ? t1 : tmax;
+					}
+					if (t_near) (*t_near)[i] = tmin;
+					mask |= (tmin <= tmax) << i;
+				}
+				return mask;
+#endif
+			}
+
+			friend inline std::ostream &operator<<(std::ostream &os, const BBox4 &b) {
+				os << "[" << b.getBox(0) << ",\n";
+				os << " " << b.getBox(1) << ",\n";
+				os << " " << b.getBox(2) << ",\n";
+				os << " " << b.getBox(3) << "]";
+				return os;
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef AYA_MATH_BBOX8_H
+#define AYA_MATH_BBOX8_H
+
+#include "BBox4.h"
+#include "Vector3x8.h"
+
+#if defined(AYA_USE_AVX)
+namespace Aya {
+	// Eight BBox in structure-of-arrays layout (6 x __m256), the AVX counterpart of BBox4.
+		class AYA_ALIGN(32) BBox8 {
+		public:
+			Vector3x8 m_pmin, m_pmax;
+
+			BBox8() {
+				setEmpty();
+			}
+			AYA_FORCE_INLINE BBox8(const BBox4 &lo, const BBox4 &hi) :
+				m_pmin(lo.m_pmin, hi.m_pmin), m_pmax(lo.m_pmax, hi.m_pmax) {}
+			AYA_FORCE_INLINE BBox8(const Vector3x8 &pmin, const Vector3x8 &pmax) :
+				m_pmin(pmin), m_pmax(pmax) {}
+			explicit AYA_FORCE_INLINE BBox8(const BBox *b) :
+				m_pmin(Vector3x4(b[0].m_pmin, b[1].m_pmin, b[2].m_pmin, b[3].m_pmin),
+					Vector3x4(b[4].m_pmin, b[5].m_pmin, b[6].m_pmin, b[7].m_pmin)),
+				m_pmax(Vector3x4(b[0].m_pmax, b[1].m_pmax, b[2].m_pmax, b[3].m_pmax),
+					Vector3x4(b[4].m_pmax, b[5].m_pmax, b[6].m_pmax, b[7].m_pmax)) {}
+
+			AYA_FORCE_INLINE void  *operator new(size_t i) {
+				return _mm_malloc(i, 32);
+			}
+
+			AYA_FORCE_INLINE void operator delete(void *p) {
+				_mm_free(p);
+			}
+
+			AYA_FORCE_INLINE void setEmpty() {
+				m_pmin = Vector3x8(BaseVector3(INFINITY, INFINITY, INFINITY));
+				m_pmax = Vector3x8(BaseVector3(-INFINITY, -INFINITY, -INFINITY));
+			}
+			AYA_FORCE_INLINE void setBox(const int &i, const BBox &b) {
+				assert(i >= 0 && i < 8);
+				for (int a = 0; a < 3; a++) {
+					m_pmin.m_val[a][i] = b.m_pmin[a];
+					m_pmax.m_val[a][i] = b.m_pmax[a];
+				}
+			}
+			AYA_FORCE_INLINE BBox getBox(const int &i) const {
+				assert(i >= 0 && i < 8);
+				BBox ret;
+				ret.m_pmin = m_pmin.getVector(i);
+				ret.m_pmax = m_pmax.getVector(i);
+				return ret;
+			}
+			AYA_FORCE_INLINE BBox4 getLow() const {
+				return BBox4(m_pmin.getLow(), m_pmax.getLow());
+			}
+			AYA_FORCE_INLINE BBox4 getHigh() const {
+				return BBox4(m_pmin.getHigh(), m_pmax.getHigh());
+			}
+
+			// Union of the eight boxes
+			AYA_FORCE_INLINE BBox unity() const {
+				Vector3x4 pmin = m_pmin.getLow(), pmax = m_pmax.getLow();
+				pmin.setMin(m_pmin.getHigh());
+				pmax.setMax(m_pmax.getHigh());
+				return BBox4(pmin, pmax).unity();
+			}
+
+			// Slab test of one ray against the eight boxes. Returns the hit mask (bit i for box i)
+			// and writes the per-lane entry distance to t_near.
+			AYA_FORCE_INLINE int intersect(const SlabRay &r, __m256 *t_near = nullptr) const {
+				__m256 tmin = _mm256_set1_ps(r.m_mint);
+				__m256 tmax = _mm256_set1_ps(r.m_maxt);
+				for (int a = 0; a < 3; a++) {
+					const __m256 &near_p = r.m_dir_is_neg[a] ? m_pmax.m_val256[a] : m_pmin.m_val256[a];
+					const __m256 &far_p = r.m_dir_is_neg[a] ? m_pmin.m_val256[a] : m_pmax.m_val256[a];
+					const __m256 ori = _mm256_set1_ps(r.m_ori[a]);
+					const __m256 inv = _mm256_set1_ps(r.m_inv_dir[a]);
+
+					tmin = _mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(near_p, ori), inv), tmin);
+					tmax = _mm256_min_ps(_mm256_mul_ps(_mm256_sub_ps(far_p, ori), inv), tmax);
+				}
+				if (t_near) *t_near = tmin;
+				return _mm256_movemask_ps(_mm256_cmp_ps(tmin, tmax, _CMP_LE_OQ));
+			}
+
+			friend inline std::ostream &operator<<(std::ostream &os, const BBox8 &b) {
+				os << b.getLow() << ",\n" << b.getHigh();
+				return os;
+			}
+	};
+}
+#endif
+
+#endif
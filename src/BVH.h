@@ -0,0 +1,614 @@
+#ifndef AYA_MATH_BVH_H
+#define AYA_MATH_BVH_H
+
+#include "BBox.h"
+#include "Memory.h"
+#include "SpatialKey.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace Aya {
+	// Flattened BVH node, 32 bytes so that two nodes share one 64-byte cache line.
+	// The first child of an interior node immediately follows it, the second one is at m_offset.
+		class AYA_ALIGN(32) BVHNode {
+		public:
+			float m_min[3], m_max[3];
+			uint32_t m_offset;		// first primitive (leaf) or second child (interior)
+			uint16_t m_prim_count;	// 0 for interior nodes
+			uint8_t m_axis;
+			uint8_t m_pad;
+
+			AYA_FORCE_INLINE bool isLeaf() const {
+				return m_prim_count > 0;
+			}
+			AYA_FORCE_INLINE BBox getBBox() const {
+				BBox ret;
+				ret.m_pmin = Point3(m_min[0], m_min[1], m_min[2]);
+				ret.m_pmax = Point3(m_max[0], m_max[1], m_max[2]);
+				return ret;
+			}
+			AYA_FORCE_INLINE void setBBox(const BBox &b) {
+				for (int a = 0; a < 3; a++) {
+					m_min[a] = b.m_pmin[a];
+					m_max[a] = b.m_pmax[a];
+				}
+			}
+	};
+
+	// Binned SAH BVH over an array of primitive bounds. Subtrees above s_parallel_threshold
+	// primitives are built in parallel on ThreadPool::global(), the result is flattened into a depth-first
+	// BVHNode array aligned to the cache line.
+	//
+	// buildLinear() is the fast alternative for per-frame rebuilds: primitives are sorted along
+	// a 30-bit Morton curve and the hierarchy is emitted in parallel (Karras, "Maximizing
+	// Parallelism in the Construction of BVHs, Octrees, and k-d Trees", 2012). Trees are of
+	// lower quality than SAH, but the output layout is the same.
+	class BVH {
+	public:
+		static const uint32_t s_bucket_count = 12;
+		static const uint32_t s_parallel_threshold = 4096;
+		static const uint32_t s_linear_grain = 1 << 14;
+		static const uint32_t s_radix_bits = 10;
+
+	private:
+			struct AYA_SIMD_ALIGN PrimitiveInfo {
+				BBox m_bbox;
+				Point3 m_centroid;
+				uint32_t m_id;
+			};
+
+			struct AYA_SIMD_ALIGN BuildNode {
+				BBox m_bbox;
+				BuildNode *m_children[2];
+				uint32_t m_offset, m_prim_count, m_node_count;
+				int m_axis;
+
+#if defined(AYA_USE_SIMD)
+				AYA_FORCE_INLINE void  *operator new(size_t i) {
+					return _mm_malloc(i, 16);
+				}
+
+				AYA_FORCE_INLINE void operator delete(void *p) {
+					_mm_free(p);
+				}
+#endif
+				~BuildNode() {
+					delete m_children[0];
+					delete m_children[1];
+				}
+			};
+
+			// Internal node of the Karras tree, one cache line each. Node i splits the sorted range
+			// [m_first, m_last] into m_children, children with s_leaf_flag set are sorted primitives.
+			static const uint32_t s_leaf_flag = 0x80000000u;
+			struct AYA_ALIGN(64) LinearNode {
+				BBox m_bbox;
+				uint32_t m_children[2];
+				uint32_t m_first, m_last, m_parent, m_node_count;
+				std::atomic<uint32_t> m_visits;
+				uint8_t m_axis;
+			};
+
+			// Working memory of buildLinear, kept between builds so that per-frame rebuilds of
+			// the same size neither allocate nor fault in fresh pages
+			struct LinearScratch {
+				AlignedVector<Point3> m_centroids;
+				AlignedVector<BBox> m_chunk_bounds, m_leaf_bboxes;
+				AlignedVector<LinearNode> m_tree;
+				std::vector<uint32_t> m_codes, m_order, m_codes_tmp, m_order_tmp, m_offsets, m_leaf_parents;
+			};
+
+		BVHNode *mp_nodes;
+		uint32_t m_node_count, m_node_capacity;
+		std::vector<uint32_t> m_prim_ids;
+		uint32_t m_max_prims_in_node;
+		int m_max_parallel_depth;
+		LinearScratch m_scratch;
+
+	public:
+		BVH() : mp_nodes(nullptr), m_node_count(0), m_node_capacity(0), m_max_prims_in_node(4), m_max_parallel_depth(0) {}
+		BVH(const BVH &) = delete;
+		BVH& operator = (const BVH &) = delete;
+		~BVH() {
+			release();
+		}
+
+		void release() {
+			if (mp_nodes) {
+				_mm_free(mp_nodes);
+				mp_nodes = nullptr;
+			}
+			m_node_count = m_node_capacity = 0;
+			m_prim_ids.clear();
+			m_scratch = LinearScratch();
+		}
+
+		// prim_ids may be nullptr, primitive i then gets id i.
+		void build(const BBox *bboxes, const uint32_t *prim_ids, const uint32_t &count,
+			const uint32_t &max_prims_in_node = 4) {
+			release();
+			if (count == 0)
+				return;
+
+			m_max_prims_in_node = Clamp(max_prims_in_node, 1u, 255u);
+			m_max_parallel_depth = 0;
+			for (size_t n = ThreadPool::global().getThreadCount(); n > 1; n >>= 1)
+				m_max_parallel_depth++;
+			m_max_parallel_depth += 2;
+
+			std::vector<PrimitiveInfo> prims(count);
+			for (uint32_t i = 0; i < count; i++) {
+				prims[i].m_bbox = bboxes[i];
+				prims[i].m_centroid = (bboxes[i].m_pmin + bboxes[i].m_pmax) * .5f;
+				prims[i].m_id = prim_ids ? prim_ids[i] : i;
+			}
+
+			BuildNode *root = recursiveBuild(prims.data(), 0, count, 0);
+
+			// leaves address ranges of the partitioned primitive array directly
+			m_prim_ids.resize(count);
+			for (uint32_t i = 0; i < count; i++)
+				m_prim_ids[i] = prims[i].m_id;
+
+			allocateNodes(root->m_node_count);
+			uint32_t offset = 0;
+			flatten(root, &offset);
+			m_node_count = offset;
+
+			delete root;
+		}
+
+		// Morton sorted build, every stage runs on the threads of ThreadPool::global(). Subtrees of at most
+		// max_prims_in_node primitives become leaves. Node and scratch memory is reused by the
+		// next buildLinear as long as it is large enough.
+		void buildLinear(const BBox *bboxes, const uint32_t *prim_ids, const uint32_t &count,
+			const uint32_t &max_prims_in_node = 4) {
+			m_node_count = 0;
+			m_prim_ids.resize(count);
+			if (count == 0)
+				return;
+
+			m_max_prims_in_node = Clamp(max_prims_in_node, 1u, 255u);
+			m_max_parallel_depth = 0;
+			for (size_t n = ThreadPool::global().getThreadCount(); n > 1; n >>= 1)
+				m_max_parallel_depth++;
+			m_max_parallel_depth += 2;
+
+			const uint32_t chunks = chunkCount(count);
+			const uint32_t chunk_size = (count + chunks - 1) / chunks;
+			LinearScratch &s = m_scratch;
+
+			// centroids and their bounds
+			s.m_centroids.resize(count);
+			s.m_chunk_bounds.resize(chunks);
+			parallelChunks(chunks, [&](const uint32_t &c) {
+				BBox b;
+				for (uint32_t i = c * chunk_size; i < Min(count, (c + 1) * chunk_size); i++) {
+					s.m_centroids[i] = (bboxes[i].m_pmin + bboxes[i].m_pmax) * .5f;
+					b.unity(s.m_centroids[i]);
+				}
+				s.m_chunk_bounds[c] = b;
+			});
+			BBox scene;
+			for (uint32_t c = 0; c < chunks; c++)
+				scene.unity(s.m_chunk_bounds[c]);
+
+			s.m_codes.resize(count);
+			s.m_order.resize(count);
+			SpatialKey(scene).morton30(s.m_centroids.data(), s.m_codes.data(), count);
+			for (uint32_t i = 0; i < count; i++)
+				s.m_order[i] = i;
+			radixSort(s, count, chunks);
+
+			// gather once in Morton order, fitting and flattening then read the boxes linearly
+			s.m_leaf_bboxes.resize(count);
+			ParallelFor(count, s_linear_grain, [&](const size_t &begin, const size_t &end) {
+				for (size_t i = begin; i < end; i++) {
+					s.m_leaf_bboxes[i] = bboxes[s.m_order[i]];
+					m_prim_ids[i] = prim_ids ? prim_ids[s.m_order[i]] : s.m_order[i];
+				}
+			});
+
+			if (count == 1) {
+				allocateNodes(1);
+				mp_nodes[0].setBBox(bboxes[0]);
+				mp_nodes[0].m_offset = 0;
+				mp_nodes[0].m_prim_count = 1;
+				mp_nodes[0].m_axis = 0;
+				mp_nodes[0].m_pad = 0;
+				m_node_count = 1;
+				return;
+			}
+
+			if (s.m_tree.size() < count - 1)
+				AlignedVector<LinearNode>(count - 1).swap(s.m_tree);
+			s.m_leaf_parents.resize(count);
+			LinearNode *tree = s.m_tree.data();
+			ParallelFor(count - 1, s_linear_grain, [&](const size_t &begin, const size_t &end) {
+				for (size_t i = begin; i < end; i++)
+					emitInternal(tree, s.m_leaf_parents.data(), s.m_codes.data(), uint32_t(i), count);
+			});
+			ParallelFor(count, s_linear_grain, [&](const size_t &begin, const size_t &end) {
+				for (size_t i = begin; i < end; i++)
+					fitUpwards(tree, s.m_leaf_bboxes.data(), s.m_leaf_parents[i]);
+			});
+
+			allocateNodes(tree[0].m_node_count);
+			m_node_count = tree[0].m_node_count;
+			flattenLinear(tree, s.m_leaf_bboxes.data(), 0, 0, 0);
+		}
+
+		AYA_FORCE_INLINE const BVHNode* getNodes() const {
+			return mp_nodes;
+		}
+		AYA_FORCE_INLINE uint32_t getNodeCount() const {
+			return m_node_count;
+		}
+		AYA_FORCE_INLINE const uint32_t* getPrimitiveIds() const {
+			return m_prim_ids.data();
+		}
+		AYA_FORCE_INLINE BBox getBBox() const {
+			return m_node_count ? mp_nodes[0].getBBox() : BBox();
+		}
+
+		// Front-to-back traversal, func(prim_id) is called for every primitive in a leaf whose
+		// box is hit and returns whether the primitive was hit. It may shrink r.m_maxt.
+		template<class Func>
+		bool intersect(SlabRay &r, const Func &func) const {
+			if (!mp_nodes)
+				return false;
+
+			bool hit = false;
+			uint32_t to_visit[64];
+			uint32_t to_visit_offset = 0, current = 0;
+			while (true) {
+				const BVHNode &node = mp_nodes[current];
+				if (node.getBBox().intersect(r)) {
+					if (node.isLeaf()) {
+						for (uint32_t i = 0; i < node.m_prim_count; i++)
+							if (func(m_prim_ids[node.m_offset + i]))
+								hit = true;
+						if (to_visit_offset == 0) break;
+						current = to_visit[--to_visit_offset];
+					}
+					else {
+						if (r.m_dir_is_neg[node.m_axis]) {
+							to_visit[to_visit_offset++] = current + 1;
+							current = node.m_offset;
+						}
+						else {
+							to_visit[to_visit_offset++] = node.m_offset;
+							current = current + 1;
+						}
+					}
+				}
+				else {
+					if (to_visit_offset == 0) break;
+					current = to_visit[--to_visit_offset];
+				}
+			}
+			return hit;
+		}
+
+	private:
+		BuildNode* makeLeaf(BuildNode *node, const uint32_t &start, const uint32_t &end) const {
+			node->m_children[0] = node->m_children[1] = nullptr;
+			node->m_offset = start;
+			node->m_prim_count = end - start;
+			node->m_node_count = 1;
+			node->m_axis = 0;
+			return node;
+		}
+
+		BuildNode* recursiveBuild(PrimitiveInfo *prims, const uint32_t &start, const uint32_t &end, const int &depth) const {
+			BuildNode *node = new BuildNode;
+
+			BBox bbox;
+			for (uint32_t i = start; i < end; i++)
+				bbox.unity(prims[i].m_bbox);
+			node->m_bbox = bbox;
+
+			uint32_t count = end - start;
+			if (count == 1)
+				return makeLeaf(node, start, end);
+
+			BBox centroid_bbox;
+			for (uint32_t i = start; i < end; i++)
+				centroid_bbox.unity(prims[i].m_centroid);
+			int dim = centroid_bbox.maxExtent();
+
+			uint32_t mid = (start + end) / 2;
+			if (centroid_bbox.m_pmax[dim] == centroid_bbox.m_pmin[dim]) {
+				// coincident centroids, keep them in one leaf if it is small enough
+				if (count <= m_max_prims_in_node)
+					return makeLeaf(node, start, end);
+			}
+			else if (count <= 2) {
+				std::nth_element(&prims[start], &prims[mid], &prims[end - 1] + 1,
+					[dim](const PrimitiveInfo &a, const PrimitiveInfo &b) {
+					return a.m_centroid[dim] < b.m_centroid[dim];
+				});
+			}
+			else {
+				uint32_t bucket_count[s_bucket_count] = { 0 };
+				BBox bucket_bbox[s_bucket_count];
+				auto bucketOf = [&](const PrimitiveInfo &p) {
+					uint32_t b = uint32_t(s_bucket_count * centroid_bbox.offset(p.m_centroid)[dim]);
+					return Min(b, s_bucket_count - 1);
+				};
+				for (uint32_t i = start; i < end; i++) {
+					uint32_t b = bucketOf(prims[i]);
+					bucket_count[b]++;
+					bucket_bbox[b].unity(prims[i].m_bbox);
+				}
+
+				// sweep from the right once, then from the left, instead of re-merging per split
+				float right_area[s_bucket_count];
+				BBox acc;
+				uint32_t acc_count = 0;
+				for (uint32_t b = s_bucket_count - 1; b > 0; b--) {
+					acc.unity(bucket_bbox[b]);
+					acc_count += bucket_count[b];
+					right_area[b] = acc_count * acc.surfaceArea();
+				}
+
+				float min_cost = INFINITY;
+				uint32_t min_bucket = 0;
+				acc = BBox();
+				acc_count = 0;
+				for (uint32_t b = 0; b < s_bucket_count - 1; b++) {
+					acc.unity(bucket_bbox[b]);
+					acc_count += bucket_count[b];
+					float cost = acc_count * acc.surfaceArea() + right_area[b + 1];
+					if (cost < min_cost) {
+						min_cost = cost;
+						min_bucket = b;
+					}
+				}
+				min_cost = 1.f + min_cost / bbox.surfaceArea();
+
+				if (count > m_max_prims_in_node || min_cost < float(count)) {
+					PrimitiveInfo *p_mid = std::partition(&prims[start], &prims[end - 1] + 1,
+						[&](const PrimitiveInfo &p) {
+						return bucketOf(p) <= min_bucket;
+					});
+					mid = uint32_t(p_mid - &prims[0]);
+					if (mid == start || mid == end)
+						mid = (start + end) / 2;
+				}
+				else
+					return makeLeaf(node, start, end);
+			}
+
+			node->m_axis = dim;
+			node->m_prim_count = 0;
+			if (depth < m_max_parallel_depth && count >= s_parallel_threshold) {
+				ThreadPool::global().run(2, [&](const size_t &i) {
+					node->m_children[i] = recursiveBuild(prims, i ? mid : start, i ? end : mid, depth + 1);
+				});
+			}
+			else {
+				node->m_children[0] = recursiveBuild(prims, start, mid, depth + 1);
+				node->m_children[1] = recursiveBuild(prims, mid, end, depth + 1);
+			}
+			node->m_node_count = 1 + node->m_children[0]->m_node_count + node->m_children[1]->m_node_count;
+
+			return node;
+		}
+
+		void allocateNodes(const uint32_t &count) {
+			if (m_node_capacity < count) {
+				if (mp_nodes)
+					_mm_free(mp_nodes);
+				mp_nodes = (BVHNode*)_mm_malloc(sizeof(BVHNode) * count, 64);
+				m_node_capacity = count;
+			}
+		}
+
+		static uint32_t chunkCount(const uint32_t &count) {
+			uint32_t threads = uint32_t(ThreadPool::global().getThreadCount());
+			return Max(Min(threads, (count + s_linear_grain - 1) / s_linear_grain), 1u);
+		}
+		// func(c) for every c in [0, chunks) on the shared pool of ParallelFor
+		template<class Func>
+		static void parallelChunks(const uint32_t &chunks, const Func &func) {
+			ThreadPool::global().run(chunks, [&func](const size_t &c) {
+				func(uint32_t(c));
+			});
+		}
+
+		// Stable LSD radix sort of 30-bit keys with their values, s_radix_bits per pass. Each
+		// chunk counts its digits, the per chunk offsets are prefix sums over (digit, chunk).
+		static void radixSort(LinearScratch &s, const uint32_t &count, const uint32_t &chunks) {
+			const uint32_t chunk_size = (count + chunks - 1) / chunks;
+			const uint32_t buckets = 1u << s_radix_bits;
+			std::vector<uint32_t> &keys = s.m_codes, &values = s.m_order;
+			std::vector<uint32_t> &keys_tmp = s.m_codes_tmp, &values_tmp = s.m_order_tmp;
+			std::vector<uint32_t> &offsets = s.m_offsets;
+			keys_tmp.resize(count);
+			values_tmp.resize(count);
+			offsets.resize(chunks * buckets);
+
+			for (uint32_t shift = 0; shift < 30; shift += s_radix_bits) {
+				parallelChunks(chunks, [&](const uint32_t &c) {
+					uint32_t *hist = &offsets[c * buckets];
+					std::fill(hist, hist + buckets, 0u);
+					for (uint32_t i = c * chunk_size; i < Min(count, (c + 1) * chunk_size); i++)
+						hist[(keys[i] >> shift) & (buckets - 1)]++;
+				});
+				uint32_t sum = 0;
+				for (uint32_t b = 0; b < buckets; b++) {
+					for (uint32_t c = 0; c < chunks; c++) {
+						uint32_t n = offsets[c * buckets + b];
+						offsets[c * buckets + b] = sum;
+						sum += n;
+					}
+				}
+				parallelChunks(chunks, [&](const uint32_t &c) {
+					uint32_t *offset = &offsets[c * buckets];
+					for (uint32_t i = c * chunk_size; i < Min(count, (c + 1) * chunk_size); i++) {
+						uint32_t dst = offset[(keys[i] >> shift) & (buckets - 1)]++;
+						keys_tmp[dst] = keys[i];
+						values_tmp[dst] = values[i];
+					}
+				});
+				keys.swap(keys_tmp);
+				values.swap(values_tmp);
+			}
+		}
+
+		// Length of the common prefix of sorted keys i and j, -1 outside the array. Equal keys
+		// fall back to the indices so that duplicates still split.
+		static AYA_FORCE_INLINE int commonPrefix(const uint32_t *codes, const int &i, const int &j, const int &count) {
+			if (j < 0 || j >= count)
+				return -1;
+			if (codes[i] == codes[j])
+				return 32 + int(CountLeadingZeros(uint32_t(i ^ j)));
+			return int(CountLeadingZeros(codes[i] ^ codes[j]));
+		}
+
+		static void emitInternal(LinearNode *tree, uint32_t *leaf_parents, const uint32_t *codes,
+			const uint32_t &index, const uint32_t &count) {
+			const int i = int(index), n = int(count);
+			const int d = commonPrefix(codes, i, i + 1, n) - commonPrefix(codes, i, i - 1, n) > 0 ? 1 : -1;
+
+			// the far end of the range, exponential then binary search
+			const int min_prefix = commonPrefix(codes, i, i - d, n);
+			int max_len = 2;
+			while (commonPrefix(codes, i, i + max_len * d, n) > min_prefix)
+				max_len <<= 1;
+			int len = 0;
+			for (int t = max_len >> 1; t >= 1; t >>= 1)
+				if (commonPrefix(codes, i, i + (len + t) * d, n) > min_prefix)
+					len += t;
+			const int j = i + len * d;
+
+			// the split, last position sharing more than the node prefix
+			const int node_prefix = commonPrefix(codes, i, j, n);
+			int split = 0, t = len;
+			do {
+				t = (t + 1) >> 1;
+				if (commonPrefix(codes, i, i + (split + t) * d, n) > node_prefix)
+					split += t;
+			} while (t > 1);
+			const int gamma = i + split * d + Min(d, 0);
+
+			const uint32_t first = uint32_t(Min(i, j)), last = uint32_t(Max(i, j));
+			const uint32_t left = first == uint32_t(gamma) ? uint32_t(gamma) | s_leaf_flag : uint32_t(gamma);
+			const uint32_t right = last == uint32_t(gamma + 1) ? uint32_t(gamma + 1) | s_leaf_flag : uint32_t(gamma + 1);
+			LinearNode &node = tree[index];
+			node.m_children[0] = left;
+			node.m_children[1] = right;
+			node.m_first = first;
+			node.m_last = last;
+			// the first differing bit of a 30-bit key, bit 29 is x
+			node.m_axis = node_prefix < 32 ? uint8_t((node_prefix - 2) % 3) : 0;
+			node.m_visits.store(0, std::memory_order_relaxed);
+			if (left & s_leaf_flag)
+				leaf_parents[left & ~s_leaf_flag] = index;
+			else
+				tree[left].m_parent = index;
+			if (right & s_leaf_flag)
+				leaf_parents[right & ~s_leaf_flag] = index;
+			else
+				tree[right].m_parent = index;
+		}
+
+		// Walks from a leaf towards the root, the second child to arrive at a node fits its
+		// box with BBox::unity and keeps going, the first one stops there.
+		void fitUpwards(LinearNode *tree, const BBox *leaf_bboxes, uint32_t index) const {
+			while (true) {
+				LinearNode &node = tree[index];
+				if (node.m_visits.fetch_add(1, std::memory_order_acq_rel) == 0)
+					return;
+
+				BBox b;
+				uint32_t node_count = 1;
+				for (int k = 0; k < 2; k++) {
+					const uint32_t child = node.m_children[k];
+					if (child & s_leaf_flag) {
+						b.unity(leaf_bboxes[child & ~s_leaf_flag]);
+						node_count += 1;
+					}
+					else {
+						b.unity(tree[child].m_bbox);
+						node_count += tree[child].m_node_count;
+					}
+				}
+				node.m_bbox = b;
+				node.m_node_count = node.m_last - node.m_first < m_max_prims_in_node ? 1 : node_count;
+				if (index == 0)
+					return;
+				index = node.m_parent;
+			}
+		}
+
+		// Writes the subtree of node at offset in depth-first order. Internal nodes covering at
+		// most m_max_prims_in_node primitives become one leaf, large subtrees are written on
+		// separate threads.
+		void flattenLinear(const LinearNode *tree, const BBox *leaf_bboxes,
+			const uint32_t &index, const uint32_t &offset, const int &depth) {
+			BVHNode &linear = mp_nodes[offset];
+			linear.m_pad = 0;
+			if (index & s_leaf_flag) {
+				const uint32_t prim = index & ~s_leaf_flag;
+				linear.setBBox(leaf_bboxes[prim]);
+				linear.m_axis = 0;
+				linear.m_offset = prim;
+				linear.m_prim_count = 1;
+				return;
+			}
+
+			const LinearNode &node = tree[index];
+			linear.setBBox(node.m_bbox);
+			linear.m_axis = node.m_axis;
+			const uint32_t prim_count = node.m_last - node.m_first + 1;
+			if (prim_count <= m_max_prims_in_node) {
+				linear.m_offset = node.m_first;
+				linear.m_prim_count = uint16_t(prim_count);
+				return;
+			}
+
+			const uint32_t left = node.m_children[0], right = node.m_children[1];
+			const uint32_t right_offset = offset + 1 + ((left & s_leaf_flag) ? 1 : tree[left].m_node_count);
+			linear.m_offset = right_offset;
+			linear.m_prim_count = 0;
+			if (depth < m_max_parallel_depth && prim_count >= s_parallel_threshold) {
+				ThreadPool::global().run(2, [&](const size_t &i) {
+					if (i == 0)
+						flattenLinear(tree, leaf_bboxes, left, offset + 1, depth + 1);
+					else
+						flattenLinear(tree, leaf_bboxes, right, right_offset, depth + 1);
+				});
+			}
+			else {
+				flattenLinear(tree, leaf_bboxes, left, offset + 1, depth + 1);
+				flattenLinear(tree, leaf_bboxes, right, right_offset, depth + 1);
+			}
+		}
+
+		uint32_t flatten(const BuildNode *node, uint32_t *offset) {
+			BVHNode &linear = mp_nodes[*offset];
+			linear.setBBox(node->m_bbox);
+			linear.m_axis = uint8_t(node->m_axis);
+			linear.m_pad = 0;
+
+			uint32_t ret = (*offset)++;
+			if (node->m_prim_count > 0) {
+				linear.m_offset = node->m_offset;
+				linear.m_prim_count = uint16_t(node->m_prim_count);
+			}
+			else {
+				linear.m_prim_count = 0;
+				flatten(node->m_children[0], offset);
+				linear.m_offset = flatten(node->m_children[1], offset);
+			}
+			return ret;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef AYA_MATH_CPUFEATURES_H
+#define AYA_MATH_CPUFEATURES_H
+
+#include "MathUtility.h"
+
+#include <atomic>
+
+#if !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
+// Per-function ISA targets for kernels that are picked at runtime, the rest of the
+// library keeps building against the baseline ISA.
+#if defined(_MSC_VER)
+#define AYA_TARGET_AVX2
+#define AYA_TARGET_AVX512
+#define AYA_TARGET_BMI2
+#elif defined(AYA_USE_FMA)
+#define AYA_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define AYA_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#define AYA_TARGET_BMI2 __attribute__((target("bmi2")))
+#else
+// no fma here, or the compiler may contract the wide kernels where the 4-wide path can't
+#define AYA_TARGET_AVX2 __attribute__((target("avx2")))
+#define AYA_TARGET_AVX512 __attribute__((target("avx512f,avx2")))
+#define AYA_TARGET_BMI2 __attribute__((target("bmi2")))
+#endif
+
+namespace Aya {
+	enum SimdLevel {
+		SIMD_SCALAR = 0,
+		SIMD_SSE2,
+		SIMD_SSE41,
+		SIMD_AVX2,
+		SIMD_AVX512
+	};
+
+	// Instruction set level of the running CPU, detected once with cpuid/xgetbv.
+	// setLevel can force a lower level, e.g. to exercise the narrower kernels.
+	class CpuFeatures {
+	public:
+		static SimdLevel getSupportedLevel() {
+			static const SimdLevel level = detect();
+			return level;
+		}
+		static SimdLevel getLevel() {
+			return (SimdLevel)activeLevel().load(std::memory_order_relaxed);
+		}
+		static void setLevel(const SimdLevel &level) {
+			activeLevel().store(Min(level, getSupportedLevel()), std::memory_order_relaxed);
+		}
+
+		// BMI2 PDEP/PEXT in hardware. AMD before Zen 3 (family 19h) runs them in microcode at
+		// hundreds of cycles, those count as not supported.
+		static bool hasFastPDEP() {
+			static const bool fast = detectFastPDEP();
+			return fast;
+		}
+
+	private:
+		static std::atomic<int> &activeLevel() {
+			static std::atomic<int> level(getSupportedLevel());
+			return level;
+		}
+
+		static void cpuid(const uint32_t &leaf, const uint32_t &subleaf, uint32_t reg[4]) {
+#if defined(_MSC_VER)
+			__cpuidex((int *)reg, (int)leaf, (int)subleaf);
+#else
+			__cpuid_count(leaf, subleaf, reg[0], reg[1], reg[2], reg[3]);
+#endif
+		}
+		static uint64_t xgetbv() {
+#if defined(_MSC_VER)
+			return _xgetbv(0);
+#else
+			uint32_t lo, hi;
+			__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+			return ((uint64_t)hi << 32) | lo;
+#endif
+		}
+
+		static SimdLevel detect() {
+#if !defined(AYA_USE_SIMD)
+			return SIMD_SCALAR;
+#else
+			uint32_t reg[4];
+			cpuid(0, 0, reg);
+			const uint32_t max_leaf = reg[0];
+
+			cpuid(1, 0, reg);
+			if (!(reg[3] & (1u << 26)))
+				return SIMD_SCALAR;
+			if (!(reg[2] & (1u << 19)))
+				return SIMD_SSE2;
+
+			// AVX state has to be enabled by the OS as well
+			const bool osxsave = (reg[2] & (1u << 27)) != 0;
+			const bool avx = (reg[2] & (1u << 28)) != 0;
+			const bool fma = (reg[2] & (1u << 12)) != 0;
+			if (!osxsave || !avx || !fma || max_leaf < 7)
+				return SIMD_SSE41;
+			const uint64_t xcr0 = xgetbv();
+			if ((xcr0 & 0x6) != 0x6)
+				return SIMD_SSE41;
+
+			cpuid(7, 0, reg);
+			if (!(reg[1] & (1u << 5)))
+				return SIMD_SSE41;
+			if (!(reg[1] & (1u << 16)) || (xcr0 & 0xe6) != 0xe6)
+				return SIMD_AVX2;
+			return SIMD_AVX512;
+#endif
+		}
+		static bool detectFastPDEP() {
+#if !defined(AYA_USE_SIMD)
+			return false;
+#else
+			if (getSupportedLevel() < SIMD_AVX2)
+				return false;
+			uint32_t reg[4];
+			cpuid(7, 0, reg);
+			if (!(reg[1] & (1u << 8)))
+				return false;
+
+			cpuid(0, 0, reg);
+			const bool amd = reg[1] == 0x68747541 && reg[3] == 0x69746e65 && reg[2] == 0x444d4163;	// "AuthenticAMD"
+			if (!amd)
+				return true;
+			cpuid(1, 0, reg);
+			uint32_t family = (reg[0] >> 8) & 0xf;
+			if (family == 0xf)
+				family += (reg[0] >> 20) & 0xff;
+			return family >= 0x19;
+#endif
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,455 @@
+#ifndef AYA_MATH_DIRECTIONMAP_H
+#define AYA_MATH_DIRECTIONMAP_H
+
+#include "Vector2.h"
+#include "Vector3x4.h"
+#include "Vector3x8.h"
+#include "SimdMath.h"
+#include "Parallel.h"
+
+namespace Aya {
+	// Conversions between unit directions and their 2D parameterizations, for one direction or
+	// for whole arrays (4 or 8 per packet, large arrays split across threads):
+	//
+	//   spherical    (theta, phi) as in BaseVector3::sphericalDirection: y is the pole,
+	//                theta = acos(y) in [0, pi], phi = atan2(z, x) in [0, 2pi)
+	//   equirect     uv = (phi / 2pi, theta / pi)
+	//   octahedral   uv in [0, 1]^2 over the z-folded octahedron, the layout of OctNormal
+	//   cube         face (CubeFace) and uv in [0, 1]^2, OpenGL cube map convention
+	//
+	// Zero and denormal length directions map to the center: (0.5, 0.5) in the octahedral layout,
+	// (0.5, 0.5) on CUBE_FACE_POS_X for the cube.
+	//
+	// Every variant runs the same kernel, so a direction maps identically alone or in a batch.
+	// Angles go through the full precision SimdMath functions.
+	class DirectionMap {
+	public:
+		enum CubeFace {
+			CUBE_FACE_POS_X = 0,
+			CUBE_FACE_NEG_X,
+			CUBE_FACE_POS_Y,
+			CUBE_FACE_NEG_Y,
+			CUBE_FACE_POS_Z,
+			CUBE_FACE_NEG_Z
+		};
+
+		static const size_t s_parallel_grain = 1 << 14;
+
+	public:
+		static AYA_FORCE_INLINE BaseVector3 sphericalDirection(const float &theta, const float &phi) {
+			SimdMath::Scalar x, y, z;
+			sphericalKernel(SimdMath::toScalar(theta), SimdMath::toScalar(phi), &x, &y, &z);
+			return toVector(x, y, z);
+		}
+		static AYA_FORCE_INLINE void sphericalAngles(const BaseVector3 &d, float *theta, float *phi) {
+			SimdMath::Scalar t, p;
+			anglesKernel(SimdMath::toScalar(d.x()), SimdMath::toScalar(d.y()), SimdMath::toScalar(d.z()), &t, &p);
+			*theta = SimdMath::fromScalar(t);
+			*phi = SimdMath::fromScalar(p);
+		}
+		static AYA_FORCE_INLINE Vector2f toEquirect(const BaseVector3 &d) {
+			SimdMath::Scalar u, v;
+			toEquirectKernel(SimdMath::toScalar(d.x()), SimdMath::toScalar(d.y()), SimdMath::toScalar(d.z()), &u, &v);
+			return toUV(u, v);
+		}
+		static AYA_FORCE_INLINE BaseVector3 fromEquirect(const Vector2f &uv) {
+			SimdMath::Scalar x, y, z;
+			fromEquirectKernel(SimdMath::toScalar(uv.u), SimdMath::toScalar(uv.v), &x, &y, &z);
+			return toVector(x, y, z);
+		}
+		static AYA_FORCE_INLINE Vector2f toOctahedral(const BaseVector3 &d) {
+			SimdMath::Scalar u, v;
+			toOctahedralKernel(SimdMath::toScalar(d.x()), SimdMath::toScalar(d.y()), SimdMath::toScalar(d.z()), &u, &v);
+			return toUV(u, v);
+		}
+		static AYA_FORCE_INLINE BaseVector3 fromOctahedral(const Vector2f &uv) {
+			SimdMath::Scalar x, y, z;
+			fromOctahedralKernel(SimdMath::toScalar(uv.u), SimdMath::toScalar(uv.v), &x, &y, &z);
+			return toVector(x, y, z);
+		}
+		static AYA_FORCE_INLINE Vector2f toCube(const BaseVector3 &d, int *face) {
+			SimdMath::Scalar f, u, v;
+			toCubeKernel(SimdMath::toScalar(d.x()), SimdMath::toScalar(d.y()), SimdMath::toScalar(d.z()), &f, &u, &v);
+			*face = int(SimdMath::fromScalar(f));
+			return toUV(u, v);
+		}
+		static AYA_FORCE_INLINE BaseVector3 fromCube(const int &face, const Vector2f &uv) {
+			SimdMath::Scalar x, y, z;
+			fromCubeKernel(SimdMath::toScalar(float(face)), SimdMath::toScalar(uv.u), SimdMath::toScalar(uv.v), &x, &y, &z);
+			return toVector(x, y, z);
+		}
+
+		// Batched versions over Point3/Vector3/Normal3 arrays, angles are separate float arrays
+		template<class T>
+		static void sphericalDirection(const float *theta, const float *phi, T *out, const size_t &n) {
+			ParallelFor(n, s_parallel_grain, [=](const size_t &begin, const size_t &end) {
+				size_t i = begin;
+#if defined(AYA_USE_AVX)
+				for (; i + 8 <= end; i += 8) {
+					__m256 x, y, z;
+					sphericalKernel(_mm256_loadu_ps(theta + i), _mm256_loadu_ps(phi + i), &x, &y, &z);
+					Vector3x8(x, y, z).store(out + i);
+				}
+#endif
+#if defined(AYA_USE_SIMD)
+				for (; i + 4 <= end; i += 4) {
+					__m128 x, y, z;
+					sphericalKernel(_mm_loadu_ps(theta + i), _mm_loadu_ps(phi + i), &x, &y, &z);
+					Vector3x4(x, y, z).store(out + i);
+				}
+#endif
+				for (; i < end; i++)
+					out[i] = T(sphericalDirection(theta[i], phi[i]));
+			});
+		}
+		template<class T>
+		static void sphericalAngles(const T *in, float *theta, float *phi, const size_t &n) {
+			ParallelFor(n, s_parallel_grain, [=](const size_t &begin, const size_t &end) {
+				size_t i = begin;
+#if defined(AYA_USE_AVX)
+				for (; i + 8 <= end; i += 8) {
+					Vector3x8 d = Vector3x8::load(in + i);
+					__m256 t, p;
+					anglesKernel(d.m_val256[0], d.m_val256[1], d.m_val256[2], &t, &p);
+					_mm256_storeu_ps(theta + i, t);
+					_mm256_storeu_ps(phi + i, p);
+				}
+#endif
+#if defined(AYA_USE_SIMD)
+				for (; i + 4 <= end; i += 4) {
+					Vector3x4 d = Vector3x4::load(in + i);
+					__m128 t, p;
+					anglesKernel(d.m_val128[0], d.m_val128[1], d.m_val128[2], &t, &p);
+					_mm_storeu_ps(theta + i, t);
+					_mm_storeu_ps(phi + i, p);
+				}
+#endif
+				for (; i < end; i++)
+					sphericalAngles(in[i], theta + i, phi + i);
+			});
+		}
+		template<class T>
+		static void toEquirect(const T *in, Vector2f *uv, const size_t &n) {
+			ParallelFor(n, s_parallel_grain, [=](const size_t &begin, const size_t &end) {
+				size_t i = begin;
+#if defined(AYA_USE_AVX)
+				for (; i + 8 <= end; i += 8) {
+					Vector3x8 d = Vector3x8::load(in + i);
+					__m256 u, v;
+					toEquirectKernel(d.m_val256[0], d.m_val256[1], d.m_val256[2], &u, &v);
+					storeUV(uv + i, u, v);
+				}
+#endif
+#if defined(AYA_USE_SIMD)
+				for (; i + 4 <= end; i += 4) {
+					Vector3x4 d = Vector3x4::load(in + i);
+					__m128 u, v;
+					toEquirectKernel(d.m_val128[0], d.m_val128[1], d.m_val128[2], &u, &v);
+					storeUV(uv + i, u, v);
+				}
+#endif
+				for (; i < end; i++)
+					uv[i] = toEquirect(in[i]);
+			});
+		}
+		template<class T>
+		static void fromEquirect(const Vector2f *uv, T *out, const size_t &n) {
+			ParallelFor(n, s_parallel_grain, [=](const size_t &begin, const size_t &end) {
+				size_t i = begin;
+#if defined(AYA_USE_AVX)
+				for (; i + 8 <= end; i += 8) {
+					__m256 u, v, x, y, z;
+					loadUV(uv + i, &u, &v);
+					fromEquirectKernel(u, v, &x, &y, &z);
+					Vector3x8(x, y, z).store(out + i);
+				}
+#endif
+#if defined(AYA_USE_SIMD)
+				for (; i + 4 <= end; i += 4) {
+					__m128 u, v, x, y, z;
+					loadUV(uv + i, &u, &v);
+					fromEquirectKernel(u, v, &x, &y, &z);
+					Vector3x4(x, y, z).store(out + i);
+				}
+#endif
+				for (; i < end; i++)
+					out[i] = T(fromEquirect(uv[i]));
+			});
+		}
+		template<class T>
+		static void toOctahedral(const T *in, Vector2f *uv, const size_t &n) {
+			ParallelFor(n, s_parallel_grain, [=](const size_t &begin, const size_t &end) {
+				size_t i = begin;
+#if defined(AYA_USE_AVX)
+				for (; i + 8 <= end; i += 8) {
+					Vector3x8 d = Vector3x8::load(in + i);
+					__m256 u, v;
+					toOctahedralKernel(d.m_val256[0], d.m_val256[1], d.m_val256[2], &u, &v);
+					storeUV(uv + i, u, v);
+				}
+#endif
+#if defined(AYA_USE_SIMD)
+				for (; i + 4 <= end; i += 4) {
+					Vector3x4 d = Vector3x4::load(in + i);
+					__m128 u, v;
+					toOctahedralKernel(d.m_val128[0], d.m_val128[1], d.m_val128[2], &u, &v);
+					storeUV(uv + i, u, v);
+				}
+#endif
+				for (; i < end; i++)
+					uv[i] = toOctahedral(in[i]);
+			});
+		}
+		template<class T>
+		static void fromOctahedral(const Vector2f *uv, T *out, const size_t &n) {
+			ParallelFor(n, s_parallel_grain, [=](const size_t &begin, const size_t &end) {
+				size_t i = begin;
+#if defined(AYA_USE_AVX)
+				for (; i + 8 <= end; i += 8) {
+					__m256 u, v, x, y, z;
+					loadUV(uv + i, &u, &v);
+					fromOctahedralKernel(u, v, &x, &y, &z);
+					Vector3x8(x, y, z).store(out + i);
+				}
+#endif
+#if defined(AYA_USE_SIMD)
+				for (; i + 4 <= end; i += 4) {
+					__m128 u, v, x, y, z;
+					loadUV(uv + i, &u, &v);
+					fromOctahedralKernel(u, v, &x, &y, &z);
+					Vector3x4(x, y, z).store(out + i);
+				}
+#endif
+				for (; i < end; i++)
+					out[i] = T(fromOctahedral(uv[i]));
+			});
+		}
+		template<class T>
+		static void toCube(const T *in, int *face, Vector2f *uv, const size_t &n) {
+			ParallelFor(n, s_parallel_grain, [=](const size_t &begin, const size_t &end) {
+				size_t i = begin;
+#if defined(AYA_USE_AVX)
+				for (; i + 8 <= end; i += 8) {
+					Vector3x8 d = Vector3x8::load(in + i);
+					__m256 f, u, v;
+					toCubeKernel(d.m_val256[0], d.m_val256[1], d.m_val256[2], &f, &u, &v);
+					_mm256_storeu_si256((__m256i*)(face + i), _mm256_cvttps_epi32(f));
+					storeUV(uv + i, u, v);
+				}
+#endif
+#if defined(AYA_USE_SIMD)
+				for (; i + 4 <= end; i += 4) {
+					Vector3x4 d = Vector3x4::load(in + i);
+					__m128 f, u, v;
+					toCubeKernel(d.m_val128[0], d.m_val128[1], d.m_val128[2], &f, &u, &v);
+					_mm_storeu_si128((__m128i*)(face + i), _mm_cvttps_epi32(f));
+					storeUV(uv + i, u, v);
+				}
+#endif
+				for (; i < end; i++)
+					uv[i] = toCube(in[i], face + i);
+			});
+		}
+		template<class T>
+		static void fromCube(const int *face, const Vector2f *uv, T *out, const size_t &n) {
+			ParallelFor(n, s_parallel_grain, [=](const size_t &begin, const size_t &end) {
+				size_t i = begin;
+#if defined(AYA_USE_AVX)
+				for (; i + 8 <= end; i += 8) {
+					__m256 u, v, x, y, z;
+					loadUV(uv + i, &u, &v);
+					fromCubeKernel(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(face + i))), u, v, &x, &y, &z);
+					Vector3x8(x, y, z).store(out + i);
+				}
+#endif
+#if defined(AYA_USE_SIMD)
+				for (; i + 4 <= end; i += 4) {
+					__m128 u, v, x, y, z;
+					loadUV(uv + i, &u, &v);
+					fromCubeKernel(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(face + i))), u, v, &x, &y, &z);
+					Vector3x4(x, y, z).store(out + i);
+				}
+#endif
+				for (; i < end; i++)
+					out[i] = T(fromCube(face[i], uv[i]));
+			});
+		}
+
+	private:
+		template<class V>
+		static AYA_FORCE_INLINE void sphericalKernel(const V &theta, const V &phi, V *x, V *y, V *z) {
+			V sin_theta, cos_theta, sin_phi, cos_phi;
+			SimdMath::sincos(theta, &sin_theta, &cos_theta);
+			SimdMath::sincos(phi, &sin_phi, &cos_phi);
+			*x = SimdMath::mul(sin_theta, cos_phi);
+			*y = cos_theta;
+			*z = SimdMath::mul(sin_theta, sin_phi);
+		}
+		template<class V>
+		static AYA_FORCE_INLINE void anglesKernel(const V &x, const V &y, const V &z, V *theta, V *phi) {
+			const V zero = SimdMath::splat(x, 0.f);
+			const V one = SimdMath::splat(x, 1.f);
+			*theta = SimdMath::acos(SimdMath::max(SimdMath::sub(zero, one), SimdMath::min(y, one)));
+			const V two_pi = SimdMath::splat(x, float(M_PI) * 2.f);
+			const V p = SimdMath::atan2(z, x);
+			// a tiny negative p rounds to 2pi when wrapped, that is the direction of 0
+			const V wrapped = SimdMath::select(SimdMath::cmpLt(p, zero), SimdMath::add(p, two_pi), p);
+			*phi = SimdMath::select(SimdMath::cmpGe(wrapped, two_pi), zero, wrapped);
+		}
+
+		template<class V>
+		static AYA_FORCE_INLINE void toEquirectKernel(const V &x, const V &y, const V &z, V *u, V *v) {
+			V theta, phi;
+			anglesKernel(x, y, z, &theta, &phi);
+			*u = SimdMath::mul(phi, SimdMath::splat(x, float(.5 * M_1_PI)));
+			*v = SimdMath::mul(theta, SimdMath::splat(x, float(M_1_PI)));
+		}
+		template<class V>
+		static AYA_FORCE_INLINE void fromEquirectKernel(const V &u, const V &v, V *x, V *y, V *z) {
+			sphericalKernel(SimdMath::mul(v, SimdMath::splat(u, float(M_PI))),
+				SimdMath::mul(u, SimdMath::splat(u, float(M_PI) * 2.f)), x, y, z);
+		}
+
+		// Projects onto |x| + |y| + |z| = 1 and folds the z < 0 half over the diagonals, the
+		// float counterpart of OctNormal. Zero and denormal lengths, where 1 / sum would overflow,
+		// map to the center.
+		template<class V>
+		static AYA_FORCE_INLINE void toOctahedralKernel(const V &x, const V &y, const V &z, V *u, V *v) {
+			const V zero = SimdMath::splat(x, 0.f);
+			const V one = SimdMath::splat(x, 1.f);
+			const V half = SimdMath::splat(x, .5f);
+			const V sum = SimdMath::add(SimdMath::add(SimdMath::abs(x), SimdMath::abs(y)), SimdMath::abs(z));
+			const V inv = SimdMath::select(SimdMath::cmpGe(sum, SimdMath::splat(x, FLT_MIN)), SimdMath::div(one, sum), zero);
+			V a = SimdMath::mul(x, inv), b = SimdMath::mul(y, inv);
+
+			const V lower = SimdMath::cmpLt(z, zero);
+			const V fa = SimdMath::bitOr(SimdMath::sub(one, SimdMath::abs(b)), signNotZero(a));
+			const V fb = SimdMath::bitOr(SimdMath::sub(one, SimdMath::abs(a)), signNotZero(b));
+			a = SimdMath::select(lower, fa, a);
+			b = SimdMath::select(lower, fb, b);
+			*u = SimdMath::madd(a, half, half);
+			*v = SimdMath::madd(b, half, half);
+		}
+		template<class V>
+		static AYA_FORCE_INLINE void fromOctahedralKernel(const V &u, const V &v, V *x, V *y, V *z) {
+			const V zero = SimdMath::splat(u, 0.f);
+			const V one = SimdMath::splat(u, 1.f);
+			const V two = SimdMath::splat(u, 2.f);
+			V a = SimdMath::sub(SimdMath::mul(u, two), one);
+			V b = SimdMath::sub(SimdMath::mul(v, two), one);
+			const V c = SimdMath::sub(SimdMath::sub(one, SimdMath::abs(a)), SimdMath::abs(b));
+
+			// unfold the lower half, moving a and b towards zero by max(-c, 0)
+			const V t = SimdMath::max(SimdMath::sub(zero, c), zero);
+			a = SimdMath::sub(a, SimdMath::bitOr(t, signNotZero(a)));
+			b = SimdMath::sub(b, SimdMath::bitOr(t, signNotZero(b)));
+			normalize(a, b, c, x, y, z);
+		}
+
+		// The major axis picks the face, the other two coordinates divided by it give uv
+		template<class V>
+		static AYA_FORCE_INLINE void toCubeKernel(const V &x, const V &y, const V &z, V *face, V *u, V *v) {
+			const V zero = SimdMath::splat(x, 0.f);
+			const V half = SimdMath::splat(x, .5f);
+			const V ax = SimdMath::abs(x), ay = SimdMath::abs(y), az = SimdMath::abs(z);
+			const V major_x = SimdMath::bitAnd(SimdMath::cmpGe(ax, ay), SimdMath::cmpGe(ax, az));
+			const V major_y = SimdMath::bitAndNot(major_x, SimdMath::cmpGe(ay, az));
+			const V major_z = SimdMath::bitAndNot(SimdMath::bitOr(major_x, major_y), SimdMath::splatBits(x, 0xffffffffu));
+
+			// +X (-z, -y)  -X (z, -y)  +Y (x, z)  -Y (x, -z)  +Z (x, -y)  -Z (-x, -y)
+			const V major = SimdMath::select(major_x, x, SimdMath::select(major_y, y, z));
+			const V negative = SimdMath::cmpLt(major, zero);
+			const V sign = SimdMath::bitAnd(negative, SimdMath::splatBits(x, 0x80000000u));
+			const V ma = SimdMath::select(major_x, ax, SimdMath::select(major_y, ay, az));
+			V sc = SimdMath::select(major_x, SimdMath::bitXor(z, SimdMath::bitXor(sign, SimdMath::splatBits(x, 0x80000000u))),
+				SimdMath::bitXor(x, SimdMath::bitAnd(major_z, sign)));
+			V tc = SimdMath::select(major_y, SimdMath::bitXor(z, sign), SimdMath::bitXor(y, SimdMath::splatBits(x, 0x80000000u)));
+
+			const V axis = SimdMath::select(major_x, zero, SimdMath::select(major_y, SimdMath::splat(x, 2.f), SimdMath::splat(x, 4.f)));
+			*face = SimdMath::add(axis, SimdMath::bitAnd(negative, SimdMath::splat(x, 1.f)));
+			// zero and denormal lengths, where half / ma would overflow, land on the center of +X
+			const V scale = SimdMath::select(SimdMath::cmpGe(ma, SimdMath::splat(x, FLT_MIN)), SimdMath::div(half, ma), zero);
+			*u = SimdMath::madd(sc, scale, half);
+			*v = SimdMath::madd(tc, scale, half);
+		}
+		template<class V>
+		static AYA_FORCE_INLINE void fromCubeKernel(const V &face, const V &u, const V &v, V *x, V *y, V *z) {
+			const V one = SimdMath::splat(u, 1.f);
+			const V two = SimdMath::splat(u, 2.f);
+			const V sign_bit = SimdMath::splatBits(u, 0x80000000u);
+			const V sc = SimdMath::sub(SimdMath::mul(u, two), one);
+			const V tc = SimdMath::sub(SimdMath::mul(v, two), one);
+
+			// odd faces are the negative ones, face >> 1 is the major axis
+			const V odd = SimdMath::cmpNeq(SimdMath::bitsToInt(SimdMath::bitAnd(SimdMath::intToBits(face), SimdMath::splatBits(u, 1))),
+				SimdMath::splat(u, 0.f));
+			const V sign = SimdMath::bitAnd(odd, sign_bit);
+			const V major_x = SimdMath::cmpLt(face, two);
+			const V major_y = SimdMath::bitAndNot(major_x, SimdMath::cmpLt(face, SimdMath::splat(u, 4.f)));
+			const V major_z = SimdMath::bitAndNot(SimdMath::bitOr(major_x, major_y), SimdMath::splatBits(u, 0xffffffffu));
+			const V ma = SimdMath::bitXor(one, sign);
+			const V neg_tc = SimdMath::bitXor(tc, sign_bit);
+
+			// +X (1, -t, -s)  -X (-1, -t, s)  +Y (s, 1, t)  -Y (s, -1, -t)  +Z (s, -t, 1)  -Z (-s, -t, -1)
+			const V a = SimdMath::select(major_x, ma, SimdMath::bitXor(sc, SimdMath::bitAnd(major_z, sign)));
+			const V b = SimdMath::select(major_y, ma, neg_tc);
+			const V c = SimdMath::select(major_x, SimdMath::bitXor(sc, SimdMath::bitXor(sign, sign_bit)),
+				SimdMath::select(major_y, SimdMath::bitXor(tc, sign), ma));
+			normalize(a, b, c, x, y, z);
+		}
+
+		// Sign bit of each lane below zero, -0 counts as positive
+		template<class V>
+		static AYA_FORCE_INLINE V signNotZero(const V &a) {
+			return SimdMath::bitAnd(SimdMath::cmpLt(a, SimdMath::splat(a, 0.f)), SimdMath::splatBits(a, 0x80000000u));
+		}
+		template<class V>
+		static AYA_FORCE_INLINE void normalize(const V &a, const V &b, const V &c, V *x, V *y, V *z) {
+			const V len2 = SimdMath::madd(a, a, SimdMath::madd(b, b, SimdMath::mul(c, c)));
+			const V inv = SimdMath::div(SimdMath::splat(a, 1.f), SimdMath::sqrt(len2));
+			*x = SimdMath::mul(a, inv);
+			*y = SimdMath::mul(b, inv);
+			*z = SimdMath::mul(c, inv);
+		}
+
+		static AYA_FORCE_INLINE BaseVector3 toVector(const SimdMath::Scalar &x, const SimdMath::Scalar &y, const SimdMath::Scalar &z) {
+			return BaseVector3(SimdMath::fromScalar(x), SimdMath::fromScalar(y), SimdMath::fromScalar(z));
+		}
+		static AYA_FORCE_INLINE Vector2f toUV(const SimdMath::Scalar &u, const SimdMath::Scalar &v) {
+			return Vector2f(SimdMath::fromScalar(u), SimdMath::fromScalar(v));
+		}
+
+#if defined(AYA_USE_SIMD)
+		// 4 consecutive Vector2f to and from (u, v) packets
+		static AYA_FORCE_INLINE void loadUV(const Vector2f *p, __m128 *u, __m128 *v) {
+			const __m128 a = _mm_loadu_ps(&p[0].u);
+			const __m128 b = _mm_loadu_ps(&p[2].u);
+			*u = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+			*v = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+		}
+		static AYA_FORCE_INLINE void storeUV(Vector2f *p, const __m128 &u, const __m128 &v) {
+			_mm_storeu_ps(&p[0].u, _mm_unpacklo_ps(u, v));
+			_mm_storeu_ps(&p[2].u, _mm_unpackhi_ps(u, v));
+		}
+#endif
+#if defined(AYA_USE_AVX)
+		static AYA_FORCE_INLINE void loadUV(const Vector2f *p, __m256 *u, __m256 *v) {
+			const __m256 a = _mm256_loadu_ps(&p[0].u);
+			const __m256 b = _mm256_loadu_ps(&p[4].u);
+			// pairs 0 1 4 5 and 2 3 6 7, so the in-lane shuffle comes out in order
+			const __m256 lo = _mm256_permute2f128_ps(a, b, 0x20);
+			const __m256 hi = _mm256_permute2f128_ps(a, b, 0x31);
+			*u = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+			*v = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+		}
+		static AYA_FORCE_INLINE void storeUV(Vector2f *p, const __m256 &u, const __m256 &v) {
+			const __m256 lo = _mm256_unpacklo_ps(u, v);
+			const __m256 hi = _mm256_unpackhi_ps(u, v);
+			_mm256_storeu_ps(&p[0].u, _mm256_permute2f128_ps(lo, hi, 0x20));
+			_mm256_storeu_ps(&p[4].u, _mm256_permute2f128_ps(lo, hi, 0x31));
+		}
+#endif
+	};
+}
+
+#endif
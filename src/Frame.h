@@ -0,0 +1,143 @@
+#ifndef AYA_MATH_FRAME_H
+#define AYA_MATH_FRAME_H
+
+#include "Vector3.h"
+#include "Vector3x4.h"
+#include "Vector3x8.h"
+#include "SimdMath.h"
+#include "Parallel.h"
+
+namespace Aya {
+	// Right handed orthonormal basis, toLocal projects onto (m_x, m_y, m_z) and fromLocal maps
+	// back. The basis of a unit normal uses the branchless construction of Duff et al.,
+	// "Building an Orthonormal Basis, Revisited" (JCGT 2017): one divide, no sqrt, no branch,
+	// and the normal becomes m_z. The normal must be unit length.
+	//
+	// Single frames and batches run the same kernel, so a normal gets bit-identical axes either way.
+	class AYA_SIMD_ALIGN Frame {
+	public:
+		BaseVector3 m_x, m_y, m_z;
+
+		static const size_t s_parallel_grain = 1 << 15;
+
+	public:
+		AYA_FORCE_INLINE Frame() : m_x(1.f, 0.f, 0.f), m_y(0.f, 1.f, 0.f), m_z(0.f, 0.f, 1.f) {}
+		AYA_FORCE_INLINE Frame(const BaseVector3 &x, const BaseVector3 &y, const BaseVector3 &z) :
+			m_x(x), m_y(y), m_z(z) {}
+		explicit AYA_FORCE_INLINE Frame(const BaseVector3 &n) {
+			setFromZ(n);
+		}
+
+		AYA_FORCE_INLINE Frame &setFromZ(const BaseVector3 &n) {
+			SimdMath::Scalar x[3], y[3];
+			fromZKernel(SimdMath::toScalar(n.x()), SimdMath::toScalar(n.y()), SimdMath::toScalar(n.z()), x, y);
+			m_x = toVector(x);
+			m_y = toVector(y);
+			m_z = n;
+			return *this;
+		}
+		// x and z must be unit length and perpendicular
+		static AYA_FORCE_INLINE Frame fromXZ(const BaseVector3 &x, const BaseVector3 &z) {
+			return Frame(x, z.cross(x), z);
+		}
+		// x and y must be unit length and perpendicular
+		static AYA_FORCE_INLINE Frame fromXY(const BaseVector3 &x, const BaseVector3 &y) {
+			return Frame(x, y, x.cross(y));
+		}
+
+		template<class T>
+		AYA_FORCE_INLINE T toLocal(const T &v) const {
+			return T(v.dot3(m_x, m_y, m_z));
+		}
+		template<class T>
+		AYA_FORCE_INLINE T fromLocal(const T &v) const {
+			return T(m_x * v.x() + m_y * v.y() + m_z * v.z());
+		}
+
+		AYA_FORCE_INLINE bool operator == (const Frame &f) const {
+			return m_x == f.m_x && m_y == f.m_y && m_z == f.m_z;
+		}
+		AYA_FORCE_INLINE bool operator != (const Frame &f) const {
+			return !((*this) == f);
+		}
+
+		// Frames of n unit normals from Point3/Vector3/Normal3 arrays, 8 or 4 per packet, large
+		// arrays are split across threads
+		template<class T>
+		static void build(const T *normal, Frame *out, const size_t &n) {
+			ParallelFor(n, s_parallel_grain, [=](const size_t &begin, const size_t &end) {
+				size_t i = begin;
+#if defined(AYA_USE_AVX)
+				for (; i + 8 <= end; i += 8) {
+					const Vector3x8 z = Vector3x8::load(normal + i);
+					__m256 x[3], y[3];
+					fromZKernel(z.m_val256[0], z.m_val256[1], z.m_val256[2], x, y);
+					BaseVector3 bx[8], by[8];
+					Vector3x8(x[0], x[1], x[2]).store(bx);
+					Vector3x8(y[0], y[1], y[2]).store(by);
+					for (int k = 0; k < 8; k++)
+						out[i + k] = Frame(bx[k], by[k], normal[i + k]);
+				}
+#endif
+#if defined(AYA_USE_SIMD)
+				for (; i + 4 <= end; i += 4) {
+					const Vector3x4 z = Vector3x4::load(normal + i);
+					__m128 x[3], y[3];
+					fromZKernel(z.m_val128[0], z.m_val128[1], z.m_val128[2], x, y);
+					BaseVector3 bx[4], by[4];
+					Vector3x4(x[0], x[1], x[2]).store(bx);
+					Vector3x4(y[0], y[1], y[2]).store(by);
+					for (int k = 0; k < 4; k++)
+						out[i + k] = Frame(bx[k], by[k], normal[i + k]);
+				}
+#endif
+				for (; i < end; i++)
+					out[i] = Frame(normal[i]);
+			});
+		}
+		// Same, writing only the two tangent axes into separate arrays, m_z is the normal itself
+		template<class T>
+		static void build(const T *normal, T *x_axis, T *y_axis, const size_t &n) {
+			ParallelFor(n, s_parallel_grain, [=](const size_t &begin, const size_t &end) {
+				size_t i = begin;
+#if defined(AYA_USE_AVX)
+				for (; i + 8 <= end; i += 8) {
+					const Vector3x8 z = Vector3x8::load(normal + i);
+					__m256 x[3], y[3];
+					fromZKernel(z.m_val256[0], z.m_val256[1], z.m_val256[2], x, y);
+					Vector3x8(x[0], x[1], x[2]).store(x_axis + i);
+					Vector3x8(y[0], y[1], y[2]).store(y_axis + i);
+				}
+#endif
+#if defined(AYA_USE_SIMD)
+				for (; i + 4 <= end; i += 4) {
+					const Vector3x4 z = Vector3x4::load(normal + i);
+					__m128 x[3], y[3];
+					fromZKernel(z.m_val128[0], z.m_val128[1], z.m_val128[2], x, y);
+					Vector3x4(x[0], x[1], x[2]).store(x_axis + i);
+					Vector3x4(y[0], y[1], y[2]).store(y_axis + i);
+				}
+#endif
+				for (; i < end; i++) {
+					const Frame f(normal[i]);
+					x_axis[i] = T(f.m_x);
+					y_axis[i] = T(f.m_y);
+				}
+			});
+		}
+
+		// Tangent axes x and y of the unit normal (nx, ny, nz), one lane per normal. Shared with
+		// Framex4, the kernel itself lives in BaseVector3 so that coordinateSystem runs it too.
+		template<class V>
+		static AYA_FORCE_INLINE void fromZKernel(const V &nx, const V &ny, const V &nz, V *x, V *y) {
+			BaseVector3::coordinateSystemKernel(nx, ny, nz, x, y);
+		}
+
+	private:
+		static AYA_FORCE_INLINE BaseVector3 toVector(const SimdMath::Scalar *v) {
+			return BaseVector3(SimdMath::fromScalar(v[0]), SimdMath::fromScalar(v[1]), SimdMath::fromScalar(v[2]));
+		}
+	};
+}
+
+#endif
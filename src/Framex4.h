@@ -0,0 +1,72 @@
+#ifndef AYA_MATH_FRAMEX4_H
+#define AYA_MATH_FRAMEX4_H
+
+#include "Frame.h"
+
+namespace Aya {
+	// Four Frame in structure-of-arrays layout, lane i of m_x, m_y and m_z is the basis of
+	// frame i. Built from a packet of unit normals with the kernel of Frame, so lane i matches
+	// Frame(n_i) bit for bit.
+		class AYA_SIMD_ALIGN Framex4 {
+		public:
+			Vector3x4 m_x, m_y, m_z;
+
+		public:
+			Framex4() {}
+			AYA_FORCE_INLINE Framex4(const Vector3x4 &x, const Vector3x4 &y, const Vector3x4 &z) :
+				m_x(x), m_y(y), m_z(z) {}
+			AYA_FORCE_INLINE Framex4(const Frame &f0, const Frame &f1, const Frame &f2, const Frame &f3) :
+				m_x(f0.m_x, f1.m_x, f2.m_x, f3.m_x), m_y(f0.m_y, f1.m_y, f2.m_y, f3.m_y), m_z(f0.m_z, f1.m_z, f2.m_z, f3.m_z) {}
+			explicit AYA_FORCE_INLINE Framex4(const Vector3x4 &n) {
+				setFromZ(n);
+			}
+
+#if defined(AYA_USE_SIMD)
+			AYA_FORCE_INLINE void  *operator new(size_t i) {
+				return _mm_malloc(i, 16);
+			}
+
+			AYA_FORCE_INLINE void operator delete(void *p) {
+				_mm_free(p);
+			}
+#endif
+
+			AYA_FORCE_INLINE Framex4 &setFromZ(const Vector3x4 &n) {
+#if defined(AYA_USE_SIMD)
+				__m128 x[3], y[3];
+				Frame::fromZKernel(n.m_val128[0], n.m_val128[1], n.m_val128[2], x, y);
+				m_x = Vector3x4(x[0], x[1], x[2]);
+				m_y = Vector3x4(y[0], y[1], y[2]);
+#else
+				for (int i = 0; i < 4; i++) {
+					float x[3], y[3];
+					Frame::fromZKernel(n.m_val[0][i], n.m_val[1][i], n.m_val[2][i], x, y);
+					for (int a = 0; a < 3; a++) {
+						m_x.m_val[a][i] = x[a];
+						m_y.m_val[a][i] = y[a];
+					}
+				}
+#endif
+				m_z = n;
+				return *this;
+			}
+
+			// Gather 4 consecutive unit normals from p and build their frames
+			template<class T>
+			static AYA_FORCE_INLINE Framex4 load(const T *p) {
+				return Framex4(Vector3x4::load(p));
+			}
+			AYA_FORCE_INLINE Frame getFrame(const int &i) const {
+				return Frame(m_x.getVector(i), m_y.getVector(i), m_z.getVector(i));
+			}
+
+			AYA_FORCE_INLINE Vector3x4 toLocal(const Vector3x4 &v) const {
+				return Vector3x4(v.dot(m_x), v.dot(m_y), v.dot(m_z));
+			}
+			AYA_FORCE_INLINE Vector3x4 fromLocal(const Vector3x4 &v) const {
+				return m_x * v.x() + m_y * v.y() + m_z * v.z();
+			}
+		};
+}
+
+#endif
@@ -1,11 +1,12 @@
 #ifndef AYA_MATH_MATHUTILITY_H
 #define AYA_MATH_MATHUTILITY_H
 
-#include "..\Core\Config.h"
+#include "../Core/Config.h"
 
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <float.h>
+#include <stdint.h>
 
 #if defined(AYA_DEBUG)
 #include <assert.h>
@@ -13,8 +14,55 @@
 #define assert
 #endif
 
-#ifdef _WIN32
+#if defined(_MSC_VER)
 #include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
+#if !defined(AYA_FORCE_INLINE)
+#if defined(_MSC_VER)
+#define AYA_FORCE_INLINE __forceinline
+#else
+#define AYA_FORCE_INLINE inline __attribute__((always_inline))
+#endif
+#endif
+
+// Class alignment, written between the class key and the name: class AYA_ALIGN(32) X
+#define AYA_ALIGN(n) alignas(n)
+#if defined(AYA_USE_SIMD)
+#define AYA_SIMD_ALIGN AYA_ALIGN(16)
+#else
+#define AYA_SIMD_ALIGN
+#endif
+
+#if defined(AYA_USE_SIMD) && defined(__AVX__)
+#define AYA_USE_AVX
+#endif
+// GCC and Clang set __FMA__ only with -mfma (or a -march that has it), -mavx2 alone does not;
+// MSVC has no __FMA__ and /arch:AVX2 implies FMA
+#if defined(AYA_USE_SIMD) && (defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define AYA_USE_FMA
+#endif
+
+// constexpr-capable scalar paths (C++20): the SIMD branches are skipped while constant
+// evaluating, so vectors, matrices and transforms can be built at compile time.
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+#if defined(__cpp_lib_is_constant_evaluated) && defined(__cpp_lib_atomic_ref) && !defined(AYA_NO_CONSTEXPR)
+#define AYA_USE_CONSTEXPR
+#endif
+
+#if defined(AYA_USE_CONSTEXPR)
+#include <type_traits>
+#define AYA_CONSTEXPR constexpr
+#define AYA_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#else
+#define AYA_CONSTEXPR
+#define AYA_CONSTANT_EVALUATED() false
 #endif
 
 #define AYA_EPSILON FLT_EPSILON
@@ -32,40 +80,40 @@
 
 namespace Aya {
 	template<class T>
-	AYA_FORCE_INLINE T Abs(const T &a) {
+	AYA_FORCE_INLINE AYA_CONSTEXPR T Abs(const T &a) {
 		return a < 0 ? -a : a;
 	}
 	template<class T>
-	AYA_FORCE_INLINE T Min(const T &a, const T &b) {
+	AYA_FORCE_INLINE AYA_CONSTEXPR T Min(const T &a, const T &b) {
 		return a < b ? a : b;
 	}
 	template<class T>
-	AYA_FORCE_INLINE T Max(const T &a, const T &b) {
+	AYA_FORCE_INLINE AYA_CONSTEXPR T Max(const T &a, const T &b) {
 		return a > b ? a : b;
 	}
 	template<class T>
-	AYA_FORCE_INLINE void SetMax(T &a, const T &b) {
+	AYA_FORCE_INLINE AYA_CONSTEXPR void SetMax(T &a, const T &b) {
 		if (b > a) a = b;
 	}
 	template<class T>
-	AYA_FORCE_INLINE void SetMin(T &a, const T &b) {
+	AYA_FORCE_INLINE AYA_CONSTEXPR void SetMin(T &a, const T &b) {
 		if (b < a) a = b;
 	}
 
-	AYA_FORCE_INLINE float Radian(const float &deg) {
+	AYA_FORCE_INLINE AYA_CONSTEXPR float Radian(const float &deg) {
 		return (float)(M_PI / 180.f) * deg;
 	}
-	AYA_FORCE_INLINE float Degree(const float &rad) {
+	AYA_FORCE_INLINE AYA_CONSTEXPR float Degree(const float &rad) {
 		return (float)(180.f / M_PI) * rad;
 	}
 
 	template<class T>
-	AYA_FORCE_INLINE T Lerp(const float &t, const T &a, const T &b) {
+	AYA_FORCE_INLINE AYA_CONSTEXPR T Lerp(const float &t, const T &a, const T &b) {
 		return a + t * (b - a);
 	}
 
 	template<class T, class T1, class T2>
-	AYA_FORCE_INLINE T Clamp(const T &t, const T1  &low, const T2 &high) {
+	AYA_FORCE_INLINE AYA_CONSTEXPR T Clamp(const T &t, const T1  &low, const T2 &high) {
 		if (t < T(low)) return low;
 		if (t > T(high)) return high;
 		return t;
@@ -109,6 +157,32 @@ namespace Aya {
 #endif
 	}
 
+	// Taylor series of sin after reduction to [-pi/2, pi/2], only used for constant evaluation
+	AYA_FORCE_INLINE AYA_CONSTEXPR double SinSeries(double x) {
+		x -= 2.0 * M_PI * (double)(int64_t)(x / (2.0 * M_PI));
+		if (x > M_PI) x -= 2.0 * M_PI;
+		if (x < -M_PI) x += 2.0 * M_PI;
+		if (x > M_PI_2) x = M_PI - x;
+		if (x < -M_PI_2) x = -M_PI - x;
+		const double x2 = x * x;
+		double term = x, sum = x;
+		for (int i = 1; i < 12; i++) {
+			term *= -x2 / ((2 * i) * (2 * i + 1));
+			sum += term;
+		}
+		return sum;
+	}
+	AYA_FORCE_INLINE AYA_CONSTEXPR float Sin(const float &x) {
+		if (!AYA_CONSTANT_EVALUATED())
+			return sinf(x);
+		return (float)SinSeries(x);
+	}
+	AYA_FORCE_INLINE AYA_CONSTEXPR float Cos(const float &x) {
+		if (!AYA_CONSTANT_EVALUATED())
+			return cosf(x);
+		return (float)SinSeries(M_PI_2 - (double)x);
+	}
+
 	AYA_FORCE_INLINE uint32_t RoundUpToPowerOfTwo(uint32_t val) {
 		--val;
 		val |= val >> 1;
@@ -119,22 +193,34 @@ namespace Aya {
 		return val + 1;
 	}
 	AYA_FORCE_INLINE uint32_t CountLeadingZeros(uint32_t value) {
+#if defined(_MSC_VER)
 		unsigned long log2;
 		if (_BitScanReverse(&log2, value)) return 31 - log2;
 		return 32;
+#else
+		return value ? __builtin_clz(value) : 32;
+#endif
 	}
 	AYA_FORCE_INLINE uint32_t CountTrailingZeros(uint32_t value) {
 		if (value == 0) {
 			return 32;
 		}
-		uint32_t bitidx; // 0-based, where the LSB is 0 and MSB is 31
-		_BitScanForward((unsigned long *)&bitidx, value);
+#if defined(_MSC_VER)
+		unsigned long bitidx; // 0-based, where the LSB is 0 and MSB is 31
+		_BitScanForward(&bitidx, value);
 		return bitidx;
+#else
+		return __builtin_ctz(value);
+#endif
 	}
 	AYA_FORCE_INLINE uint32_t FloorLog2(uint32_t value) {
+#if defined(_MSC_VER)
 		unsigned long log2;
 		if (_BitScanReverse(&log2, value)) return log2;
 		return 0;
+#else
+		return value ? 31 - __builtin_clz(value) : 0;
+#endif
 	}
 	AYA_FORCE_INLINE uint32_t CeilLog2(uint32_t value) {
 		int bitmask = ((int)(CountLeadingZeros(value) << 26)) >> 31;
@@ -142,17 +228,17 @@ namespace Aya {
 	}
 
 	AYA_FORCE_INLINE int TruncToInt(float val) {
-		return _mm_cvtt_ss2si(_mm_set_ss(val));
+		return _mm_cvttss_si32(_mm_set_ss(val));
 	}
 
 	AYA_FORCE_INLINE int FloorToInt(const float val) {
-		return _mm_cvt_ss2si(_mm_set_ss(val + val - .5f)) >> 1;
+		return _mm_cvtss_si32(_mm_set_ss(val + val - .5f)) >> 1;
 	}
 	AYA_FORCE_INLINE int CeilToInt(const float val) {
-		return -(_mm_cvt_ss2si(_mm_set_ss(-0.5f - (val + val))) >> 1);
+		return -(_mm_cvtss_si32(_mm_set_ss(-0.5f - (val + val))) >> 1);
 	}
 	AYA_FORCE_INLINE int RoundToInt(const float val) {
-		return _mm_cvt_ss2si(_mm_set_ss(val + val + .5f)) >> 1;
+		return _mm_cvtss_si32(_mm_set_ss(val + val + .5f)) >> 1;
 	}
 }
 
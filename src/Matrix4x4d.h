@@ -0,0 +1,293 @@
+#ifndef AYA_MATH_MATRIX4X4D_H
+#define AYA_MATH_MATRIX4X4D_H
+
+#include "Vector3d.h"
+#include "Matrix4x4.h"
+
+namespace Aya {
+		class AYA_ALIGN(32) Matrix4x4d {
+		public:
+			QuadWordd m_el[4];
+
+			Matrix4x4d() {}
+			Matrix4x4d(const double &xx, const double &xy, const double &xz, const double &xw,
+				const double &yx, const double &yy, const double &yz, const double &yw,
+				const double &zx, const double &zy, const double &zz, const double &zw,
+				const double &wx, const double &wy, const double &wz, const double &ww) {
+				setValue(xx, xy, xz, xw,
+					yx, yy, yz, yw,
+					zx, zy, zz, zw,
+					wx, wy, wz, ww);
+			}
+			AYA_FORCE_INLINE Matrix4x4d(const QuadWordd &v0, const QuadWordd &v1, const QuadWordd &v2, const QuadWordd &v3) {
+				m_el[0] = v0;
+				m_el[1] = v1;
+				m_el[2] = v2;
+				m_el[3] = v3;
+			}
+			AYA_FORCE_INLINE explicit Matrix4x4d(const Matrix4x4 &m) {
+				m_el[0] = QuadWordd(m[0]);
+				m_el[1] = QuadWordd(m[1]);
+				m_el[2] = QuadWordd(m[2]);
+				m_el[3] = QuadWordd(m[3]);
+			}
+
+#if defined(AYA_USE_AVX)
+			AYA_FORCE_INLINE Matrix4x4d(const __m256d &v0, const __m256d &v1, const __m256d &v2, const __m256d &v3) {
+				m_el[0].m_val256 = v0;
+				m_el[1].m_val256 = v1;
+				m_el[2].m_val256 = v2;
+				m_el[3].m_val256 = v3;
+			}
+
+			AYA_FORCE_INLINE void  *operator new(size_t i) {
+				return _mm_malloc(i, 32);
+			}
+
+			AYA_FORCE_INLINE void operator delete(void *p) {
+				_mm_free(p);
+			}
+#endif
+
+			// Rounds to float
+			AYA_FORCE_INLINE Matrix4x4 toFloat() const {
+				return Matrix4x4(m_el[0].toFloat(), m_el[1].toFloat(), m_el[2].toFloat(), m_el[3].toFloat());
+			}
+
+			AYA_FORCE_INLINE QuadWordd getColumn(int x) const {
+				assert(x >= 0 && x < 4);
+				return QuadWordd(m_el[0][x], m_el[1][x], m_el[2][x], m_el[3][x]);
+			}
+			AYA_FORCE_INLINE QuadWordd getRow(int x) const {
+				assert(x >= 0 && x < 4);
+				return m_el[x];
+			}
+			AYA_FORCE_INLINE QuadWordd& operator [](int x) {
+				assert(x >= 0 && x < 4);
+				return m_el[x];
+			}
+			AYA_FORCE_INLINE const QuadWordd& operator [](int x) const {
+				assert(x >= 0 && x < 4);
+				return m_el[x];
+			}
+
+			void setValue(const double &xx, const double &xy, const double &xz, const double &xw,
+				const double &yx, const double &yy, const double &yz, const double &yw,
+				const double &zx, const double &zy, const double &zz, const double &zw,
+				const double &wx, const double &wy, const double &wz, const double &ww) {
+#if defined(AYA_USE_AVX)
+				m_el[0].m_val256 = _mm256_set_pd(xw, xz, xy, xx);
+				m_el[1].m_val256 = _mm256_set_pd(yw, yz, yy, yx);
+				m_el[2].m_val256 = _mm256_set_pd(zw, zz, zy, zx);
+				m_el[3].m_val256 = _mm256_set_pd(ww, wz, wy, wx);
+#else
+				m_el[0] = QuadWordd(xx, xy, xz, xw);
+				m_el[1] = QuadWordd(yx, yy, yz, yw);
+				m_el[2] = QuadWordd(zx, zy, zz, zw);
+				m_el[3] = QuadWordd(wx, wy, wz, ww);
+#endif
+			}
+
+			void setIdentity() {
+#if defined(AYA_USE_AVX)
+				m_el[0] = vd1000;
+				m_el[1] = vd0100;
+				m_el[2] = vd0010;
+				m_el[3] = vd0001;
+#else
+				setValue(1, 0, 0, 0,
+					0, 1, 0, 0,
+					0, 0, 1, 0,
+					0, 0, 0, 1);
+#endif
+			}
+
+			Matrix4x4d getIdentity() {
+				Matrix4x4d ret;
+				ret.setIdentity();
+				return ret;
+			}
+
+			AYA_FORCE_INLINE Matrix4x4d operator + (const Matrix4x4d &m1) const {
+#if defined(AYA_USE_AVX)
+				return Matrix4x4d(_mm256_add_pd(m_el[0].m_val256, m1.m_el[0].m_val256),
+					_mm256_add_pd(m_el[1].m_val256, m1.m_el[1].m_val256),
+					_mm256_add_pd(m_el[2].m_val256, m1.m_el[2].m_val256),
+					_mm256_add_pd(m_el[3].m_val256, m1.m_el[3].m_val256));
+#else
+				Matrix4x4d ret;
+				for (int i = 0; i < 4; i++)
+					for (int j = 0; j < 4; j++)
+						ret.m_el[i][j] = m_el[i][j] + m1.m_el[i][j];
+				return ret;
+#endif
+			}
+			AYA_FORCE_INLINE Matrix4x4d operator - (const Matrix4x4d &m1) const {
+#if defined(AYA_USE_AVX)
+				return Matrix4x4d(_mm256_sub_pd(m_el[0].m_val256, m1.m_el[0].m_val256),
+					_mm256_sub_pd(m_el[1].m_val256, m1.m_el[1].m_val256),
+					_mm256_sub_pd(m_el[2].m_val256, m1.m_el[2].m_val256),
+					_mm256_sub_pd(m_el[3].m_val256, m1.m_el[3].m_val256));
+#else
+				Matrix4x4d ret;
+				for (int i = 0; i < 4; i++)
+					for (int j = 0; j < 4; j++)
+						ret.m_el[i][j] = m_el[i][j] - m1.m_el[i][j];
+				return ret;
+#endif
+			}
+			AYA_FORCE_INLINE Matrix4x4d operator * (const double &s) const {
+#if defined(AYA_USE_AVX)
+				const __m256d vs = _mm256_set1_pd(s);
+				return Matrix4x4d(_mm256_mul_pd(m_el[0].m_val256, vs),
+					_mm256_mul_pd(m_el[1].m_val256, vs),
+					_mm256_mul_pd(m_el[2].m_val256, vs),
+					_mm256_mul_pd(m_el[3].m_val256, vs));
+#else
+				Matrix4x4d ret;
+				for (int i = 0; i < 4; i++)
+					for (int j = 0; j < 4; j++)
+						ret.m_el[i][j] = m_el[i][j] * s;
+				return ret;
+#endif
+			}
+			AYA_FORCE_INLINE friend Matrix4x4d operator * (const double &s, const Matrix4x4d &m) {
+				return m * s;
+			}
+
+			AYA_FORCE_INLINE Matrix4x4d operator * (const Matrix4x4d &m) const {
+#if defined(AYA_USE_AVX)
+				// row i is (a0 * m[0] + a1 * m[1]) + (a2 * m[2] + a3 * m[3]) with a broadcast from memory
+				__m256d c0 = _mm256_mul_pd(_mm256_broadcast_sd(&m_el[0].m_val[0]), m[0].m_val256);
+				__m256d c1 = _mm256_mul_pd(_mm256_broadcast_sd(&m_el[1].m_val[0]), m[0].m_val256);
+				__m256d c2 = _mm256_mul_pd(_mm256_broadcast_sd(&m_el[2].m_val[0]), m[0].m_val256);
+				__m256d c3 = _mm256_mul_pd(_mm256_broadcast_sd(&m_el[3].m_val[0]), m[0].m_val256);
+
+				__m256d c0_2 = _mm256_mul_pd(_mm256_broadcast_sd(&m_el[0].m_val[2]), m[2].m_val256);
+				__m256d c1_2 = _mm256_mul_pd(_mm256_broadcast_sd(&m_el[1].m_val[2]), m[2].m_val256);
+				__m256d c2_2 = _mm256_mul_pd(_mm256_broadcast_sd(&m_el[2].m_val[2]), m[2].m_val256);
+				__m256d c3_2 = _mm256_mul_pd(_mm256_broadcast_sd(&m_el[3].m_val[2]), m[2].m_val256);
+
+				c0 = _mm256_madd_pd(_mm256_broadcast_sd(&m_el[0].m_val[1]), m[1].m_val256, c0);
+				c1 = _mm256_madd_pd(_mm256_broadcast_sd(&m_el[1].m_val[1]), m[1].m_val256, c1);
+				c2 = _mm256_madd_pd(_mm256_broadcast_sd(&m_el[2].m_val[1]), m[1].m_val256, c2);
+				c3 = _mm256_madd_pd(_mm256_broadcast_sd(&m_el[3].m_val[1]), m[1].m_val256, c3);
+
+				c0_2 = _mm256_madd_pd(_mm256_broadcast_sd(&m_el[0].m_val[3]), m[3].m_val256, c0_2);
+				c1_2 = _mm256_madd_pd(_mm256_broadcast_sd(&m_el[1].m_val[3]), m[3].m_val256, c1_2);
+				c2_2 = _mm256_madd_pd(_mm256_broadcast_sd(&m_el[2].m_val[3]), m[3].m_val256, c2_2);
+				c3_2 = _mm256_madd_pd(_mm256_broadcast_sd(&m_el[3].m_val[3]), m[3].m_val256, c3_2);
+
+				return Matrix4x4d(_mm256_add_pd(c0, c0_2), _mm256_add_pd(c1, c1_2),
+					_mm256_add_pd(c2, c2_2), _mm256_add_pd(c3, c3_2));
+#else
+				Matrix4x4d ret;
+				for (int i = 0; i < 4; i++)
+					for (int j = 0; j < 4; j++)
+						ret.m_el[i][j] = m_el[i][0] * m.m_el[0][j] + m_el[i][1] * m.m_el[1][j] +
+							m_el[i][2] * m.m_el[2][j] + m_el[i][3] * m.m_el[3][j];
+				return ret;
+#endif
+			}
+			AYA_FORCE_INLINE Matrix4x4d& operator *= (const Matrix4x4d &m) {
+				return *this = (*this) * m;
+			}
+
+			AYA_FORCE_INLINE QuadWordd operator * (const QuadWordd &v) const {
+#if defined(AYA_USE_AVX)
+				__m256d t0 = _mm256_mul_pd(m_el[0].m_val256, v.m_val256);
+				__m256d t1 = _mm256_mul_pd(m_el[1].m_val256, v.m_val256);
+				__m256d t2 = _mm256_mul_pd(m_el[2].m_val256, v.m_val256);
+				__m256d t3 = _mm256_mul_pd(m_el[3].m_val256, v.m_val256);
+				__m256d h01 = _mm256_hadd_pd(t0, t1);	// t0.01 t1.01 t0.23 t1.23
+				__m256d h23 = _mm256_hadd_pd(t2, t3);	// t2.01 t3.01 t2.23 t3.23
+				return QuadWordd(_mm256_add_pd(_mm256_permute2f128_pd(h01, h23, 0x21),
+					_mm256_blend_pd(h01, h23, 0xc)));
+#else
+				return QuadWordd(
+					m_el[0][0] * v[0] + m_el[0][1] * v[1] + m_el[0][2] * v[2] + m_el[0][3] * v[3],
+					m_el[1][0] * v[0] + m_el[1][1] * v[1] + m_el[1][2] * v[2] + m_el[1][3] * v[3],
+					m_el[2][0] * v[0] + m_el[2][1] * v[1] + m_el[2][2] * v[2] + m_el[2][3] * v[3],
+					m_el[3][0] * v[0] + m_el[3][1] * v[1] + m_el[3][2] * v[2] + m_el[3][3] * v[3]);
+#endif
+			}
+
+			AYA_FORCE_INLINE Matrix4x4d transpose() const {
+#if defined(AYA_USE_AVX)
+				__m256d t0 = _mm256_unpacklo_pd(m_el[0].m_val256, m_el[1].m_val256);	// 00 10 02 12
+				__m256d t1 = _mm256_unpackhi_pd(m_el[0].m_val256, m_el[1].m_val256);	// 01 11 03 13
+				__m256d t2 = _mm256_unpacklo_pd(m_el[2].m_val256, m_el[3].m_val256);	// 20 30 22 32
+				__m256d t3 = _mm256_unpackhi_pd(m_el[2].m_val256, m_el[3].m_val256);	// 21 31 23 33
+				return Matrix4x4d(_mm256_permute2f128_pd(t0, t2, 0x20),
+					_mm256_permute2f128_pd(t1, t3, 0x20),
+					_mm256_permute2f128_pd(t0, t2, 0x31),
+					_mm256_permute2f128_pd(t1, t3, 0x31));
+#else
+				return Matrix4x4d(m_el[0][0], m_el[1][0], m_el[2][0], m_el[3][0],
+					m_el[0][1], m_el[1][1], m_el[2][1], m_el[3][1],
+					m_el[0][2], m_el[1][2], m_el[2][2], m_el[3][2],
+					m_el[0][3], m_el[1][3], m_el[2][3], m_el[3][3]);
+#endif
+			}
+
+			// Cofactor expansion in double, accurate enough that large translations don't need
+			// the float block method
+			AYA_FORCE_INLINE Matrix4x4d inverse() const {
+				double cofac00 = cofac(1, 2, 3, 1, 2, 3);
+				double cofac01 = -cofac(1, 2, 3, 0, 2, 3);
+				double cofac02 = cofac(1, 2, 3, 0, 1, 3);
+				double cofac03 = -cofac(1, 2, 3, 0, 1, 2);
+				double det = m_el[0][0] * cofac00 + m_el[0][1] * cofac01 + m_el[0][2] * cofac02 + m_el[0][3] * cofac03;
+				assert(det != 0.);
+				double det_inv = 1. / det;
+				return Matrix4x4d(
+					cofac00,
+					-cofac(0, 2, 3, 1, 2, 3),
+					cofac(0, 1, 3, 1, 2, 3),
+					-cofac(0, 1, 2, 1, 2, 3),
+
+					cofac01,
+					cofac(0, 2, 3, 0, 2, 3),
+					-cofac(0, 1, 3, 0, 2, 3),
+					cofac(0, 1, 2, 0, 2, 3),
+
+					cofac02,
+					-cofac(0, 2, 3, 0, 1, 3),
+					cofac(0, 1, 3, 0, 1, 3),
+					-cofac(0, 1, 2, 0, 1, 3),
+
+					cofac03,
+					cofac(0, 2, 3, 0, 1, 2),
+					-cofac(0, 1, 3, 0, 1, 2),
+					cofac(0, 1, 2, 0, 1, 2)
+				) * det_inv;
+			}
+
+			AYA_FORCE_INLINE bool operator == (const Matrix4x4d &m) const {
+				return m_el[0][0] == m[0][0] && m_el[0][1] == m[0][1] && m_el[0][2] == m[0][2] && m_el[0][3] == m[0][3] &&
+					m_el[1][0] == m[1][0] && m_el[1][1] == m[1][1] && m_el[1][2] == m[1][2] && m_el[1][3] == m[1][3] &&
+					m_el[2][0] == m[2][0] && m_el[2][1] == m[2][1] && m_el[2][2] == m[2][2] && m_el[2][3] == m[2][3] &&
+					m_el[3][0] == m[3][0] && m_el[3][1] == m[3][1] && m_el[3][2] == m[3][2] && m_el[3][3] == m[3][3];
+			}
+			AYA_FORCE_INLINE bool operator != (const Matrix4x4d &m) const {
+				return !((*this) == m);
+			}
+
+			AYA_FORCE_INLINE double cofac(const int &r1, const int &r2, const int &r3,
+				const int &c1, const int &c2, const int &c3) const {
+				return  m_el[r1].m_val[c1] * (m_el[r2].m_val[c2] * m_el[r3].m_val[c3] - m_el[r3].m_val[c2] * m_el[r2].m_val[c3]) -
+					m_el[r1].m_val[c2] * (m_el[r2].m_val[c1] * m_el[r3].m_val[c3] - m_el[r3].m_val[c1] * m_el[r2].m_val[c3]) +
+					m_el[r1].m_val[c3] * (m_el[r2].m_val[c1] * m_el[r3].m_val[c2] - m_el[r2].m_val[c2] * m_el[r3].m_val[c1]);
+			}
+
+			friend inline std::ostream &operator<<(std::ostream &os, const Matrix4x4d &m) {
+				os << "[" << m.m_el[0] << ",\n";
+				os << " " << m.m_el[1] << ",\n";
+				os << " " << m.m_el[2] << ",\n";
+				os << " " << m.m_el[3] << "]";
+				return os;
+			}
+	};
+}
+
+#endif
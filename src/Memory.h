@@ -0,0 +1,175 @@
+#ifndef AYA_MATH_MEMORY_H
+#define AYA_MATH_MEMORY_H
+
+#include "MathUtility.h"
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Aya {
+	// Standard allocator handing out _mm_malloc memory, so containers of the SIMD types keep
+	// the alignment their operator new would give them, e.g. AlignedVector<Transform>.
+	template<class T, size_t Align = 32>
+	class AlignedAllocator {
+	public:
+		typedef T value_type;
+		template<class U>
+		struct rebind {
+			typedef AlignedAllocator<U, Align> other;
+		};
+
+		static const size_t s_alignment = Align > alignof(T) ? Align : alignof(T);
+
+	public:
+		AlignedAllocator() noexcept {}
+		template<class U>
+		AlignedAllocator(const AlignedAllocator<U, Align> &) noexcept {}
+
+		T *allocate(const size_t &n) {
+			void *p = _mm_malloc(n * sizeof(T), s_alignment);
+			if (!p)
+				throw std::bad_alloc();
+			return (T *)p;
+		}
+		void deallocate(T *p, const size_t &) noexcept {
+			_mm_free(p);
+		}
+
+		template<class U>
+		bool operator == (const AlignedAllocator<U, Align> &) const noexcept {
+			return true;
+		}
+		template<class U>
+		bool operator != (const AlignedAllocator<U, Align> &) const noexcept {
+			return false;
+		}
+	};
+
+	template<class T>
+	using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+	// Bump allocator over a list of cache line aligned blocks. Nothing is freed one by one,
+	// reset() recycles every block at once and keeps them for the next round, and destructors
+	// are never run, so only trivially destructible types can be created in it.
+	//
+	// threadLocal() gives each thread its own arena without locking. Calling nextFrame() marks
+	// everything allocated from the thread-local arenas so far as dead, each arena resets itself
+	// the next time its thread asks for it.
+	class MemoryArena {
+	public:
+		static const size_t s_block_size = 256 * 1024;
+		static const size_t s_block_alignment = 64;
+
+	public:
+		explicit MemoryArena(size_t block_size = s_block_size) :
+			m_block_size(block_size), m_current(nullptr), m_current_size(0), m_offset(0), m_frame(0) {}
+		MemoryArena(const MemoryArena &) = delete;
+		MemoryArena& operator = (const MemoryArena &) = delete;
+		~MemoryArena() {
+			if (m_current)
+				_mm_free(m_current);
+			for (auto &b : m_used)
+				_mm_free(b.first);
+			for (auto &b : m_available)
+				_mm_free(b.first);
+		}
+
+		AYA_FORCE_INLINE void *alloc(const size_t &bytes, const size_t &align = 16) {
+			assert(align > 0 && (align & (align - 1)) == 0 && align <= s_block_alignment);
+			size_t offset = (m_offset + align - 1) & ~(align - 1);
+			if (offset + bytes > m_current_size) {
+				nextBlock(bytes);
+				offset = 0;
+			}
+			m_offset = offset + bytes;
+			return m_current + offset;
+		}
+
+		// Constructs one T, aligned to at least 16 bytes
+		template<class T, class... Args>
+		AYA_FORCE_INLINE T *create(Args&&... args) {
+			static_assert(std::is_trivially_destructible<T>::value, "MemoryArena never runs destructors");
+			return ::new (alloc(sizeof(T), Max(alignof(T), size_t(16)))) T(std::forward<Args>(args)...);
+		}
+		// Default constructs an array of n T
+		template<class T>
+		AYA_FORCE_INLINE T *createArray(const size_t &n) {
+			static_assert(std::is_trivially_destructible<T>::value, "MemoryArena never runs destructors");
+			T *ret = (T *)alloc(n * sizeof(T), Max(alignof(T), size_t(16)));
+			for (size_t i = 0; i < n; i++)
+				::new (&ret[i]) T();
+			return ret;
+		}
+
+		// Drops everything allocated so far, the blocks are kept for reuse
+		void reset() {
+			m_offset = 0;
+			for (auto &b : m_used)
+				m_available.push_back(b);
+			m_used.clear();
+		}
+		size_t totalAllocated() const {
+			size_t total = m_current_size;
+			for (auto &b : m_used)
+				total += b.second;
+			for (auto &b : m_available)
+				total += b.second;
+			return total;
+		}
+
+		static MemoryArena &threadLocal() {
+			thread_local MemoryArena arena;
+			const uint64_t frame = frameCounter().load(std::memory_order_acquire);
+			if (arena.m_frame != frame) {
+				arena.reset();
+				arena.m_frame = frame;
+			}
+			return arena;
+		}
+		static void nextFrame() {
+			frameCounter().fetch_add(1, std::memory_order_release);
+		}
+
+	private:
+		// The current block is retired, the new one is the smallest recycled block that fits,
+		// requests larger than m_block_size get a block of their own
+		void nextBlock(const size_t &bytes) {
+			if (m_current)
+				m_used.push_back(std::make_pair(m_current, m_current_size));
+			m_current = nullptr;
+			size_t best = m_available.size();
+			for (size_t i = 0; i < m_available.size(); i++) {
+				if (m_available[i].second >= bytes &&
+					(best == m_available.size() || m_available[i].second < m_available[best].second))
+					best = i;
+			}
+			if (best < m_available.size()) {
+				m_current = m_available[best].first;
+				m_current_size = m_available[best].second;
+				m_available.erase(m_available.begin() + best);
+			}
+			else {
+				m_current_size = Max(bytes, m_block_size);
+				m_current = (uint8_t *)_mm_malloc(m_current_size, s_block_alignment);
+				if (!m_current)
+					throw std::bad_alloc();
+			}
+		}
+
+		static std::atomic<uint64_t> &frameCounter() {
+			static std::atomic<uint64_t> frame(0);
+			return frame;
+		}
+
+		const size_t m_block_size;
+		uint8_t *m_current;
+		size_t m_current_size, m_offset;
+		uint64_t m_frame;
+		std::vector<std::pair<uint8_t *, size_t>> m_used, m_available;
+	};
+}
+
+#endif
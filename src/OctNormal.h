@@ -0,0 +1,195 @@
+#ifndef AYA_MATH_OCTNORMAL_H
+#define AYA_MATH_OCTNORMAL_H
+
+#include "Vector3.h"
+#include "Vector3x4.h"
+#include "SimdMath.h"
+#include "Parallel.h"
+
+namespace Aya {
+	// Unit normal in octahedral encoding: the direction is projected onto the octahedron
+	// |x| + |y| + |z| = 1, the lower half is folded over the diagonals and (x, y) is stored
+	// as two snorm integers. With round to nearest the worst case angular error is about
+	// 0.0037 degrees for OctNormal16 (4 bytes) and 0.95 degrees for OctNormal8 (2 bytes).
+	// Zero vectors are not representable, they decode to (0, 0, 1).
+	template<class T>
+	class OctNormal {
+	public:
+		T x, y;
+
+		static const int s_max = (1 << (sizeof(T) * 8 - 1)) - 1;
+		static const size_t s_parallel_grain = 1 << 16;
+
+	public:
+		OctNormal() {}
+		AYA_FORCE_INLINE OctNormal(const T &x1, const T &y1) : x(x1), y(y1) {}
+		explicit AYA_FORCE_INLINE OctNormal(const BaseVector3 &n) {
+			float sum = Abs(n.x()) + Abs(n.y()) + Abs(n.z());
+			float inv = sum > 0.f ? 1.f / sum : 0.f;
+			float u = n.x() * inv, v = n.y() * inv;
+			if (n.z() < 0.f) {
+				float fu = (1.f - Abs(v)) * signNotZero(u);
+				float fv = (1.f - Abs(u)) * signNotZero(v);
+				u = fu;
+				v = fv;
+			}
+			x = T(nearbyintf(Clamp(u, -1.f, 1.f) * s_max));
+			y = T(nearbyintf(Clamp(v, -1.f, 1.f) * s_max));
+		}
+
+		AYA_FORCE_INLINE bool operator == (const OctNormal &n) const {
+			return x == n.x && y == n.y;
+		}
+		AYA_FORCE_INLINE bool operator != (const OctNormal &n) const {
+			return !((*this) == n);
+		}
+
+		AYA_FORCE_INLINE Normal3 toNormal() const {
+			float u = Max(float(x) * (1.f / s_max), -1.f);
+			float v = Max(float(y) * (1.f / s_max), -1.f);
+			float z = 1.f - Abs(u) - Abs(v);
+			float t = Max(-z, 0.f);
+			u -= t * signNotZero(u);
+			v -= t * signNotZero(v);
+			SimdMath::Scalar nu = SimdMath::toScalar(u), nv = SimdMath::toScalar(v), nz = SimdMath::toScalar(z);
+			normalizeKernel(nu, nv, nz);
+			return Normal3(SimdMath::fromScalar(nu), SimdMath::fromScalar(nv), SimdMath::fromScalar(nz));
+		}
+
+		// Batched conversions between Normal3 arrays and packed arrays, 4 normals per SSE
+		// packet, large arrays are split across threads.
+		static void encode(const Normal3 *in, OctNormal *out, const size_t &n) {
+			ParallelFor(n, s_parallel_grain, [in, out](const size_t &begin, const size_t &end) {
+				encodeRange(in + begin, out + begin, end - begin);
+			});
+		}
+		static void decode(const OctNormal *in, Normal3 *out, const size_t &n) {
+			ParallelFor(n, s_parallel_grain, [in, out](const size_t &begin, const size_t &end) {
+				decodeRange(in + begin, out + begin, end - begin);
+			});
+		}
+
+		static void encodeRange(const Normal3 *in, OctNormal *out, const size_t &n) {
+			size_t i = 0;
+#if defined(AYA_USE_SIMD)
+			for (; i + 4 <= n; i += 4)
+				encodePacket(in + i, out + i);
+#endif
+			for (; i < n; i++)
+				out[i] = OctNormal(in[i]);
+		}
+		static void decodeRange(const OctNormal *in, Normal3 *out, const size_t &n) {
+			size_t i = 0;
+#if defined(AYA_USE_SIMD)
+			for (; i + 4 <= n; i += 4)
+				decodePacket(in + i, out + i);
+#endif
+			for (; i < n; i++)
+				out[i] = in[i].toNormal();
+		}
+
+		friend inline std::ostream &operator<<(std::ostream &os, const OctNormal &n) {
+			os << "[ " << int(n.x)
+				<< ", " << int(n.y)
+				<< " ]";
+			return os;
+		}
+
+	private:
+		static AYA_FORCE_INLINE float signNotZero(const float &v) {
+			return v >= 0.f ? 1.f : -1.f;
+		}
+
+		// Shared by toNormal() and decodePacket(), so a normal decodes to the same bits alone
+		// or inside a batch
+		template<class V>
+		static AYA_FORCE_INLINE void normalizeKernel(V &u, V &v, V &z) {
+			const V len2 = SimdMath::madd(u, u, SimdMath::madd(v, v, SimdMath::mul(z, z)));
+			const V inv = SimdMath::div(SimdMath::splat(u, 1.f), SimdMath::sqrt(len2));
+			u = SimdMath::mul(u, inv);
+			v = SimdMath::mul(v, inv);
+			z = SimdMath::mul(z, inv);
+		}
+
+#if defined(AYA_USE_SIMD)
+		// Sign bit of each lane that is below zero, -0 counts as positive like the scalar path
+		static AYA_FORCE_INLINE __m128 signNotZero(const __m128 &v) {
+			return _mm_and_ps(_mm_cmplt_ps(v, _mm_setzero_ps()), vMzeroMask);
+		}
+
+		static AYA_FORCE_INLINE void encodePacket(const Normal3 *in, OctNormal *out) {
+			Vector3x4 v = Vector3x4::load(in);
+			__m128 one = _mm_set1_ps(1.f);
+			__m128 ax = _mm_and_ps(v.m_val128[0], vAbsfMask);
+			__m128 ay = _mm_and_ps(v.m_val128[1], vAbsfMask);
+			__m128 az = _mm_and_ps(v.m_val128[2], vAbsfMask);
+			__m128 sum = _mm_add_ps(_mm_add_ps(ax, ay), az);
+			__m128 inv = _mm_and_ps(_mm_div_ps(one, sum), _mm_cmpgt_ps(sum, _mm_setzero_ps()));
+			__m128 u = _mm_mul_ps(v.m_val128[0], inv);
+			__m128 w = _mm_mul_ps(v.m_val128[1], inv);
+
+			// fold the lower hemisphere, (1 - |v|) gets the sign of u and (1 - |u|) the sign of v
+			__m128 au = _mm_and_ps(u, vAbsfMask);
+			__m128 aw = _mm_and_ps(w, vAbsfMask);
+			__m128 fu = _mm_or_ps(_mm_sub_ps(one, aw), signNotZero(u));
+			__m128 fw = _mm_or_ps(_mm_sub_ps(one, au), signNotZero(w));
+			__m128 lower = _mm_cmplt_ps(v.m_val128[2], _mm_setzero_ps());
+			u = _mm_or_ps(_mm_and_ps(lower, fu), _mm_andnot_ps(lower, u));
+			w = _mm_or_ps(_mm_and_ps(lower, fw), _mm_andnot_ps(lower, w));
+
+			__m128 scale = _mm_set1_ps(float(s_max));
+			__m128 lo = _mm_set1_ps(-1.f);
+			__m128i qu = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(u, lo), one), scale));
+			__m128i qw = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(w, lo), one), scale));
+
+			// u0 w0 u1 w1 u2 w2 u3 w3 as int16, narrowed once more for the 8-bit encoding
+			__m128i packed = _mm_unpacklo_epi16(_mm_packs_epi32(qu, qu), _mm_packs_epi32(qw, qw));
+			if (sizeof(T) == 1)
+				storePacked(out, _mm_packs_epi16(packed, packed));
+			else
+				storePacked(out, packed);
+		}
+		static AYA_FORCE_INLINE void decodePacket(const OctNormal *in, Normal3 *out) {
+			__m128i packed = loadPacked(in);
+			// sign extend to one (u, w) pair of int16 per 32-bit lane
+			if (sizeof(T) == 1)
+				packed = _mm_srai_epi16(_mm_unpacklo_epi8(packed, packed), 8);
+			__m128i qu = _mm_srai_epi32(_mm_slli_epi32(packed, 16), 16);
+			__m128i qw = _mm_srai_epi32(packed, 16);
+
+			__m128 one = _mm_set1_ps(1.f);
+			__m128 lo = _mm_set1_ps(-1.f);
+			__m128 scale = _mm_set1_ps(1.f / s_max);
+			__m128 u = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(qu), scale), lo);
+			__m128 w = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(qw), scale), lo);
+			__m128 z = _mm_sub_ps(_mm_sub_ps(one, _mm_and_ps(u, vAbsfMask)), _mm_and_ps(w, vAbsfMask));
+
+			// unfold the lower hemisphere, moving u and w towards zero by max(-z, 0)
+			__m128 t = _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), z), _mm_setzero_ps());
+			u = _mm_sub_ps(u, _mm_or_ps(t, signNotZero(u)));
+			w = _mm_sub_ps(w, _mm_or_ps(t, signNotZero(w)));
+
+			normalizeKernel(u, w, z);
+			Vector3x4(u, w, z).store(out);
+		}
+
+		// 4 encoded normals are 8 bytes for OctNormal8 and 16 bytes for OctNormal16
+		static AYA_FORCE_INLINE void storePacked(OctNormal *out, const __m128i &v) {
+			if (sizeof(T) == 1)
+				_mm_storel_epi64((__m128i*)out, v);
+			else
+				_mm_storeu_si128((__m128i*)out, v);
+		}
+		static AYA_FORCE_INLINE __m128i loadPacked(const OctNormal *in) {
+			if (sizeof(T) == 1)
+				return _mm_loadl_epi64((const __m128i*)in);
+			return _mm_loadu_si128((const __m128i*)in);
+		}
+#endif
+	};
+
+	typedef OctNormal<int16_t> OctNormal16;
+	typedef OctNormal<int8_t> OctNormal8;
+}
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef AYA_MATH_PARALLEL_H
+#define AYA_MATH_PARALLEL_H
+
+#include "MathUtility.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Aya {
+	// Fixed set of worker threads shared by every batch and builder of the library, started on
+	// first use. The calling thread always works on its own job as well, so run() finishes even
+	// when all workers are busy, nested calls (from inside func or from a worker) are safe, and
+	// many threads calling at once add no more than getThreadCount() - 1 threads in total.
+	class ThreadPool {
+	public:
+		explicit ThreadPool(const size_t &workers) : m_stop(false) {
+			for (size_t i = 0; i < workers; i++)
+				m_workers.emplace_back([this]() { workerLoop(); });
+		}
+		~ThreadPool() {
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stop = true;
+			}
+			m_wake.notify_all();
+			for (auto &w : m_workers)
+				w.join();
+		}
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool &operator = (const ThreadPool &) = delete;
+
+		// One worker per hardware thread besides the caller. Never destroyed, so batches stay
+		// usable from static destructors and the workers never race the end of main.
+		static ThreadPool &global() {
+			static ThreadPool *pool = new ThreadPool(Max(std::thread::hardware_concurrency(), 1u) - 1);
+			return *pool;
+		}
+
+		// Workers plus the calling thread
+		AYA_FORCE_INLINE size_t getThreadCount() const {
+			return m_workers.size() + 1;
+		}
+
+		// Calls func(i) for every i in [0, count) and returns once all calls are done
+		template<class Func>
+		void run(const size_t &count, const Func &func) {
+			if (count <= 1 || m_workers.empty()) {
+				for (size_t i = 0; i < count; i++)
+					func(i);
+				return;
+			}
+
+			Job job(count, &func, [](const void *f, const size_t &i) {
+				(*(const Func*)f)(i);
+			});
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_jobs.push_back(&job);
+			}
+			for (size_t i = Min(count - 1, m_workers.size()); i > 0; i--)
+				m_wake.notify_one();
+			job.work();
+
+			// every index is claimed now, wait for the workers still running one
+			std::unique_lock<std::mutex> lock(m_mutex);
+			auto it = std::find(m_jobs.begin(), m_jobs.end(), &job);
+			if (it != m_jobs.end())
+				m_jobs.erase(it);
+			m_done.wait(lock, [&job]() { return job.m_users == 0; });
+		}
+
+	private:
+		struct Job {
+			const size_t m_count;
+			const void *mp_func;
+			void (*mp_invoke)(const void *, const size_t &);
+			std::atomic<size_t> m_next;
+			size_t m_users;	// workers inside work(), guarded by m_mutex
+
+			Job(const size_t &count, const void *func, void (*invoke)(const void *, const size_t &)) :
+				m_count(count), mp_func(func), mp_invoke(invoke), m_next(0), m_users(0) {}
+
+			void work() {
+				for (size_t i = m_next.fetch_add(1); i < m_count; i = m_next.fetch_add(1))
+					mp_invoke(mp_func, i);
+			}
+		};
+
+		void workerLoop() {
+			std::unique_lock<std::mutex> lock(m_mutex);
+			for (;;) {
+				m_wake.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+				if (m_stop)
+					return;
+
+				Job *job = m_jobs.front();
+				job->m_users++;
+				lock.unlock();
+				job->work();
+				lock.lock();
+
+				// nothing left to claim, retire the job unless its caller already did
+				if (!m_jobs.empty() && m_jobs.front() == job)
+					m_jobs.pop_front();
+				if (--job->m_users == 0)
+					m_done.notify_all();
+			}
+		}
+
+		std::vector<std::thread> m_workers;
+		std::deque<Job*> m_jobs;
+		std::mutex m_mutex;
+		std::condition_variable m_wake, m_done;
+		bool m_stop;
+	};
+
+	// Splits [0, count) into contiguous chunks of at least grain items, at most one per thread of
+	// ThreadPool::global(), and calls func(begin, end) for each of them. Small ranges stay on the
+	// calling thread.
+	template<class Func>
+	void ParallelFor(size_t count, size_t grain, const Func &func) {
+		ThreadPool &pool = ThreadPool::global();
+		size_t chunks = Min(pool.getThreadCount(), (count + grain - 1) / Max(grain, size_t(1)));
+		if (chunks <= 1) {
+			func(size_t(0), count);
+			return;
+		}
+
+		// keep chunk boundaries on multiples of 8 so that packets never straddle two chunks
+		size_t chunk = ((count + chunks - 1) / chunks + 7) & ~size_t(7);
+		pool.run((count + chunk - 1) / chunk, [&](const size_t &c) {
+			func(c * chunk, Min((c + 1) * chunk, count));
+		});
+	}
+}
+
+#endif
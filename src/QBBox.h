@@ -0,0 +1,206 @@
+#ifndef AYA_MATH_QBBOX_H
+#define AYA_MATH_QBBOX_H
+
+#include "BBox.h"
+#include "Vector3x4.h"
+
+#include <string.h>
+
+namespace Aya {
+	// N child boxes of a wide BVH node quantized against the node's own bounds. Each axis has
+	// an origin and a power of two step 2^m_exp[a], a child plane is m_origin[a] + q * step with
+	// q in [0, 255]. Quantization rounds outwards, so a decoded child always contains the box
+	// it was built from. QBBox4 is 40 bytes against 96 for BBox4, QBBox8 is 64 bytes (one cache
+	// line) against 192 for BBox8. Unused lanes hold the empty box (min 255, max 0).
+	template<int N>
+	class QBBox {
+	public:
+		float m_origin[3];
+		int8_t m_exp[3];
+		uint8_t m_pad;
+		uint8_t m_qmin[3][N];
+		uint8_t m_qmax[3][N];
+
+	public:
+		QBBox() {
+			m_origin[0] = m_origin[1] = m_origin[2] = 0.f;
+			m_exp[0] = m_exp[1] = m_exp[2] = 0;
+			m_pad = 0;
+			setEmpty();
+		}
+		explicit QBBox(const BBox &parent) {
+			m_pad = 0;
+			setParent(parent);
+		}
+
+		// Picks the smallest step per axis so that 255 steps cover the parent, clears all lanes
+		AYA_FORCE_INLINE void setParent(const BBox &parent) {
+			for (int a = 0; a < 3; a++) {
+				m_origin[a] = parent.m_pmin[a];
+				float extent = Max(parent.m_pmax[a] - parent.m_pmin[a], 0.f);
+				int e = 0;
+				frexpf(extent / 255.f, &e);
+				e = Clamp(e, -126, 127);
+				while (e < 127 && decode(a, 255, e) < parent.m_pmax[a])
+					e++;
+				m_exp[a] = int8_t(e);
+			}
+			setEmpty();
+		}
+		AYA_FORCE_INLINE void setEmpty() {
+			memset(m_qmin, 0xff, sizeof(m_qmin));
+			memset(m_qmax, 0, sizeof(m_qmax));
+		}
+
+		// Quantizes b into lane i, b should lie inside the parent given to setParent
+		AYA_FORCE_INLINE void setBox(const int &i, const BBox &b) {
+			assert(i >= 0 && i < N);
+			if (b.m_pmin.x() > b.m_pmax.x() || b.m_pmin.y() > b.m_pmax.y() || b.m_pmin.z() > b.m_pmax.z()) {
+				for (int a = 0; a < 3; a++) {
+					m_qmin[a][i] = 255;
+					m_qmax[a][i] = 0;
+				}
+				return;
+			}
+			for (int a = 0; a < 3; a++) {
+				float step = pow2(m_exp[a]);
+				int lo = Clamp(FloorToInt((b.m_pmin[a] - m_origin[a]) / step), 0, 255);
+				int hi = Clamp(CeilToInt((b.m_pmax[a] - m_origin[a]) / step), 0, 255);
+				// the division and the decode both round, step until the decoded planes enclose b
+				while (lo > 0 && decode(a, lo, m_exp[a]) > b.m_pmin[a])
+					lo--;
+				while (hi < 255 && decode(a, hi, m_exp[a]) < b.m_pmax[a])
+					hi++;
+				assert(decode(a, lo, m_exp[a]) <= b.m_pmin[a] && decode(a, hi, m_exp[a]) >= b.m_pmax[a]);
+				m_qmin[a][i] = uint8_t(lo);
+				m_qmax[a][i] = uint8_t(hi);
+			}
+		}
+		AYA_FORCE_INLINE BBox getBox(const int &i) const {
+			assert(i >= 0 && i < N);
+			BBox ret;
+			ret.m_pmin = Point3(decode(0, m_qmin[0][i], m_exp[0]),
+				decode(1, m_qmin[1][i], m_exp[1]),
+				decode(2, m_qmin[2][i], m_exp[2]));
+			ret.m_pmax = Point3(decode(0, m_qmax[0][i], m_exp[0]),
+				decode(1, m_qmax[1][i], m_exp[1]),
+				decode(2, m_qmax[2][i], m_exp[2]));
+			return ret;
+		}
+		AYA_FORCE_INLINE bool isEmpty(const int &i) const {
+			return m_qmin[0][i] > m_qmax[0][i];
+		}
+
+		// Slab test of one ray against the N children. The planes are decoded with one exact
+		// multiply-add and then go through the same (plane - ori) * inv_dir as BBox4, rounding
+		// is monotone so a ray hitting the original child always hits the quantized one.
+		// Returns the hit mask (bit i for child i) and writes the per-lane entry distance to t_near.
+		AYA_FORCE_INLINE int intersect(const SlabRay &r, float *t_near = nullptr) const {
+			float step[3];
+			for (int a = 0; a < 3; a++)
+				step[a] = pow2(m_exp[a]);
+			int mask = 0;
+#if defined(AYA_USE_SIMD)
+#if defined(AYA_USE_AVX)
+			if (N % 8 == 0) {
+				for (int g = 0; g < N; g += 8)
+					mask |= intersect8(r, step, g, t_near) << g;
+				return mask;
+			}
+#endif
+			for (int g = 0; g < N; g += 4) {
+				__m128 tmin = _mm_set1_ps(r.m_mint);
+				__m128 tmax = _mm_set1_ps(r.m_maxt);
+				for (int a = 0; a < 3; a++) {
+					const uint8_t *near_q = r.m_dir_is_neg[a] ? m_qmax[a] : m_qmin[a];
+					const uint8_t *far_q = r.m_dir_is_neg[a] ? m_qmin[a] : m_qmax[a];
+					const __m128 s = _mm_set1_ps(step[a]);
+					const __m128 o = _mm_set1_ps(m_origin[a]);
+					const __m128 ori = _mm_set1_ps(r.m_ori[a]);
+					const __m128 inv = _mm_set1_ps(r.m_inv_dir[a]);
+					const __m128 near_p = _mm_madd_ps(load4(near_q + g), s, o);
+					const __m128 far_p = _mm_madd_ps(load4(far_q + g), s, o);
+
+					tmin = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(near_p, ori), inv), tmin);
+					tmax = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(far_p, ori), inv), tmax);
+				}
+				if (t_near) _mm_storeu_ps(t_near + g, tmin);
+				mask |= _mm_movemask_ps(_mm_cmple_ps(tmin, tmax)) << g;
+			}
+#else
+			for (int i = 0; i < N; i++) {
+				float tmin = r.m_mint, tmax = r.m_maxt;
+				for (int a = 0; a < 3; a++) {
+					float t0 = (decode(a, r.m_dir_is_neg[a] ? m_qmax[a][i] : m_qmin[a][i], m_exp[a]) - r.m_ori[a]) * r.m_inv_dir[a];
+					float t1 = (decode(a, r.m_dir_is_neg[a] ? m_qmin[a][i] : m_qmax[a][i], m_exp[a]) - r.m_ori[a]) * r.m_inv_dir[a];
+					tmin = t0 > tmin ? t0 : tmin;
+					tmax = t1 < tmax ? t1 : tmax;
+				}
+				if (t_near) t_near[i] = tmin;
+				mask |= (tmin <= tmax) << i;
+			}
+#endif
+			return mask;
+		}
+
+		friend inline std::ostream &operator<<(std::ostream &os, const QBBox &b) {
+			os << "[";
+			for (int i = 0; i < N; i++)
+				os << (i ? " " : "") << b.getBox(i) << (i + 1 < N ? ",\n" : "]");
+			return os;
+		}
+
+	private:
+		// 2^e straight from the exponent bits, setParent keeps e within the normal range [-126, 127]
+		static AYA_FORCE_INLINE float pow2(const int &e) {
+			const uint32_t bits = uint32_t(e + 127) << 23;
+			float ret;
+			memcpy(&ret, &bits, sizeof(ret));
+			return ret;
+		}
+		// q * 2^e is exact, so this rounds once however the sum is evaluated
+		AYA_FORCE_INLINE float decode(const int &a, const int &q, const int &e) const {
+			return m_origin[a] + float(q) * pow2(e);
+		}
+
+#if defined(AYA_USE_SIMD)
+		// 4 consecutive bytes widened to float
+		static AYA_FORCE_INLINE __m128 load4(const uint8_t *q) {
+			int32_t bits;
+			memcpy(&bits, q, sizeof(bits));
+			__m128i zero = _mm_setzero_si128();
+			__m128i v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), zero);
+			return _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero));
+		}
+#if defined(AYA_USE_AVX)
+		static AYA_FORCE_INLINE __m256 load8(const uint8_t *q) {
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(load4(q)), load4(q + 4), 1);
+		}
+		AYA_FORCE_INLINE int intersect8(const SlabRay &r, const float *step, const int &g, float *t_near) const {
+			__m256 tmin = _mm256_set1_ps(r.m_mint);
+			__m256 tmax = _mm256_set1_ps(r.m_maxt);
+			for (int a = 0; a < 3; a++) {
+				const uint8_t *near_q = r.m_dir_is_neg[a] ? m_qmax[a] : m_qmin[a];
+				const uint8_t *far_q = r.m_dir_is_neg[a] ? m_qmin[a] : m_qmax[a];
+				const __m256 s = _mm256_set1_ps(step[a]);
+				const __m256 o = _mm256_set1_ps(m_origin[a]);
+				const __m256 ori = _mm256_set1_ps(r.m_ori[a]);
+				const __m256 inv = _mm256_set1_ps(r.m_inv_dir[a]);
+				const __m256 near_p = _mm256_madd_ps(load8(near_q + g), s, o);
+				const __m256 far_p = _mm256_madd_ps(load8(far_q + g), s, o);
+
+				tmin = _mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(near_p, ori), inv), tmin);
+				tmax = _mm256_min_ps(_mm256_mul_ps(_mm256_sub_ps(far_p, ori), inv), tmax);
+			}
+			if (t_near) _mm256_storeu_ps(t_near + g, tmin);
+			return _mm256_movemask_ps(_mm256_cmp_ps(tmin, tmax, _CMP_LE_OQ));
+		}
+#endif
+#endif
+	};
+
+	typedef QBBox<4> QBBox4;
+	typedef QBBox<8> QBBox8;
+}
+
+#endif
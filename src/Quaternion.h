@@ -2,6 +2,7 @@
 #define AYA_MATH_QUATERNION_H
 
 #include "Vector3.h"
+#include "Matrix3x3.h"
 
 #define AYA_EULER_DEFAULT_ZYX
 #if defined (AYA_USE_SIMD)
@@ -11,22 +12,20 @@
 #endif
 
 namespace Aya {
-#if defined(AYA_USE_SIMD)
-	__declspec(align(16))
-#endif
-		class Quaternion : public QuadWord {
+		class AYA_SIMD_ALIGN Quaternion : public QuadWord {
 #if defined(AYA_DEBUG)
 		private:
-			AYA_FORCE_INLINE void numericValid(int x) {
-				assert(!isnan(m_val[0]) && !isnan(m_val[1]) && !isnan(m_val[2]) && !isnan(m_val[3]));
+			AYA_FORCE_INLINE AYA_CONSTEXPR void numericValid(int x) {
+				if (!AYA_CONSTANT_EVALUATED())
+					assert(!isnan(m_val[0]) && !isnan(m_val[1]) && !isnan(m_val[2]) && !isnan(m_val[3]));
 			}
 #else
 #define numericValid
 #endif
 
 		public:
-			Quaternion() {}
-			AYA_FORCE_INLINE Quaternion(const float &x, const float &y, const float &z, const float &w) {
+			AYA_CONSTEXPR Quaternion() {}
+			AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion(const float &x, const float &y, const float &z, const float &w) {
 				m_val[0] = x;
 				m_val[1] = y;
 				m_val[2] = z;
@@ -54,20 +53,48 @@ namespace Aya {
 #endif
 			}
 
+			// Rotation of an orthonormal matrix, the inverse of AffineTransform::setRotation(const Quaternion &)
+			explicit Quaternion(const Matrix3x3 &m) {
+				float trace = m[0][0] + m[1][1] + m[2][2];
+				if (trace > 0.f) {
+					float s = Sqrt(trace + 1.f);
+					m_val[3] = s * .5f;
+					s = .5f / s;
+					m_val[0] = (m[2][1] - m[1][2]) * s;
+					m_val[1] = (m[0][2] - m[2][0]) * s;
+					m_val[2] = (m[1][0] - m[0][1]) * s;
+				}
+				else {
+					// start from the largest diagonal element to keep s away from zero
+					const int next[3] = { 1, 2, 0 };
+					int i = 0;
+					if (m[1][1] > m[0][0]) i = 1;
+					if (m[2][2] > m[i][i]) i = 2;
+					int j = next[i];
+					int k = next[j];
+					float s = Sqrt((m[i][i] - (m[j][j] + m[k][k])) + 1.f);
+					m_val[i] = s * .5f;
+					if (s != 0.f) s = .5f / s;
+					m_val[3] = (m[k][j] - m[j][k]) * s;
+					m_val[j] = (m[j][i] + m[i][j]) * s;
+					m_val[k] = (m[k][i] + m[i][k]) * s;
+				}
+				numericValid(1);
+			}
 #if defined(AYA_USE_SIMD)
 			AYA_FORCE_INLINE Quaternion(const __m128 &v128) {
 				m_val128 = v128;
 			}
-			AYA_FORCE_INLINE Quaternion(const Quaternion &rhs) {
-				m_val128 = rhs.m_val128;
+			AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion(const Quaternion &rhs) {
+				copyFrom(rhs);
 			}
-			AYA_FORCE_INLINE Quaternion& operator = (const Quaternion &rhs) {
-				m_val128 = rhs.m_val128;
+			AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion& operator = (const Quaternion &rhs) {
+				copyFrom(rhs);
 				return *this;
 			}
 #endif
 
-			AYA_FORCE_INLINE void setValue(const float &x, const float &y, const float &z, const float &w) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR void setValue(const float &x, const float &y, const float &z, const float &w) {
 				m_val[0] = x;
 				m_val[1] = y;
 				m_val[2] = z;
@@ -75,17 +102,18 @@ namespace Aya {
 				numericValid(1);
 			}
 
-			AYA_FORCE_INLINE bool operator == (const Quaternion &q) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR bool operator == (const Quaternion &q) const {
 #if defined(AYA_USE_SIMD)
-				return (0xf == _mm_movemask_ps((__m128)_mm_cmpeq_ps(m_val128, q.m_val128)));
-#else
+				if (!AYA_CONSTANT_EVALUATED()) {
+					return (0xf == _mm_movemask_ps((__m128)_mm_cmpeq_ps(m_val128, q.m_val128)));
+				}
+#endif
 				return ((m_val[0] == q.m_val[0]) &&
 					(m_val[1] == q.m_val[1]) &&
 					(m_val[2] == q.m_val[2]) &&
 					(m_val[3] == q.m_val[3]));
-#endif
 			}
-			AYA_FORCE_INLINE bool operator != (const Quaternion &q) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR bool operator != (const Quaternion &q) const {
 				return !((*this) == q);
 			}
 
@@ -109,18 +137,22 @@ namespace Aya {
 				SetMin(m_val[3], q.m_val[3]);
 #endif
 			}
-			AYA_FORCE_INLINE void setZero() {
+			AYA_FORCE_INLINE AYA_CONSTEXPR void setZero() {
 #if defined(AYA_USE_SIMD)
-				m_val128 = _mm_xor_ps(m_val128, m_val128);
-#else
-				m_val[0] = 0.f;
-				m_val[1] = 0.f;
-				m_val[2] = 0.f;
-				m_val[3] = 0.f;
+				if (!AYA_CONSTANT_EVALUATED()) {
+					m_val128 = _mm_xor_ps(m_val128, m_val128);
+				}
+				else
 #endif
+				{
+					m_val[0] = 0.f;
+					m_val[1] = 0.f;
+					m_val[2] = 0.f;
+					m_val[3] = 0.f;
+				}
 			}
 
-			AYA_FORCE_INLINE bool isZero() const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR bool isZero() const {
 				return (m_val[0] == 0.f && m_val[1] == 0.f && m_val[2] == 0.f);
 			}
 			AYA_FORCE_INLINE bool fuzzyZero() const {
@@ -131,20 +163,21 @@ namespace Aya {
 			{
 				float d = axis.length();
 				assert(d != 0.0f);
-				float s = sinf(angle * 0.5f) / d;
-				setValue(axis.x() * s, axis.y() * s, axis.z() * s, cosf(angle * 0.5f));
+				float s, c;
+				SimdMath::sincos(angle * 0.5f, &s, &c);
+				s /= d;
+				setValue(axis.x() * s, axis.y() * s, axis.z() * s, c);
 			}
 			void setEuler(const float& yaw, const float& pitch, const float& roll)
 			{
-				float half_yaw = 0.5f * yaw;
-				float half_pitch = 0.5f * pitch;
-				float half_roll = 0.5f * roll;
-				float cos_yaw = cosf(half_yaw);
-				float sin_yaw = sinf(half_yaw);
-				float cos_pitch = cosf(half_pitch);
-				float sin_pitch = sinf(half_pitch);
-				float cos_roll = cosf(half_roll);
-				float sin_roll = sinf(half_roll);
+				float half[3] = { 0.5f * yaw, 0.5f * pitch, 0.5f * roll }, s[3], c[3];
+				SimdMath::sincos(half, s, c, 3);
+				float cos_yaw = c[0];
+				float sin_yaw = s[0];
+				float cos_pitch = c[1];
+				float sin_pitch = s[1];
+				float cos_roll = c[2];
+				float sin_roll = s[2];
 				setValue(cos_roll * sin_pitch * cos_yaw + sin_roll * cos_pitch * sin_yaw,
 					cos_roll * cos_pitch * sin_yaw - sin_roll * sin_pitch * cos_yaw,
 					sin_roll * cos_pitch * cos_yaw - cos_roll * sin_pitch * sin_yaw,
@@ -152,15 +185,14 @@ namespace Aya {
 			}
 			void setEulerZYX(const float& yaw_z, const float& pitch_y, const float& roll_x)
 			{
-				float half_yaw = 0.5f * yaw_z;
-				float half_pitch = 0.5f * pitch_y;
-				float half_roll = 0.5f * roll_x;
-				float cos_yaw = cosf(half_yaw);
-				float sin_yaw = sinf(half_yaw);
-				float cos_pitch = cosf(half_pitch);
-				float sin_pitch = sinf(half_pitch);
-				float cos_roll = cosf(half_roll);
-				float sin_roll = sinf(half_roll);
+				float half[3] = { 0.5f * yaw_z, 0.5f * pitch_y, 0.5f * roll_x }, s[3], c[3];
+				SimdMath::sincos(half, s, c, 3);
+				float cos_yaw = c[0];
+				float sin_yaw = s[0];
+				float cos_pitch = c[1];
+				float sin_pitch = s[1];
+				float cos_roll = c[2];
+				float sin_roll = s[2];
 				setValue(sin_roll * cos_pitch * cos_yaw - cos_roll * sin_pitch * sin_yaw,   //x
 					cos_roll * sin_pitch * cos_yaw + sin_roll * cos_pitch * sin_yaw,   //y
 					cos_roll * cos_pitch * sin_yaw - sin_roll * sin_pitch * cos_yaw,   //z
@@ -182,274 +214,307 @@ namespace Aya {
 				{
 					pitch_y = -0.5f * float(M_PI);
 					roll_x = 0;
-					yaw_z = 2.f * atan2f(m_val[0], -m_val[1]);
+					yaw_z = 2.f * SimdMath::atan2(m_val[0], -m_val[1]);
 				}
 				else if (sarg >= 0.99999f)
 				{
 					pitch_y = 0.5f * float(M_PI);
 					roll_x = 0;
-					yaw_z = 2.f * atan2f(-m_val[0], m_val[1]);
+					yaw_z = 2.f * SimdMath::atan2(-m_val[0], m_val[1]);
 				}
 				else
 				{
-					pitch_y = asinf(sarg);
-					roll_x = atan2f(2.f * (m_val[1] * m_val[2] + m_val[3] * m_val[0]), squ - sqx - sqy + sqz);
-					yaw_z = atan2f(2.f * (m_val[0] * m_val[1] + m_val[3] * m_val[2]), squ + sqx - sqy - sqz);
+					pitch_y = SimdMath::asin(sarg);
+					roll_x = SimdMath::atan2(2.f * (m_val[1] * m_val[2] + m_val[3] * m_val[0]), squ - sqx - sqy + sqz);
+					yaw_z = SimdMath::atan2(2.f * (m_val[0] * m_val[1] + m_val[3] * m_val[2]), squ + sqx - sqy - sqz);
 				}
 			}
-			AYA_FORCE_INLINE Quaternion operator + (const Quaternion &q) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion operator + (const Quaternion &q) const {
 #if defined(AYA_USE_SIMD)
-				return Quaternion(_mm_add_ps(m_val128, q.m_val128));
-#else
+				if (!AYA_CONSTANT_EVALUATED()) {
+					return Quaternion(_mm_add_ps(m_val128, q.m_val128));
+				}
+#endif
 				return Quaternion(m_val[0] + q.m_val[0],
 					m_val[1] + q.m_val[1],
 					m_val[2] + q.m_val[2],
 					m_val[3] + q.m_val[3]);
-#endif
 			}
-			AYA_FORCE_INLINE Quaternion & operator += (const Quaternion &q) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion & operator += (const Quaternion &q) {
 #if defined(AYA_USE_SIMD)
-				m_val128 = _mm_add_ps(m_val128, q.m_val128);
-#else
-				m_val[0] += q.m_val[0];
-				m_val[1] += q.m_val[1];
-				m_val[2] += q.m_val[2];
-				m_val[3] += q.m_val[3];
+				if (!AYA_CONSTANT_EVALUATED()) {
+					m_val128 = _mm_add_ps(m_val128, q.m_val128);
+				}
+				else
 #endif
+				{
+					m_val[0] += q.m_val[0];
+					m_val[1] += q.m_val[1];
+					m_val[2] += q.m_val[2];
+					m_val[3] += q.m_val[3];
+				}
 				numericValid(1);
 				return *this;
 			}
-			AYA_FORCE_INLINE Quaternion operator - (const Quaternion &q) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion operator - (const Quaternion &q) const {
 #if defined(AYA_USE_SIMD)
-				return Quaternion(_mm_sub_ps(m_val128, q.m_val128));
-#else
+				if (!AYA_CONSTANT_EVALUATED()) {
+					return Quaternion(_mm_sub_ps(m_val128, q.m_val128));
+				}
+#endif
 				return Quaternion(m_val[0] - q.m_val[0],
 					m_val[1] - q.m_val[1],
 					m_val[2] - q.m_val[2],
 					m_val[3] - q.m_val[3]);
-#endif
 			}
-			AYA_FORCE_INLINE Quaternion & operator -= (const Quaternion &q) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion & operator -= (const Quaternion &q) {
 #if defined(AYA_USE_SIMD)
-				m_val128 = _mm_sub_ps(m_val128, q.m_val128);
-#else
-				m_val[0] -= q.m_val[0];
-				m_val[1] -= q.m_val[1];
-				m_val[2] -= q.m_val[2];
-				m_val[3] -= q.m_val[3];
+				if (!AYA_CONSTANT_EVALUATED()) {
+					m_val128 = _mm_sub_ps(m_val128, q.m_val128);
+				}
+				else
 #endif
+				{
+					m_val[0] -= q.m_val[0];
+					m_val[1] -= q.m_val[1];
+					m_val[2] -= q.m_val[2];
+					m_val[3] -= q.m_val[3];
+				}
 				numericValid(1);
 				return *this;
 			}
-			AYA_FORCE_INLINE Quaternion operator- () const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion operator- () const {
 #if defined(AYA_USE_SIMD)
-				return Quaternion(_mm_xor_ps(m_val128, vMzeroMask));
-#else
-				return Quaternion(-m_val[0], -m_val[1], -m_val[2], -m_val[3]);
+				if (!AYA_CONSTANT_EVALUATED()) {
+					return Quaternion(_mm_xor_ps(m_val128, vMzeroMask));
+				}
 #endif
+				return Quaternion(-m_val[0], -m_val[1], -m_val[2], -m_val[3]);
 			}
-			AYA_FORCE_INLINE Quaternion operator * (const float &s) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion operator * (const float &s) const {
 #if defined(AYA_USE_SIMD)
-				__m128 vs = _mm_load_ss(&s);
-				vs = _mm_pshufd_ps(vs, 0x00);
-				return Quaternion(_mm_mul_ps(m_val128, vs));
-#else
+				if (!AYA_CONSTANT_EVALUATED()) {
+					__m128 vs = _mm_load_ss(&s);
+					vs = _mm_pshufd_ps(vs, 0x00);
+					return Quaternion(_mm_mul_ps(m_val128, vs));
+				}
+#endif
 				return Quaternion(m_val[0] * s,
 					m_val[1] * s,
 					m_val[2] * s,
 					m_val[3] * s);
-#endif
 
 			}
-			AYA_FORCE_INLINE friend Quaternion operator * (const float &s, const Quaternion &v) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR friend Quaternion operator * (const float &s, const Quaternion &v) {
 				return v * s;
 			}
-			AYA_FORCE_INLINE Quaternion & operator *= (const float &s) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion & operator *= (const float &s) {
 #if defined(AYA_USE_SIMD)
-				__m128 vs = _mm_load_ss(&s);
-				vs = _mm_pshufd_ps(vs, 0x00);
-				m_val128 = _mm_mul_ps(m_val128, vs);
-#else
-				m_val[0] *= s;
-				m_val[1] *= s;
-				m_val[2] *= s;
-				m_val[3] *= s;
+				if (!AYA_CONSTANT_EVALUATED()) {
+					__m128 vs = _mm_load_ss(&s);
+					vs = _mm_pshufd_ps(vs, 0x00);
+					m_val128 = _mm_mul_ps(m_val128, vs);
+				}
+				else
 #endif
+				{
+					m_val[0] *= s;
+					m_val[1] *= s;
+					m_val[2] *= s;
+					m_val[3] *= s;
+				}
 				numericValid(1);
 				return *this;
 			}
-			AYA_FORCE_INLINE Quaternion operator * (const Quaternion & q) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion operator * (const Quaternion & q) const {
 #if defined(AYA_USE_SIMD)
-				__m128 vQ1 = m_val128;
-				__m128 vQ2 = q.m_val128;
-				__m128 A0, A1, B1, A2, B2;
+				if (!AYA_CONSTANT_EVALUATED()) {
+					__m128 vQ1 = m_val128;
+					__m128 vQ2 = q.m_val128;
+					__m128 A0, A1, B1, A2, B2;
 
-				A1 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(0, 1, 2, 0));  // X Y  z x     //      vtrn
-				B1 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(3, 3, 3, 0));  // W W  W X     // vdup vext
+					A1 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(0, 1, 2, 0));  // X Y  z x     //      vtrn
+					B1 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(3, 3, 3, 0));  // W W  W X     // vdup vext
 
-				A1 = _mm_mul_ps(A1, B1);
+					A1 = _mm_mul_ps(A1, B1);
 
-				A2 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(1, 2, 0, 1));  // Y Z  X Y     // vext
-				B2 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(2, 0, 1, 1));  // z x  Y Y     // vtrn vdup
+					A2 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(1, 2, 0, 1));  // Y Z  X Y     // vext
+					B2 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(2, 0, 1, 1));  // z x  Y Y     // vtrn vdup
 
-				A2 = _mm_mul_ps(A2, B2);
+					A2 = _mm_mul_ps(A2, B2);
 
-				B1 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(2, 0, 1, 2));  // z x Y Z      // vtrn vext
-				B2 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(1, 2, 0, 2));  // Y Z x z      // vext vtrn
+					B1 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(2, 0, 1, 2));  // z x Y Z      // vtrn vext
+					B2 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(1, 2, 0, 2));  // Y Z x z      // vext vtrn
 
-				B1 = _mm_mul_ps(B1, B2);  //	A3 *= B3
+					B1 = _mm_mul_ps(B1, B2);  //	A3 *= B3
 
-				A0 = _mm_splat_ps(vQ1, 3);  //	A0
-				A0 = _mm_mul_ps(A0, vQ2);             //	A0 * B0
+					A0 = _mm_splat_ps(vQ1, 3);  //	A0
+					A0 = _mm_mul_ps(A0, vQ2);             //	A0 * B0
 
-				A1 = _mm_add_ps(A1, A2);  //	AB12
-				A0 = _mm_sub_ps(A0, B1);  //	AB03 = AB0 - AB3
+					A1 = _mm_add_ps(A1, A2);  //	AB12
+					A0 = _mm_sub_ps(A0, B1);  //	AB03 = AB0 - AB3
 
-				A1 = _mm_xor_ps(A1, vPPPM);  //	change sign of the last element
-				A0 = _mm_add_ps(A0, A1);                //	AB03 + AB12
+					A1 = _mm_xor_ps(A1, vPPPM);  //	change sign of the last element
+					A0 = _mm_add_ps(A0, A1);                //	AB03 + AB12
 
-				return Quaternion(A0);
-#else
-				return Quaternion(
-					w() * q.x() + x() * q.w() + y() * q.z() - z() * q.y(),
-					w() * q.y() + y() * q.w() + z() * q.x() - x() * q.z(),
-					w() * q.z() + z() * q.w() + x() * q.y() - y() * q.x(),
-					w() * q.w() - x() * q.x() - y() * q.y() - z() * q.z());
+					return Quaternion(A0);
+				}
+				else
 #endif
+				{
+					return Quaternion(
+						w() * q.x() + x() * q.w() + y() * q.z() - z() * q.y(),
+						w() * q.y() + y() * q.w() + z() * q.x() - x() * q.z(),
+						w() * q.z() + z() * q.w() + x() * q.y() - y() * q.x(),
+						w() * q.w() - x() * q.x() - y() * q.y() - z() * q.z());
+				}
 			}
-			AYA_FORCE_INLINE Quaternion& operator *= (const Quaternion & q) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion& operator *= (const Quaternion & q) {
 #if defined(AYA_USE_SIMD)
-				__m128 vQ2 = q.get128();
+				if (!AYA_CONSTANT_EVALUATED()) {
+					__m128 vQ2 = q.get128();
 
-				__m128 A1 = _mm_pshufd_ps(m_val128, __MM_SHUFFLE(0, 1, 2, 0));
-				__m128 B1 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(3, 3, 3, 0));
+					__m128 A1 = _mm_pshufd_ps(m_val128, __MM_SHUFFLE(0, 1, 2, 0));
+					__m128 B1 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(3, 3, 3, 0));
 
-				A1 = _mm_mul_ps(A1, B1);
+					A1 = _mm_mul_ps(A1, B1);
 
-				__m128 A2 = _mm_pshufd_ps(m_val128, __MM_SHUFFLE(1, 2, 0, 1));
-				__m128 B2 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(2, 0, 1, 1));
+					__m128 A2 = _mm_pshufd_ps(m_val128, __MM_SHUFFLE(1, 2, 0, 1));
+					__m128 B2 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(2, 0, 1, 1));
 
-				A2 = _mm_mul_ps(A2, B2);
+					A2 = _mm_mul_ps(A2, B2);
 
-				B1 = _mm_pshufd_ps(m_val128, __MM_SHUFFLE(2, 0, 1, 2));
-				B2 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(1, 2, 0, 2));
+					B1 = _mm_pshufd_ps(m_val128, __MM_SHUFFLE(2, 0, 1, 2));
+					B2 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(1, 2, 0, 2));
 
-				B1 = _mm_mul_ps(B1, B2);  //	A3 *= B3
+					B1 = _mm_mul_ps(B1, B2);  //	A3 *= B3
 
-				m_val128 = _mm_splat_ps(m_val128, 3);  //	A0
-				m_val128 = _mm_mul_ps(m_val128, vQ2);            //	A0 * B0
+					m_val128 = _mm_splat_ps(m_val128, 3);  //	A0
+					m_val128 = _mm_mul_ps(m_val128, vQ2);            //	A0 * B0
 
-				A1 = _mm_add_ps(A1, A2);                //	AB12
-				m_val128 = _mm_sub_ps(m_val128, B1);      //	AB03 = AB0 - AB3
-				A1 = _mm_xor_ps(A1, vPPPM);  //	change sign of the last element
-				m_val128 = _mm_add_ps(m_val128, A1);      //	AB03 + AB12
-#else
-				setValue(
-					m_val[3] * q.x() + m_val[0] * q.w() + m_val[1] * q.z() - m_val[2] * q.y(),
-					m_val[3] * q.y() + m_val[1] * q.w() + m_val[2] * q.x() - m_val[0] * q.z(),
-					m_val[3] * q.z() + m_val[2] * q.w() + m_val[0] * q.y() - m_val[1] * q.x(),
-					m_val[3] * q.w() - m_val[0] * q.x() - m_val[1] * q.y() - m_val[2] * q.z());
+					A1 = _mm_add_ps(A1, A2);                //	AB12
+					m_val128 = _mm_sub_ps(m_val128, B1);      //	AB03 = AB0 - AB3
+					A1 = _mm_xor_ps(A1, vPPPM);  //	change sign of the last element
+					m_val128 = _mm_add_ps(m_val128, A1);      //	AB03 + AB12
+				}
+				else
 #endif
+				{
+					setValue(
+						m_val[3] * q.x() + m_val[0] * q.w() + m_val[1] * q.z() - m_val[2] * q.y(),
+						m_val[3] * q.y() + m_val[1] * q.w() + m_val[2] * q.x() - m_val[0] * q.z(),
+						m_val[3] * q.z() + m_val[2] * q.w() + m_val[0] * q.y() - m_val[1] * q.x(),
+						m_val[3] * q.w() - m_val[0] * q.x() - m_val[1] * q.y() - m_val[2] * q.z());
+				}
 				return *this;
 			}
-			AYA_FORCE_INLINE Quaternion operator * (const BaseVector3 & v) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion operator * (const BaseVector3 & v) const {
 #if defined(AYA_USE_SIMD)
-				__m128 vQ1 = get128();
-				__m128 vQ2 = v.get128();
-				__m128 A1, B1, A2, B2, A3, B3;
+				if (!AYA_CONSTANT_EVALUATED()) {
+					__m128 vQ1 = get128();
+					__m128 vQ2 = v.get128();
+					__m128 A1, B1, A2, B2, A3, B3;
 
-				A1 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(3, 3, 3, 0));
-				B1 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(0, 1, 2, 0));
+					A1 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(3, 3, 3, 0));
+					B1 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(0, 1, 2, 0));
 
-				A1 = _mm_mul_ps(A1, B1);
+					A1 = _mm_mul_ps(A1, B1);
 
-				A2 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(1, 2, 0, 1));
-				B2 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(2, 0, 1, 1));
+					A2 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(1, 2, 0, 1));
+					B2 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(2, 0, 1, 1));
 
-				A2 = _mm_mul_ps(A2, B2);
+					A2 = _mm_mul_ps(A2, B2);
 
-				A3 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(2, 0, 1, 2));
-				B3 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(1, 2, 0, 2));
+					A3 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(2, 0, 1, 2));
+					B3 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(1, 2, 0, 2));
 
-				A3 = _mm_mul_ps(A3, B3);  //	A3 *= B3
+					A3 = _mm_mul_ps(A3, B3);  //	A3 *= B3
 
-				A1 = _mm_add_ps(A1, A2);                //	AB12
-				A1 = _mm_xor_ps(A1, vPPPM);  //	change sign of the last element
-				A1 = _mm_sub_ps(A1, A3);                //	AB123 = AB12 - AB3
+					A1 = _mm_add_ps(A1, A2);                //	AB12
+					A1 = _mm_xor_ps(A1, vPPPM);  //	change sign of the last element
+					A1 = _mm_sub_ps(A1, A3);                //	AB123 = AB12 - AB3
 
-				return Quaternion(A1);
-#else
-				return Quaternion(
-					w() * v.x() + y() * v.z() - z() * v.y(),
-					w() * v.y() + z() * v.x() - x() * v.z(),
-					w() * v.z() + x() * v.y() - y() * v.x(),
-					-x() * v.x() - y() * v.y() - z() * v.z());
+					return Quaternion(A1);
+				}
+				else
 #endif
+				{
+					return Quaternion(
+						w() * v.x() + y() * v.z() - z() * v.y(),
+						w() * v.y() + z() * v.x() - x() * v.z(),
+						w() * v.z() + x() * v.y() - y() * v.x(),
+						-x() * v.x() - y() * v.y() - z() * v.z());
+				}
 			}
-			friend AYA_FORCE_INLINE Quaternion operator * (const BaseVector3 &w, const Quaternion& q) {
+			friend AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion operator * (const BaseVector3 &w, const Quaternion& q) {
 #if defined(AYA_USE_SIMD)
-				__m128 vQ1 = w.get128();
-				__m128 vQ2 = q.get128();
-				__m128 A1, B1, A2, B2, A3, B3;
+				if (!AYA_CONSTANT_EVALUATED()) {
+					__m128 vQ1 = w.get128();
+					__m128 vQ2 = q.get128();
+					__m128 A1, B1, A2, B2, A3, B3;
 
-				A1 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(0, 1, 2, 0));  // X Y  z x
-				B1 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(3, 3, 3, 0));  // W W  W X
+					A1 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(0, 1, 2, 0));  // X Y  z x
+					B1 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(3, 3, 3, 0));  // W W  W X
 
-				A1 = _mm_mul_ps(A1, B1);
+					A1 = _mm_mul_ps(A1, B1);
 
-				A2 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(1, 2, 0, 1));
-				B2 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(2, 0, 1, 1));
+					A2 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(1, 2, 0, 1));
+					B2 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(2, 0, 1, 1));
 
-				A2 = _mm_mul_ps(A2, B2);
+					A2 = _mm_mul_ps(A2, B2);
 
-				A3 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(2, 0, 1, 2));
-				B3 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(1, 2, 0, 2));
+					A3 = _mm_pshufd_ps(vQ1, __MM_SHUFFLE(2, 0, 1, 2));
+					B3 = _mm_pshufd_ps(vQ2, __MM_SHUFFLE(1, 2, 0, 2));
 
-				A3 = _mm_mul_ps(A3, B3);  //	A3 *= B3
+					A3 = _mm_mul_ps(A3, B3);  //	A3 *= B3
 
-				A1 = _mm_add_ps(A1, A2);                //	AB12
-				A1 = _mm_xor_ps(A1, vPPPM);  //	change sign of the last element
-				A1 = _mm_sub_ps(A1, A3);                //	AB123 = AB12 - AB3
+					A1 = _mm_add_ps(A1, A2);                //	AB12
+					A1 = _mm_xor_ps(A1, vPPPM);  //	change sign of the last element
+					A1 = _mm_sub_ps(A1, A3);                //	AB123 = AB12 - AB3
 
-				return Quaternion(A1);
-#else
-				return Quaternion(
-					+w.x() * q.w() + w.y() * q.z() - w.z() * q.y(),
-					+w.y() * q.w() + w.z() * q.x() - w.x() * q.z(),
-					+w.z() * q.w() + w.x() * q.y() - w.y() * q.x(),
-					-w.x() * q.x() - w.y() * q.y() - w.z() * q.z());
+					return Quaternion(A1);
+				}
+				else
 #endif
+				{
+					return Quaternion(
+						+w.x() * q.w() + w.y() * q.z() - w.z() * q.y(),
+						+w.y() * q.w() + w.z() * q.x() - w.x() * q.z(),
+						+w.z() * q.w() + w.x() * q.y() - w.y() * q.x(),
+						-w.x() * q.x() - w.y() * q.y() - w.z() * q.z());
+				}
 			}
-			AYA_FORCE_INLINE Quaternion operator / (const float &s) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion operator / (const float &s) const {
 				assert(s != 0.f);
 				Quaternion ret;
 				ret = (*this) * (1.f / s);
 				return ret;
 			}
-			AYA_FORCE_INLINE Quaternion & operator /= (const float &s) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion & operator /= (const float &s) {
 				assert(s != 0.f);
 				return *this *= (1.f / s);
 			}
 
-			AYA_FORCE_INLINE float dot(const Quaternion &q) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR float dot(const Quaternion &q) const {
 #if defined(AYA_USE_SIMD)
-				__m128 vd = _mm_mul_ps(m_val128, q.m_val128);
+				if (!AYA_CONSTANT_EVALUATED()) {
+					__m128 vd = _mm_mul_ps(m_val128, q.m_val128);
 
-				__m128 t = _mm_movehl_ps(vd, vd);
-				vd = _mm_add_ps(vd, t);
-				t = _mm_shuffle_ps(vd, vd, 0x55);
-				vd = _mm_add_ss(vd, t);
+					__m128 t = _mm_movehl_ps(vd, vd);
+					vd = _mm_add_ps(vd, t);
+					t = _mm_shuffle_ps(vd, vd, 0x55);
+					vd = _mm_add_ss(vd, t);
 
-				return _mm_cvtss_f32(vd);
-#else
+					return _mm_cvtss_f32(vd);
+				}
+#endif
 				return	m_val[0] * q.m_val[0] +
 					m_val[1] * q.m_val[1] +
 					m_val[2] * q.m_val[2] +
 					m_val[3] * q.m_val[3];
-#endif
 			}
 
-			AYA_FORCE_INLINE float length2() const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR float length2() const {
 				return dot(*this);
 			}
 			AYA_FORCE_INLINE float length() const {
@@ -492,7 +557,7 @@ namespace Aya {
 			}
 
 			AYA_FORCE_INLINE float getAngle() const {
-				return 2.f * acosf(m_val[3]);
+				return 2.f * SimdMath::acos(m_val[3]);
 			}
 			AYA_FORCE_INLINE BaseVector3 getAxis() const {
 				float s_squared = 1.f - m_val[3] * m_val[3];
@@ -501,12 +566,13 @@ namespace Aya {
 				float s = 1.f / Sqrt(s_squared);
 				return BaseVector3(m_val[0] * s, m_val[1] * s, m_val[2] * s);
 			}
-			AYA_FORCE_INLINE Quaternion inverse() const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Quaternion inverse() const {
 #if defined(AYA_USE_SIMD)
-				return Quaternion(_mm_xor_ps(m_val128, vQInv));
-#else
-				return Quaternion(-m_val[0], -m_val[1], -m_val[2], m_val[3]);
+				if (!AYA_CONSTANT_EVALUATED()) {
+					return Quaternion(_mm_xor_ps(m_val128, vQInv));
+				}
 #endif
+				return Quaternion(-m_val[0], -m_val[1], -m_val[2], m_val[3]);
 			}
 
 			Quaternion slerp(const Quaternion &q, const float &t) const
@@ -519,13 +585,15 @@ namespace Aya {
 
 				if (absproduct < 1.0f - AYA_EPSILON) {
 					// Take care of long angle case see http://en.wikipedia.org/wiki/Slerp
-					const float theta = cosf(absproduct);
-					const float d = sinf(theta);
+					const float theta = SimdMath::acos(absproduct);
+					const float sign = (product < 0) ? -1.f : 1.f;
+					float angles[3] = { theta, (1.0f - t) * theta, sign * t * theta }, s[3], c[3];
+					SimdMath::sincos(angles, s, c, 3);
+					const float d = s[0];
 					assert(d > 0.f);
 
-					const float sign = (product < 0) ? -1.f : 1.f;
-					const float s0 = sinf((1.0f - t) * theta) / d;
-					const float s1 = sinf(sign * t * theta) / d;
+					const float s0 = s[1] / d;
+					const float s1 = s[2] / d;
 
 					return Quaternion(
 						(m_val[0] * s0 + q.x() * s1),
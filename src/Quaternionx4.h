@@ -0,0 +1,311 @@
+#ifndef AYA_MATH_QUATERNIONX4_H
+#define AYA_MATH_QUATERNIONX4_H
+
+#include "Quaternion.h"
+#include "Parallel.h"
+
+namespace Aya {
+	// Accuracy of the batched interpolation, inputs are unit quaternions and the error is the
+	// largest absolute component error against a double precision slerp over the whole range
+	// of angles and t in [0, 1]:
+	//   SLERP_EXACT  Eberly's polynomial slerp without trig calls, below 4e-7 (a few ulp)
+	//   SLERP_FAST   nlerp with a cubic correction of t, below 4e-4, about 2/3 of the cost
+	// Both take the shorter arc and return unit quaternions.
+	enum SlerpMode {
+		SLERP_EXACT,
+		SLERP_FAST
+	};
+
+	// Four Quaternion in structure-of-arrays layout, lane i of m_val[0..3] is (x, y, z, w) of
+	// quaternion i. Per-lane scalar results are returned as a QuadWord.
+		class AYA_SIMD_ALIGN Quaternionx4 {
+		public:
+#if defined(AYA_USE_SIMD)
+			union {
+				float m_val[4][4];
+				__m128 m_val128[4];
+			};
+#else
+			float m_val[4][4];
+#endif
+
+			static const size_t s_parallel_grain = 1 << 14;
+
+		public:
+			Quaternionx4() {}
+			AYA_FORCE_INLINE Quaternionx4(const Quaternion &q0, const Quaternion &q1,
+				const Quaternion &q2, const Quaternion &q3) {
+				setValue(q0, q1, q2, q3);
+			}
+			explicit AYA_FORCE_INLINE Quaternionx4(const Quaternion &q) {
+				setValue(q, q, q, q);
+			}
+
+#if defined(AYA_USE_SIMD)
+			AYA_FORCE_INLINE Quaternionx4(const __m128 &x, const __m128 &y, const __m128 &z, const __m128 &w) {
+				m_val128[0] = x;
+				m_val128[1] = y;
+				m_val128[2] = z;
+				m_val128[3] = w;
+			}
+			AYA_FORCE_INLINE Quaternionx4(const Quaternionx4 &rhs) {
+				for (int c = 0; c < 4; c++)
+					m_val128[c] = rhs.m_val128[c];
+			}
+			AYA_FORCE_INLINE Quaternionx4& operator = (const Quaternionx4 &rhs) {
+				for (int c = 0; c < 4; c++)
+					m_val128[c] = rhs.m_val128[c];
+				return *this;
+			}
+
+			AYA_FORCE_INLINE void  *operator new(size_t i) {
+				return _mm_malloc(i, 16);
+			}
+
+			AYA_FORCE_INLINE void operator delete(void *p) {
+				_mm_free(p);
+			}
+#endif
+
+			AYA_FORCE_INLINE void setValue(const Quaternion &q0, const Quaternion &q1,
+				const Quaternion &q2, const Quaternion &q3) {
+#if defined(AYA_USE_SIMD)
+				__m128 t0 = _mm_unpacklo_ps(q0.m_val128, q1.m_val128); // x0 x1 y0 y1
+				__m128 t1 = _mm_unpacklo_ps(q2.m_val128, q3.m_val128); // x2 x3 y2 y3
+				__m128 t2 = _mm_unpackhi_ps(q0.m_val128, q1.m_val128); // z0 z1 w0 w1
+				__m128 t3 = _mm_unpackhi_ps(q2.m_val128, q3.m_val128); // z2 z3 w2 w3
+
+				m_val128[0] = _mm_movelh_ps(t0, t1);
+				m_val128[1] = _mm_movehl_ps(t1, t0);
+				m_val128[2] = _mm_movelh_ps(t2, t3);
+				m_val128[3] = _mm_movehl_ps(t3, t2);
+#else
+				const Quaternion *q[4] = { &q0, &q1, &q2, &q3 };
+				for (int i = 0; i < 4; i++)
+					for (int c = 0; c < 4; c++)
+						m_val[c][i] = (*q[i])[c];
+#endif
+			}
+
+			// Gather 4 consecutive Quaternion from q
+			static AYA_FORCE_INLINE Quaternionx4 load(const Quaternion *q) {
+				return Quaternionx4(q[0], q[1], q[2], q[3]);
+			}
+			// Scatter the 4 lanes into consecutive Quaternion at q
+			AYA_FORCE_INLINE void store(Quaternion *q) const {
+#if defined(AYA_USE_SIMD)
+				__m128 t0 = _mm_unpacklo_ps(m_val128[0], m_val128[1]); // x0 y0 x1 y1
+				__m128 t1 = _mm_unpacklo_ps(m_val128[2], m_val128[3]); // z0 w0 z1 w1
+				__m128 t2 = _mm_unpackhi_ps(m_val128[0], m_val128[1]); // x2 y2 x3 y3
+				__m128 t3 = _mm_unpackhi_ps(m_val128[2], m_val128[3]); // z2 w2 z3 w3
+
+				q[0].m_val128 = _mm_movelh_ps(t0, t1);
+				q[1].m_val128 = _mm_movehl_ps(t1, t0);
+				q[2].m_val128 = _mm_movelh_ps(t2, t3);
+				q[3].m_val128 = _mm_movehl_ps(t3, t2);
+#else
+				for (int i = 0; i < 4; i++)
+					q[i] = getQuaternion(i);
+#endif
+			}
+			AYA_FORCE_INLINE Quaternion getQuaternion(const int &i) const {
+				assert(i >= 0 && i < 4);
+				return Quaternion(m_val[0][i], m_val[1][i], m_val[2][i], m_val[3][i]);
+			}
+
+			AYA_FORCE_INLINE QuadWord dot(const Quaternionx4 &q) const {
+#if defined(AYA_USE_SIMD)
+				__m128 d = _mm_mul_ps(m_val128[0], q.m_val128[0]);
+				d = _mm_madd_ps(m_val128[1], q.m_val128[1], d);
+				d = _mm_madd_ps(m_val128[2], q.m_val128[2], d);
+				d = _mm_madd_ps(m_val128[3], q.m_val128[3], d);
+				return QuadWord(d);
+#else
+				QuadWord ret;
+				for (int i = 0; i < 4; i++)
+					ret[i] = m_val[0][i] * q.m_val[0][i] + m_val[1][i] * q.m_val[1][i] +
+					m_val[2][i] * q.m_val[2][i] + m_val[3][i] * q.m_val[3][i];
+				return ret;
+#endif
+			}
+
+			AYA_FORCE_INLINE Quaternionx4 normalize() const {
+#if defined(AYA_USE_SIMD)
+				__m128 vd = dot(*this).m_val128;
+
+				// one Newton-Raphson step on rsqrt, same as BaseVector3::normalize
+				__m128 y = _mm_rsqrt_ps(vd);
+				vd = _mm_mul_ps(_mm_mul_ps(vd, v0_5), _mm_mul_ps(y, y));
+				y = _mm_mul_ps(y, _mm_sub_ps(v1_5, vd));
+
+				return Quaternionx4(_mm_mul_ps(m_val128[0], y), _mm_mul_ps(m_val128[1], y),
+					_mm_mul_ps(m_val128[2], y), _mm_mul_ps(m_val128[3], y));
+#else
+				QuadWord l2 = dot(*this);
+				Quaternionx4 ret;
+				for (int i = 0; i < 4; i++) {
+					float s = 1.f / Sqrt(l2[i]);
+					for (int c = 0; c < 4; c++)
+						ret.m_val[c][i] = m_val[c][i] * s;
+				}
+				return ret;
+#endif
+			}
+
+			// Per-lane slerp towards q at t. sin(t * theta) / sin(theta) is evaluated as a
+			// polynomial in cos(theta) - 1 (Eberly, "A Fast and Accurate Algorithm for Computing
+			// SLERP"), the last term is scaled to absorb the truncation error.
+			AYA_FORCE_INLINE Quaternionx4 slerp(const Quaternionx4 &q, const QuadWord &t) const {
+				// 14 terms, mu fitted for the smallest maximum error over x in [0, 1] and t in [0, 1]
+				static const float s_one_plus_mu = 1.9066f;
+				static const float s_u[14] = {
+					1.f / (1 * 3), 1.f / (2 * 5), 1.f / (3 * 7), 1.f / (4 * 9), 1.f / (5 * 11),
+					1.f / (6 * 13), 1.f / (7 * 15), 1.f / (8 * 17), 1.f / (9 * 19), 1.f / (10 * 21),
+					1.f / (11 * 23), 1.f / (12 * 25), 1.f / (13 * 27), s_one_plus_mu / (14 * 29) };
+				static const float s_v[14] = {
+					1.f / 3, 2.f / 5, 3.f / 7, 4.f / 9, 5.f / 11,
+					6.f / 13, 7.f / 15, 8.f / 17, 9.f / 19, 10.f / 21,
+					11.f / 23, 12.f / 25, 13.f / 27, s_one_plus_mu * 14 / 29 };
+
+#if defined(AYA_USE_SIMD)
+				__m128 x = dot(q).m_val128;
+				// take the shorter arc, the sign goes onto the coefficient of q
+				__m128 sign = _mm_and_ps(x, vMzeroMask);
+				x = _mm_xor_ps(x, sign);
+
+				__m128 xm1 = _mm_sub_ps(x, v1_0);
+				__m128 vt = t.m_val128;
+				__m128 vd = _mm_sub_ps(v1_0, vt);
+				__m128 sqr_t = _mm_mul_ps(vt, vt);
+				__m128 sqr_d = _mm_mul_ps(vd, vd);
+
+				__m128 c_t = v1_0, c_d = v1_0;
+				for (int i = 13; i >= 0; i--) {
+					__m128 u = _mm_set1_ps(s_u[i]), v = _mm_set1_ps(s_v[i]);
+					__m128 b_t = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u, sqr_t), v), xm1);
+					__m128 b_d = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u, sqr_d), v), xm1);
+					c_t = _mm_madd_ps(b_t, c_t, v1_0);
+					c_d = _mm_madd_ps(b_d, c_d, v1_0);
+				}
+				c_t = _mm_xor_ps(_mm_mul_ps(vt, c_t), sign);
+				c_d = _mm_mul_ps(vd, c_d);
+
+				Quaternionx4 ret;
+				for (int c = 0; c < 4; c++)
+					ret.m_val128[c] = _mm_madd_ps(m_val128[c], c_d, _mm_mul_ps(q.m_val128[c], c_t));
+				return ret;
+#else
+				QuadWord x = dot(q);
+				Quaternionx4 ret;
+				for (int i = 0; i < 4; i++) {
+					float sign = x[i] < 0.f ? -1.f : 1.f;
+					float xm1 = x[i] * sign - 1.f;
+					float d = 1.f - t[i];
+					float sqr_t = t[i] * t[i], sqr_d = d * d;
+
+					float c_t = 1.f, c_d = 1.f;
+					for (int k = 13; k >= 0; k--) {
+						c_t = 1.f + (s_u[k] * sqr_t - s_v[k]) * xm1 * c_t;
+						c_d = 1.f + (s_u[k] * sqr_d - s_v[k]) * xm1 * c_d;
+					}
+					c_t *= t[i] * sign;
+					c_d *= d;
+					for (int c = 0; c < 4; c++)
+						ret.m_val[c][i] = m_val[c][i] * c_d + q.m_val[c][i] * c_t;
+				}
+				return ret;
+#endif
+			}
+
+			// Per-lane nlerp towards q with t remapped by a cubic whose coefficient is fitted
+			// against the angle, so the angular velocity stays close to constant
+			AYA_FORCE_INLINE Quaternionx4 nlerp(const Quaternionx4 &q, const QuadWord &t) const {
+#if defined(AYA_USE_SIMD)
+				__m128 x = dot(q).m_val128;
+				__m128 sign = _mm_and_ps(x, vMzeroMask);
+				x = _mm_xor_ps(x, sign);
+
+				__m128 vt = t.m_val128;
+				__m128 a = _mm_madd_ps(x, _mm_set1_ps(-1.43519f), _mm_set1_ps(3.55645f));
+				a = _mm_madd_ps(x, a, _mm_set1_ps(-3.2452f));
+				a = _mm_madd_ps(x, a, _mm_set1_ps(1.0904f));
+				__m128 b = _mm_madd_ps(x, _mm_set1_ps(0.215638f), _mm_set1_ps(-1.06021f));
+				b = _mm_madd_ps(x, b, _mm_set1_ps(0.848013f));
+
+				__m128 th = _mm_sub_ps(vt, v0_5);
+				__m128 k = _mm_madd_ps(a, _mm_mul_ps(th, th), b);
+				__m128 ot = _mm_mul_ps(_mm_mul_ps(vt, th), _mm_sub_ps(vt, v1_0));
+				ot = _mm_madd_ps(ot, k, vt);
+
+				__m128 c_t = _mm_xor_ps(ot, sign);
+				__m128 c_d = _mm_sub_ps(v1_0, ot);
+				Quaternionx4 ret;
+				for (int c = 0; c < 4; c++)
+					ret.m_val128[c] = _mm_madd_ps(m_val128[c], c_d, _mm_mul_ps(q.m_val128[c], c_t));
+				return ret.normalize();
+#else
+				QuadWord x = dot(q);
+				Quaternionx4 ret;
+				for (int i = 0; i < 4; i++) {
+					float sign = x[i] < 0.f ? -1.f : 1.f;
+					float d = x[i] * sign;
+					float a = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+					float b = 0.848013f + d * (-1.06021f + d * 0.215638f);
+					float th = t[i] - .5f;
+					float ot = t[i] + t[i] * th * (t[i] - 1.f) * (a * th * th + b);
+					for (int c = 0; c < 4; c++)
+						ret.m_val[c][i] = m_val[c][i] * (1.f - ot) + q.m_val[c][i] * ot * sign;
+				}
+				return ret.normalize();
+#endif
+			}
+
+			AYA_FORCE_INLINE Quaternionx4 interpolate(const Quaternionx4 &q, const QuadWord &t, const SlerpMode &mode) const {
+				return mode == SLERP_EXACT ? slerp(q, t) : nlerp(q, t);
+			}
+
+			// out[i] = q0[i] slerped towards q1[i] at t[i], out may alias q0 or q1. Large arrays
+			// are split across threads.
+			static void interpolate(const Quaternion *q0, const Quaternion *q1, const float *t,
+				Quaternion *out, const size_t &n, const SlerpMode &mode = SLERP_EXACT) {
+				ParallelFor(n, s_parallel_grain, [=](const size_t &begin, const size_t &end) {
+					interpolateRange(q0 + begin, q1 + begin, t + begin, out + begin, end - begin, mode);
+				});
+			}
+			static void interpolateRange(const Quaternion *q0, const Quaternion *q1, const float *t,
+				Quaternion *out, const size_t &n, const SlerpMode &mode) {
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+#if defined(AYA_USE_SIMD)
+					QuadWord vt(_mm_loadu_ps(t + i));
+#else
+					QuadWord vt(t[i], t[i + 1], t[i + 2], t[i + 3]);
+#endif
+					load(q0 + i).interpolate(load(q1 + i), vt, mode).store(out + i);
+				}
+				if (i < n) {
+					Quaternion buf0[4], buf1[4];
+					QuadWord vt;
+					for (size_t k = 0; k < 4; k++) {
+						size_t j = i + Min(k, n - i - 1);
+						buf0[k] = q0[j];
+						buf1[k] = q1[j];
+						vt[int(k)] = t[j];
+					}
+					load(buf0).interpolate(load(buf1), vt, mode).store(buf0);
+					for (size_t k = 0; i + k < n; k++)
+						out[i + k] = buf0[k];
+				}
+			}
+
+			friend inline std::ostream &operator<<(std::ostream &os, const Quaternionx4 &q) {
+				os << "[" << q.getQuaternion(0) << ",\n";
+				os << " " << q.getQuaternion(1) << ",\n";
+				os << " " << q.getQuaternion(2) << ",\n";
+				os << " " << q.getQuaternion(3) << "]";
+				return os;
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,508 @@
+#ifndef AYA_MATH_SIMDMATH_H
+#define AYA_MATH_SIMDMATH_H
+
+#include "MathUtility.h"
+
+#include <string.h>
+
+namespace Aya {
+	// Transcendental functions on 1, 4 (__m128) and 8 (__m256, AVX builds) lanes. Every kernel
+	// is written once over the lane type, the float overloads run it on one SSE lane (or on a
+	// plain float without SIMD), so scalar and packet results agree bit for bit.
+	//
+	// Maximum error against double precision libm, sampled over the range:
+	//
+	//   sincos       |x| <= 100        1.6 ulp       sincosFast   |x| <= 8192   1.4e-6 abs
+	//                |x| <= 8192       2.4 ulp
+	//   atan2        finite x, y       3.2 ulp       atan2Fast    finite x, y   1.2e-5 rad
+	//   asin, acos   [-1, 1]           2.4 ulp       asinFast, acosFast         3.9e-5 rad
+	//   exp          [-88.7, 88.7]     1.3 ulp       expFast      [-87.3, 88.7] 5.5e-6 rel
+	//   log          (0, inf)          1 ulp         logFast      (0, inf)      2.9e-5 abs
+	//
+	// Past 8192 the pi/2 reduction of sincos degrades slowly (1e-6 abs at 1e5). exp is 0 below
+	// -103.9 and inf above 88.7, log is -inf at 0 and NaN below, atan2(0, 0) is 0.
+	class SimdMath {
+	public:
+		// Constant evaluation falls back to the Taylor series of MathUtility, so the constexpr
+		// Transform builders can use it
+		static AYA_FORCE_INLINE AYA_CONSTEXPR void sincos(const float &x, float *s, float *c) {
+			if (AYA_CONSTANT_EVALUATED()) {
+				*s = Sin(x);
+				*c = Cos(x);
+				return;
+			}
+			Scalar ls, lc;
+			sincosKernel<false>(toScalar(x), &ls, &lc);
+			*s = fromScalar(ls);
+			*c = fromScalar(lc);
+		}
+		static AYA_FORCE_INLINE void sincosFast(const float &x, float *s, float *c) {
+			Scalar ls, lc;
+			sincosKernel<true>(toScalar(x), &ls, &lc);
+			*s = fromScalar(ls);
+			*c = fromScalar(lc);
+		}
+		// n angles in packets of 4, a partial packet goes through a padded copy
+		static AYA_FORCE_INLINE void sincos(const float *x, float *s, float *c, const size_t &n) {
+			size_t i = 0;
+#if defined(AYA_USE_SIMD)
+			for (; i + 4 <= n; i += 4) {
+				__m128 ls, lc;
+				sincosKernel<false>(_mm_loadu_ps(x + i), &ls, &lc);
+				_mm_storeu_ps(s + i, ls);
+				_mm_storeu_ps(c + i, lc);
+			}
+			if (i < n) {
+				AYA_ALIGN(16) float xt[4] = { 0.f, 0.f, 0.f, 0.f }, st[4], ct[4];
+				for (size_t k = i; k < n; k++)
+					xt[k - i] = x[k];
+				__m128 ls, lc;
+				sincosKernel<false>(_mm_load_ps(xt), &ls, &lc);
+				_mm_store_ps(st, ls);
+				_mm_store_ps(ct, lc);
+				for (size_t k = i; k < n; k++) {
+					s[k] = st[k - i];
+					c[k] = ct[k - i];
+				}
+			}
+#else
+			for (; i < n; i++)
+				sincos(x[i], s + i, c + i);
+#endif
+		}
+		static AYA_FORCE_INLINE float atan2(const float &y, const float &x) {
+			return fromScalar(atan2Kernel<false>(toScalar(y), toScalar(x)));
+		}
+		static AYA_FORCE_INLINE float atan2Fast(const float &y, const float &x) {
+			return fromScalar(atan2Kernel<true>(toScalar(y), toScalar(x)));
+		}
+		static AYA_FORCE_INLINE float asin(const float &x) {
+			return fromScalar(asinKernel(toScalar(x)));
+		}
+		static AYA_FORCE_INLINE float asinFast(const float &x) {
+			return fromScalar(asinFastKernel(toScalar(x)));
+		}
+		static AYA_FORCE_INLINE float acos(const float &x) {
+			return fromScalar(acosKernel(toScalar(x)));
+		}
+		static AYA_FORCE_INLINE float acosFast(const float &x) {
+			return fromScalar(acosFastKernel(toScalar(x)));
+		}
+		static AYA_FORCE_INLINE float exp(const float &x) {
+			return fromScalar(expKernel<false>(toScalar(x)));
+		}
+		static AYA_FORCE_INLINE float expFast(const float &x) {
+			return fromScalar(expKernel<true>(toScalar(x)));
+		}
+		static AYA_FORCE_INLINE float log(const float &x) {
+			return fromScalar(logKernel<false>(toScalar(x)));
+		}
+		static AYA_FORCE_INLINE float logFast(const float &x) {
+			return fromScalar(logKernel<true>(toScalar(x)));
+		}
+
+#if defined(AYA_USE_SIMD)
+		static AYA_FORCE_INLINE void sincos(const __m128 &x, __m128 *s, __m128 *c) {
+			sincosKernel<false>(x, s, c);
+		}
+		static AYA_FORCE_INLINE void sincosFast(const __m128 &x, __m128 *s, __m128 *c) {
+			sincosKernel<true>(x, s, c);
+		}
+		static AYA_FORCE_INLINE __m128 atan2(const __m128 &y, const __m128 &x) {
+			return atan2Kernel<false>(y, x);
+		}
+		static AYA_FORCE_INLINE __m128 atan2Fast(const __m128 &y, const __m128 &x) {
+			return atan2Kernel<true>(y, x);
+		}
+		static AYA_FORCE_INLINE __m128 asin(const __m128 &x) {
+			return asinKernel(x);
+		}
+		static AYA_FORCE_INLINE __m128 asinFast(const __m128 &x) {
+			return asinFastKernel(x);
+		}
+		static AYA_FORCE_INLINE __m128 acos(const __m128 &x) {
+			return acosKernel(x);
+		}
+		static AYA_FORCE_INLINE __m128 acosFast(const __m128 &x) {
+			return acosFastKernel(x);
+		}
+		static AYA_FORCE_INLINE __m128 exp(const __m128 &x) {
+			return expKernel<false>(x);
+		}
+		static AYA_FORCE_INLINE __m128 expFast(const __m128 &x) {
+			return expKernel<true>(x);
+		}
+		static AYA_FORCE_INLINE __m128 log(const __m128 &x) {
+			return logKernel<false>(x);
+		}
+		static AYA_FORCE_INLINE __m128 logFast(const __m128 &x) {
+			return logKernel<true>(x);
+		}
+#endif
+
+#if defined(AYA_USE_AVX)
+		static AYA_FORCE_INLINE void sincos(const __m256 &x, __m256 *s, __m256 *c) {
+			sincosKernel<false>(x, s, c);
+		}
+		static AYA_FORCE_INLINE void sincosFast(const __m256 &x, __m256 *s, __m256 *c) {
+			sincosKernel<true>(x, s, c);
+		}
+		static AYA_FORCE_INLINE __m256 atan2(const __m256 &y, const __m256 &x) {
+			return atan2Kernel<false>(y, x);
+		}
+		static AYA_FORCE_INLINE __m256 atan2Fast(const __m256 &y, const __m256 &x) {
+			return atan2Kernel<true>(y, x);
+		}
+		static AYA_FORCE_INLINE __m256 asin(const __m256 &x) {
+			return asinKernel(x);
+		}
+		static AYA_FORCE_INLINE __m256 asinFast(const __m256 &x) {
+			return asinFastKernel(x);
+		}
+		static AYA_FORCE_INLINE __m256 acos(const __m256 &x) {
+			return acosKernel(x);
+		}
+		static AYA_FORCE_INLINE __m256 acosFast(const __m256 &x) {
+			return acosFastKernel(x);
+		}
+		static AYA_FORCE_INLINE __m256 exp(const __m256 &x) {
+			return expKernel<false>(x);
+		}
+		static AYA_FORCE_INLINE __m256 expFast(const __m256 &x) {
+			return expKernel<true>(x);
+		}
+		static AYA_FORCE_INLINE __m256 log(const __m256 &x) {
+			return logKernel<false>(x);
+		}
+		static AYA_FORCE_INLINE __m256 logFast(const __m256 &x) {
+			return logKernel<true>(x);
+		}
+#endif
+
+	private:
+		// Cody-Waite reduction by pi/2, quadrant q, then the sin and cos polynomials on
+		// [-pi/4, pi/4] (Cephes sinf/cosf, shortened for the fast variant)
+		template<bool Fast, class V>
+		static AYA_FORCE_INLINE void sincosKernel(const V &x, V *s, V *c) {
+			const V one = splat(x, 1.f);
+			const V q = roundInt(mul(x, splat(x, float(M_2_PI))));
+			V r;
+			if (Fast) {
+				r = madd(q, splat(x, -1.5703125f), x);
+				r = madd(q, splat(x, -4.83826792e-4f), r);
+			}
+			else {
+				// the first three parts have 11 bits or less, so q * part is exact for q < 2^13 and
+				// the subtractions cancel exactly near the zeros of sin and cos
+				r = madd(q, splat(x, -1.5703125f), x);
+				r = madd(q, splat(x, -4.837512969970703125e-4f), r);
+				r = madd(q, splat(x, -7.54953362047672271728515625e-8f), r);
+				r = madd(q, splat(x, -2.5633440682570896e-12f), r);
+			}
+			const V r2 = mul(r, r);
+
+			V ps, pc;
+			if (Fast) {
+				ps = madd(splat(x, 8.16328172e-3f), r2, splat(x, -1.66633904e-1f));
+				pc = madd(splat(x, -1.36524497e-3f), r2, splat(x, 4.16612774e-2f));
+			}
+			else {
+				ps = madd(madd(splat(x, -1.9515295891e-4f), r2, splat(x, 8.3321608736e-3f)), r2, splat(x, -1.6666654611e-1f));
+				pc = madd(madd(splat(x, 2.443315711809948e-5f), r2, splat(x, -1.388731625493765e-3f)), r2, splat(x, 4.166664568298827e-2f));
+			}
+			ps = madd(mul(ps, r2), r, r);
+			pc = madd(mul(pc, r2), r2, madd(r2, splat(x, -.5f), one));
+
+			// odd quadrants swap sin and cos, sin is negative in quadrants 2 and 3, cos in 1 and 2
+			const V zero = splat(x, 0.f);
+			const V q_bits = intToBits(q);
+			const V swap = cmpNeq(bitsToInt(bitAnd(q_bits, splatBits(x, 1))), zero);
+			const V sin_neg = cmpNeq(bitsToInt(bitAnd(q_bits, splatBits(x, 2))), zero);
+			const V cos_neg = cmpNeq(bitsToInt(bitAnd(intToBits(add(q, one)), splatBits(x, 2))), zero);
+			const V sign = splatBits(x, 0x80000000u);
+			*s = bitXor(select(swap, pc, ps), bitAnd(sin_neg, sign));
+			*c = bitXor(select(swap, ps, pc), bitAnd(cos_neg, sign));
+		}
+
+		// atan of min(|x|, |y|) / max(|x|, |y|) in [0, 1], mirrored into the right octant. The full
+		// variant reduces once more by pi/4 above tan(pi/8) (Cephes atanf).
+		template<bool Fast, class V>
+		static AYA_FORCE_INLINE V atan2Kernel(const V &y, const V &x) {
+			const V zero = splat(x, 0.f);
+			const V one = splat(x, 1.f);
+			const V ax = abs(x), ay = abs(y);
+			const V hi = max(ax, ay);
+			const V a = select(cmpEq(hi, zero), zero, div(min(ax, ay), hi));
+
+			V r;
+			if (Fast) {
+				const V z = mul(a, a);
+				V p = madd(splat(x, 2.08451133e-2f), z, splat(x, -8.51563513e-2f));
+				p = madd(p, z, splat(x, 1.80159301e-1f));
+				p = madd(p, z, splat(x, -3.30304772e-1f));
+				p = madd(p, z, splat(x, 9.99866307e-1f));
+				r = mul(p, a);
+			}
+			else {
+				const V big = cmpGt(a, splat(x, 0.414213562373095f));
+				const V t = select(big, div(sub(a, one), add(a, one)), a);
+				const V z = mul(t, t);
+				V p = madd(splat(x, 8.05374449538e-2f), z, splat(x, -1.38776856032e-1f));
+				p = madd(p, z, splat(x, 1.99777106478e-1f));
+				p = madd(p, z, splat(x, -3.33329491539e-1f));
+				r = add(madd(mul(p, z), t, t), bitAnd(big, splat(x, float(M_PI_4))));
+			}
+			r = select(cmpGt(ay, ax), sub(splat(x, float(M_PI_2)), r), r);
+			r = select(cmpLt(x, zero), sub(splat(x, float(M_PI)), r), r);
+			return bitOr(r, bitAnd(y, splatBits(x, 0x80000000u)));
+		}
+
+		// asin(s) for the Cephes asinf split: s = |x| below 0.5, s = sqrt((1 - |x|) / 2) above
+		template<class V>
+		static AYA_FORCE_INLINE V asinCore(const V &x, V *big) {
+			const V a = abs(x);
+			*big = cmpGt(a, splat(x, .5f));
+			const V z = select(*big, mul(splat(x, .5f), sub(splat(x, 1.f), a)), mul(a, a));
+			const V s = select(*big, sqrt(z), a);
+			V p = madd(splat(x, 4.2163199048e-2f), z, splat(x, 2.4181311049e-2f));
+			p = madd(p, z, splat(x, 4.5470025998e-2f));
+			p = madd(p, z, splat(x, 7.4953002686e-2f));
+			p = madd(p, z, splat(x, 1.6666752422e-1f));
+			return madd(mul(p, z), s, s);
+		}
+		template<class V>
+		static AYA_FORCE_INLINE V asinKernel(const V &x) {
+			V big;
+			const V p = asinCore(x, &big);
+			const V r = select(big, madd(p, splat(x, -2.f), splat(x, float(M_PI_2))), p);
+			return bitOr(r, bitAnd(x, splatBits(x, 0x80000000u)));
+		}
+		template<class V>
+		static AYA_FORCE_INLINE V acosKernel(const V &x) {
+			V big;
+			const V p = asinCore(x, &big);
+			const V sign = bitAnd(x, splatBits(x, 0x80000000u));
+			// above 0.5 acos(|x|) = 2 asin(s), mirrored to pi - 2 asin(s) for negative x
+			const V two_p = add(p, p);
+			const V r_big = select(cmpLt(x, splat(x, 0.f)), sub(splat(x, float(M_PI)), two_p), two_p);
+			return select(big, r_big, sub(splat(x, float(M_PI_2)), bitOr(p, sign)));
+		}
+
+		// acos(|x|) ~ sqrt(1 - |x|) * p(|x|) (Abramowitz and Stegun 4.4.45, refitted)
+		template<class V>
+		static AYA_FORCE_INLINE V acosFastCore(const V &a) {
+			V p = madd(splat(a, -2.08920296e-2f), a, splat(a, 7.68973753e-2f));
+			p = madd(p, a, splat(a, -2.12875187e-1f));
+			p = madd(p, a, splat(a, 1.57075834f));
+			return mul(p, sqrt(sub(splat(a, 1.f), a)));
+		}
+		template<class V>
+		static AYA_FORCE_INLINE V acosFastKernel(const V &x) {
+			const V r = acosFastCore(abs(x));
+			return select(cmpLt(x, splat(x, 0.f)), sub(splat(x, float(M_PI)), r), r);
+		}
+		template<class V>
+		static AYA_FORCE_INLINE V asinFastKernel(const V &x) {
+			const V r = sub(splat(x, float(M_PI_2)), acosFastCore(abs(x)));
+			return bitOr(r, bitAnd(x, splatBits(x, 0x80000000u)));
+		}
+
+		// e^x = 2^n e^r with |r| <= ln2 / 2. 2^n is applied in two halves, so n may run from
+		// -150 to 128 and the result rounds once, into the denormals or to inf.
+		template<bool Fast, class V>
+		static AYA_FORCE_INLINE V expKernel(const V &x) {
+			const V one = splat(x, 1.f);
+			const V xc = max(splat(x, -104.f), min(splat(x, 89.f), x));
+			const V n = roundInt(mul(xc, splat(x, float(M_LOG2E))));
+			V r = madd(n, splat(x, -0.693359375f), xc);
+			r = madd(n, splat(x, 2.12194440e-4f), r);
+
+			V p;
+			if (Fast) {
+				p = madd(splat(x, 4.12777476e-2f), r, splat(x, 1.67535141e-1f));
+				p = madd(p, r, splat(x, 5.00051141e-1f));
+			}
+			else {
+				p = madd(splat(x, 1.9875691500e-4f), r, splat(x, 1.3981999507e-3f));
+				p = madd(p, r, splat(x, 8.3334519073e-3f));
+				p = madd(p, r, splat(x, 4.1665795894e-2f));
+				p = madd(p, r, splat(x, 1.6666665459e-1f));
+				p = madd(p, r, splat(x, 5.0000001201e-1f));
+			}
+			p = madd(mul(p, r), r, add(r, one));
+
+			const V n0 = roundInt(mul(n, splat(x, .5f)));
+			return mul(mul(p, pow2(n0)), pow2(sub(n, n0)));
+		}
+
+		// x = 2^e (1 + m) with m in [sqrt(1/2) - 1, sqrt(2) - 1], log(1 + m) by the Cephes logf
+		// polynomial or a short fit of it. Denormals are scaled up by 2^23 first.
+		template<bool Fast, class V>
+		static AYA_FORCE_INLINE V logKernel(const V &x) {
+			const V one = splat(x, 1.f);
+			const V tiny = cmpLt(x, splat(x, FLT_MIN));
+			const V xs = select(tiny, mul(x, splat(x, 8388608.f)), x);
+			V e = madd(bitsToInt(bitAnd(xs, splatBits(x, 0x7f800000u))), splat(x, 1.f / 8388608.f), splat(x, -126.f));
+			e = sub(e, bitAnd(tiny, splat(x, 23.f)));
+			V m = bitOr(bitAnd(xs, splatBits(x, 0x007fffffu)), splatBits(x, 0x3f000000u));
+			const V small = cmpLt(m, splat(x, float(M_SQRT1_2)));
+			e = sub(e, bitAnd(small, one));
+			m = sub(add(m, bitAnd(small, m)), one);
+			const V z = mul(m, m);
+
+			V p;
+			if (Fast) {
+				p = madd(splat(x, 1.71886221e-1f), m, splat(x, -2.64970094e-1f));
+				p = madd(p, m, splat(x, 3.35958839e-1f));
+			}
+			else {
+				p = madd(splat(x, 7.0376836292e-2f), m, splat(x, -1.1514610310e-1f));
+				p = madd(p, m, splat(x, 1.1676998740e-1f));
+				p = madd(p, m, splat(x, -1.2420140846e-1f));
+				p = madd(p, m, splat(x, 1.4249322787e-1f));
+				p = madd(p, m, splat(x, -1.6668057665e-1f));
+				p = madd(p, m, splat(x, 2.0000714765e-1f));
+				p = madd(p, m, splat(x, -2.4999993993e-1f));
+				p = madd(p, m, splat(x, 3.3333331174e-1f));
+			}
+			V y = mul(mul(p, m), z);
+			y = madd(e, splat(x, -2.12194440e-4f), y);
+			y = madd(z, splat(x, -.5f), y);
+			V r = madd(e, splat(x, 0.693359375f), add(m, y));
+
+			const V inf = splatBits(x, 0x7f800000u);
+			r = select(cmpEq(x, inf), inf, r);
+			r = select(cmpEq(x, splat(x, 0.f)), splatBits(x, 0xff800000u), r);
+			// negative and NaN inputs
+			return select(cmpGe(x, splat(x, 0.f)), r, splatBits(x, 0x7fc00000u));
+		}
+
+		// 2^n for integral n in [-126, 127], built straight from the exponent bits
+		template<class V>
+		static AYA_FORCE_INLINE V pow2(const V &n) {
+			return intToBits(mul(add(n, splat(n, 127.f)), splat(n, 8388608.f)));
+		}
+
+	public:
+		// Lane primitives, shared with the batched kernels built on SimdMath (DirectionMap, ...).
+		// Scalar is the single lane type of the float overloads. Masks are all-ones or all-zero
+		// lanes as in SSE, integer bit patterns travel through intToBits / bitsToInt, so no
+		// 256-bit integer instructions are needed.
+#if defined(AYA_USE_SIMD)
+		typedef __m128 Scalar;
+		static AYA_FORCE_INLINE __m128 toScalar(const float &x) { return _mm_set_ss(x); }
+		static AYA_FORCE_INLINE float fromScalar(const __m128 &x) { return _mm_cvtss_f32(x); }
+
+		static AYA_FORCE_INLINE __m128 splat(const __m128 &, const float &v) { return _mm_set1_ps(v); }
+		static AYA_FORCE_INLINE __m128 splatBits(const __m128 &, const uint32_t &b) { return _mm_castsi128_ps(_mm_set1_epi32(int(b))); }
+		static AYA_FORCE_INLINE __m128 add(const __m128 &a, const __m128 &b) { return _mm_add_ps(a, b); }
+		static AYA_FORCE_INLINE __m128 sub(const __m128 &a, const __m128 &b) { return _mm_sub_ps(a, b); }
+		static AYA_FORCE_INLINE __m128 mul(const __m128 &a, const __m128 &b) { return _mm_mul_ps(a, b); }
+		static AYA_FORCE_INLINE __m128 div(const __m128 &a, const __m128 &b) { return _mm_div_ps(a, b); }
+		static AYA_FORCE_INLINE __m128 madd(const __m128 &a, const __m128 &b, const __m128 &c) {
+#if defined(AYA_USE_FMA)
+			return _mm_fmadd_ps(a, b, c);
+#else
+			return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+		}
+		static AYA_FORCE_INLINE __m128 min(const __m128 &a, const __m128 &b) { return _mm_min_ps(a, b); }
+		static AYA_FORCE_INLINE __m128 max(const __m128 &a, const __m128 &b) { return _mm_max_ps(a, b); }
+		static AYA_FORCE_INLINE __m128 sqrt(const __m128 &a) { return _mm_sqrt_ps(a); }
+		static AYA_FORCE_INLINE __m128 abs(const __m128 &a) { return _mm_and_ps(a, splatBits(a, 0x7fffffffu)); }
+		static AYA_FORCE_INLINE __m128 bitAnd(const __m128 &a, const __m128 &b) { return _mm_and_ps(a, b); }
+		static AYA_FORCE_INLINE __m128 bitOr(const __m128 &a, const __m128 &b) { return _mm_or_ps(a, b); }
+		static AYA_FORCE_INLINE __m128 bitXor(const __m128 &a, const __m128 &b) { return _mm_xor_ps(a, b); }
+		static AYA_FORCE_INLINE __m128 bitAndNot(const __m128 &a, const __m128 &b) { return _mm_andnot_ps(a, b); }
+		static AYA_FORCE_INLINE __m128 select(const __m128 &m, const __m128 &a, const __m128 &b) {
+			return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+		}
+		static AYA_FORCE_INLINE __m128 cmpEq(const __m128 &a, const __m128 &b) { return _mm_cmpeq_ps(a, b); }
+		static AYA_FORCE_INLINE __m128 cmpNeq(const __m128 &a, const __m128 &b) { return _mm_cmpneq_ps(a, b); }
+		static AYA_FORCE_INLINE __m128 cmpLt(const __m128 &a, const __m128 &b) { return _mm_cmplt_ps(a, b); }
+		static AYA_FORCE_INLINE __m128 cmpGt(const __m128 &a, const __m128 &b) { return _mm_cmpgt_ps(a, b); }
+		static AYA_FORCE_INLINE __m128 cmpGe(const __m128 &a, const __m128 &b) { return _mm_cmpge_ps(a, b); }
+		// nearest integer, as a float
+		static AYA_FORCE_INLINE __m128 roundInt(const __m128 &a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }
+		// integral float -> lane with that integer as its bit pattern, and back
+		static AYA_FORCE_INLINE __m128 intToBits(const __m128 &a) { return _mm_castsi128_ps(_mm_cvtps_epi32(a)); }
+		static AYA_FORCE_INLINE __m128 bitsToInt(const __m128 &a) { return _mm_cvtepi32_ps(_mm_castps_si128(a)); }
+#else
+		typedef float Scalar;
+		static AYA_FORCE_INLINE float toScalar(const float &x) { return x; }
+		static AYA_FORCE_INLINE float fromScalar(const float &x) { return x; }
+
+		static AYA_FORCE_INLINE float splat(const float &, const float &v) { return v; }
+		static AYA_FORCE_INLINE float splatBits(const float &, const uint32_t &b) { return asFloat(b); }
+		static AYA_FORCE_INLINE float add(const float &a, const float &b) { return a + b; }
+		static AYA_FORCE_INLINE float sub(const float &a, const float &b) { return a - b; }
+		static AYA_FORCE_INLINE float mul(const float &a, const float &b) { return a * b; }
+		static AYA_FORCE_INLINE float div(const float &a, const float &b) { return a / b; }
+		static AYA_FORCE_INLINE float madd(const float &a, const float &b, const float &c) { return a * b + c; }
+		static AYA_FORCE_INLINE float min(const float &a, const float &b) { return a < b ? a : b; }
+		static AYA_FORCE_INLINE float max(const float &a, const float &b) { return a > b ? a : b; }
+		static AYA_FORCE_INLINE float sqrt(const float &a) { return sqrtf(a); }
+		static AYA_FORCE_INLINE float abs(const float &a) { return fabsf(a); }
+		static AYA_FORCE_INLINE float bitAnd(const float &a, const float &b) { return asFloat(asBits(a) & asBits(b)); }
+		static AYA_FORCE_INLINE float bitOr(const float &a, const float &b) { return asFloat(asBits(a) | asBits(b)); }
+		static AYA_FORCE_INLINE float bitXor(const float &a, const float &b) { return asFloat(asBits(a) ^ asBits(b)); }
+		static AYA_FORCE_INLINE float bitAndNot(const float &a, const float &b) { return asFloat(~asBits(a) & asBits(b)); }
+		static AYA_FORCE_INLINE float select(const float &m, const float &a, const float &b) { return asBits(m) ? a : b; }
+		static AYA_FORCE_INLINE float cmpEq(const float &a, const float &b) { return mask(a == b); }
+		static AYA_FORCE_INLINE float cmpNeq(const float &a, const float &b) { return mask(a != b); }
+		static AYA_FORCE_INLINE float cmpLt(const float &a, const float &b) { return mask(a < b); }
+		static AYA_FORCE_INLINE float cmpGt(const float &a, const float &b) { return mask(a > b); }
+		static AYA_FORCE_INLINE float cmpGe(const float &a, const float &b) { return mask(a >= b); }
+		static AYA_FORCE_INLINE float roundInt(const float &a) { return nearbyintf(a); }
+		static AYA_FORCE_INLINE float intToBits(const float &a) { return asFloat(uint32_t(int32_t(a))); }
+		static AYA_FORCE_INLINE float bitsToInt(const float &a) { return float(int32_t(asBits(a))); }
+
+		static AYA_FORCE_INLINE uint32_t asBits(const float &a) {
+			uint32_t b;
+			memcpy(&b, &a, sizeof(b));
+			return b;
+		}
+		static AYA_FORCE_INLINE float asFloat(const uint32_t &b) {
+			float a;
+			memcpy(&a, &b, sizeof(a));
+			return a;
+		}
+		static AYA_FORCE_INLINE float mask(const bool &b) { return asFloat(b ? 0xffffffffu : 0u); }
+#endif
+
+#if defined(AYA_USE_AVX)
+		static AYA_FORCE_INLINE __m256 splat(const __m256 &, const float &v) { return _mm256_set1_ps(v); }
+		static AYA_FORCE_INLINE __m256 splatBits(const __m256 &, const uint32_t &b) { return _mm256_castsi256_ps(_mm256_set1_epi32(int(b))); }
+		static AYA_FORCE_INLINE __m256 add(const __m256 &a, const __m256 &b) { return _mm256_add_ps(a, b); }
+		static AYA_FORCE_INLINE __m256 sub(const __m256 &a, const __m256 &b) { return _mm256_sub_ps(a, b); }
+		static AYA_FORCE_INLINE __m256 mul(const __m256 &a, const __m256 &b) { return _mm256_mul_ps(a, b); }
+		static AYA_FORCE_INLINE __m256 div(const __m256 &a, const __m256 &b) { return _mm256_div_ps(a, b); }
+		static AYA_FORCE_INLINE __m256 madd(const __m256 &a, const __m256 &b, const __m256 &c) {
+#if defined(AYA_USE_FMA)
+			return _mm256_fmadd_ps(a, b, c);
+#else
+			return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+		}
+		static AYA_FORCE_INLINE __m256 min(const __m256 &a, const __m256 &b) { return _mm256_min_ps(a, b); }
+		static AYA_FORCE_INLINE __m256 max(const __m256 &a, const __m256 &b) { return _mm256_max_ps(a, b); }
+		static AYA_FORCE_INLINE __m256 sqrt(const __m256 &a) { return _mm256_sqrt_ps(a); }
+		static AYA_FORCE_INLINE __m256 abs(const __m256 &a) { return _mm256_and_ps(a, splatBits(a, 0x7fffffffu)); }
+		static AYA_FORCE_INLINE __m256 bitAnd(const __m256 &a, const __m256 &b) { return _mm256_and_ps(a, b); }
+		static AYA_FORCE_INLINE __m256 bitOr(const __m256 &a, const __m256 &b) { return _mm256_or_ps(a, b); }
+		static AYA_FORCE_INLINE __m256 bitXor(const __m256 &a, const __m256 &b) { return _mm256_xor_ps(a, b); }
+		static AYA_FORCE_INLINE __m256 bitAndNot(const __m256 &a, const __m256 &b) { return _mm256_andnot_ps(a, b); }
+		static AYA_FORCE_INLINE __m256 select(const __m256 &m, const __m256 &a, const __m256 &b) { return _mm256_blendv_ps(b, a, m); }
+		static AYA_FORCE_INLINE __m256 cmpEq(const __m256 &a, const __m256 &b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+		static AYA_FORCE_INLINE __m256 cmpNeq(const __m256 &a, const __m256 &b) { return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ); }
+		static AYA_FORCE_INLINE __m256 cmpLt(const __m256 &a, const __m256 &b) { return _mm256_cmp_ps(a, b, _CMP_LT_OS); }
+		static AYA_FORCE_INLINE __m256 cmpGt(const __m256 &a, const __m256 &b) { return _mm256_cmp_ps(a, b, _CMP_GT_OS); }
+		static AYA_FORCE_INLINE __m256 cmpGe(const __m256 &a, const __m256 &b) { return _mm256_cmp_ps(a, b, _CMP_GE_OS); }
+		static AYA_FORCE_INLINE __m256 roundInt(const __m256 &a) { return _mm256_cvtepi32_ps(_mm256_cvtps_epi32(a)); }
+		static AYA_FORCE_INLINE __m256 intToBits(const __m256 &a) { return _mm256_castsi256_ps(_mm256_cvtps_epi32(a)); }
+		static AYA_FORCE_INLINE __m256 bitsToInt(const __m256 &a) { return _mm256_cvtepi32_ps(_mm256_castps_si256(a)); }
+#endif
+	};
+}
+
+#endif
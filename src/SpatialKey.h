@@ -0,0 +1,329 @@
+#ifndef AYA_MATH_SPATIALKEY_H
+#define AYA_MATH_SPATIALKEY_H
+
+#include "BBox.h"
+#include "Vector3x4.h"
+#include "CpuFeatures.h"
+#include "Parallel.h"
+
+namespace Aya {
+	// Morton and Hilbert keys of points normalized into a BBox, for linear BVH builds and
+	// spatial reordering. Each axis is cut into 2^10 (30-bit keys) or 2^21 (63-bit keys) cells,
+	// points outside the box are clamped to the border cells. Bits are interleaved x, y, z from
+	// the top, so x holds the most significant bit of every triple.
+	//
+	// Arrays run 4 points per SSE2 packet, 30-bit keys go 8 wide when CpuFeatures reports AVX2,
+	// 63-bit Morton keys use PDEP where it is fast. Large arrays are split across threads.
+	class SpatialKey {
+	public:
+		Point3 m_min;
+		Vector3 m_inv_extent;	// 0 along flat axes
+
+		static const size_t s_parallel_grain = 1 << 16;
+
+	public:
+		SpatialKey() {}
+		explicit AYA_FORCE_INLINE SpatialKey(const BBox &bounds) {
+			m_min = bounds.m_pmin;
+			for (int a = 0; a < 3; a++) {
+				float extent = bounds.m_pmax[a] - bounds.m_pmin[a];
+				m_inv_extent[a] = extent > 0.f ? 1.f / extent : 0.f;
+			}
+		}
+
+		// Single point keys
+		AYA_FORCE_INLINE uint32_t morton30(const Point3 &p) const {
+			uint32_t q[3];
+			quantize(p, 10, q);
+			return encodeMorton30(q[0], q[1], q[2]);
+		}
+		AYA_FORCE_INLINE uint64_t morton63(const Point3 &p) const {
+			uint32_t q[3];
+			quantize(p, 21, q);
+			return encodeMorton63(q[0], q[1], q[2]);
+		}
+		AYA_FORCE_INLINE uint32_t hilbert30(const Point3 &p) const {
+			uint32_t q[3];
+			quantize(p, 10, q);
+			return encodeHilbert30(q[0], q[1], q[2]);
+		}
+		AYA_FORCE_INLINE uint64_t hilbert63(const Point3 &p) const {
+			uint32_t q[3];
+			quantize(p, 21, q);
+			return encodeHilbert63(q[0], q[1], q[2]);
+		}
+
+		// Batched keys of n points
+		void morton30(const Point3 *in, uint32_t *out, const size_t &n) const {
+			ParallelFor(n, s_parallel_grain, [this, in, out](const size_t &begin, const size_t &end) {
+				morton30Range(in + begin, out + begin, end - begin);
+			});
+		}
+		void morton63(const Point3 *in, uint64_t *out, const size_t &n) const {
+			ParallelFor(n, s_parallel_grain, [this, in, out](const size_t &begin, const size_t &end) {
+				morton63Range(in + begin, out + begin, end - begin);
+			});
+		}
+		void hilbert30(const Point3 *in, uint32_t *out, const size_t &n) const {
+			ParallelFor(n, s_parallel_grain, [this, in, out](const size_t &begin, const size_t &end) {
+				hilbert30Range(in + begin, out + begin, end - begin);
+			});
+		}
+		void hilbert63(const Point3 *in, uint64_t *out, const size_t &n) const {
+			ParallelFor(n, s_parallel_grain, [this, in, out](const size_t &begin, const size_t &end) {
+				hilbert63Range(in + begin, out + begin, end - begin);
+			});
+		}
+
+		// Interleaving of already quantized coordinates (10 or 21 bits each)
+		static AYA_FORCE_INLINE uint32_t encodeMorton30(const uint32_t &x, const uint32_t &y, const uint32_t &z) {
+			return (spread10(x) << 2) | (spread10(y) << 1) | spread10(z);
+		}
+		static AYA_FORCE_INLINE uint64_t encodeMorton63(const uint32_t &x, const uint32_t &y, const uint32_t &z) {
+			return (spread21(x) << 2) | (spread21(y) << 1) | spread21(z);
+		}
+		static AYA_FORCE_INLINE uint32_t encodeHilbert30(const uint32_t &x, const uint32_t &y, const uint32_t &z) {
+			uint32_t v[3] = { x, y, z };
+			hilbertTranspose(v, 10);
+			return encodeMorton30(v[0], v[1], v[2]);
+		}
+		static AYA_FORCE_INLINE uint64_t encodeHilbert63(const uint32_t &x, const uint32_t &y, const uint32_t &z) {
+			uint32_t v[3] = { x, y, z };
+			hilbertTranspose(v, 21);
+			return encodeMorton63(v[0], v[1], v[2]);
+		}
+
+	private:
+		AYA_FORCE_INLINE void quantize(const Point3 &p, const int &bits, uint32_t q[3]) const {
+			const float cells = float(1 << bits);
+			for (int a = 0; a < 3; a++) {
+				float c = (p[a] - m_min[a]) * (m_inv_extent[a] * cells);
+				// written so NaN takes the 0 branch, like max(c, 0) of the packet path
+				q[a] = uint32_t(c > 0.f ? Min(c, cells - 1.f) : 0.f);
+			}
+		}
+
+		static AYA_FORCE_INLINE uint32_t spread10(uint32_t x) {
+			x &= 0x3ff;
+			x = (x | (x << 16)) & 0x030000ff;
+			x = (x | (x << 8)) & 0x0300f00f;
+			x = (x | (x << 4)) & 0x030c30c3;
+			x = (x | (x << 2)) & 0x09249249;
+			return x;
+		}
+		static AYA_FORCE_INLINE uint64_t spread21(const uint32_t &v) {
+			uint64_t x = v & 0x1fffff;
+			x = (x | (x << 32)) & 0x001f00000000ffffull;
+			x = (x | (x << 16)) & 0x001f0000ff0000ffull;
+			x = (x | (x << 8)) & 0x100f00f00f00f00full;
+			x = (x | (x << 4)) & 0x10c30c30c30c30c3ull;
+			x = (x | (x << 2)) & 0x1249249249249249ull;
+			return x;
+		}
+
+		// Skilling's axes to transposed Hilbert index, "Programming the Hilbert curve" (2004).
+		// Interleaving the result gives the Hilbert key.
+		static AYA_FORCE_INLINE void hilbertTranspose(uint32_t v[3], const int &bits) {
+			const uint32_t top = 1u << (bits - 1);
+			for (uint32_t q = top; q > 1; q >>= 1) {
+				const uint32_t p = q - 1;
+				for (int i = 0; i < 3; i++) {
+					if (v[i] & q)
+						v[0] ^= p;
+					else {
+						uint32_t t = (v[0] ^ v[i]) & p;
+						v[0] ^= t;
+						v[i] ^= t;
+					}
+				}
+			}
+			v[1] ^= v[0];
+			v[2] ^= v[1];
+			uint32_t t = 0;
+			for (uint32_t q = top; q > 1; q >>= 1)
+				if (v[2] & q)
+					t ^= q - 1;
+			v[0] ^= t;
+			v[1] ^= t;
+			v[2] ^= t;
+		}
+
+		void morton30Range(const Point3 *in, uint32_t *out, const size_t &n) const {
+			size_t i = 0;
+#if defined(AYA_USE_SIMD)
+			if (CpuFeatures::getLevel() >= SIMD_AVX2)
+				i = morton30AVX2(in, out, n);
+			for (; i + 4 <= n; i += 4) {
+				__m128i q[3];
+				quantize4(in + i, 10, q);
+				_mm_storeu_si128((__m128i *)(out + i), interleave30(q));
+			}
+#endif
+			for (; i < n; i++)
+				out[i] = morton30(in[i]);
+		}
+		void morton63Range(const Point3 *in, uint64_t *out, const size_t &n) const {
+			size_t i = 0;
+#if defined(AYA_USE_SIMD)
+			if (CpuFeatures::getLevel() >= SIMD_AVX2 && CpuFeatures::hasFastPDEP())
+				i = morton63BMI2(in, out, n);
+			for (; i + 4 <= n; i += 4) {
+				__m128i q[3];
+				quantize4(in + i, 21, q);
+				interleave63(q, out + i);
+			}
+#endif
+			for (; i < n; i++)
+				out[i] = morton63(in[i]);
+		}
+		void hilbert30Range(const Point3 *in, uint32_t *out, const size_t &n) const {
+			size_t i = 0;
+#if defined(AYA_USE_SIMD)
+			for (; i + 4 <= n; i += 4) {
+				__m128i q[3];
+				quantize4(in + i, 10, q);
+				hilbertTranspose4(q, 10);
+				_mm_storeu_si128((__m128i *)(out + i), interleave30(q));
+			}
+#endif
+			for (; i < n; i++)
+				out[i] = hilbert30(in[i]);
+		}
+		void hilbert63Range(const Point3 *in, uint64_t *out, const size_t &n) const {
+			size_t i = 0;
+#if defined(AYA_USE_SIMD)
+			for (; i + 4 <= n; i += 4) {
+				__m128i q[3];
+				quantize4(in + i, 21, q);
+				hilbertTranspose4(q, 21);
+				interleave63(q, out + i);
+			}
+#endif
+			for (; i < n; i++)
+				out[i] = hilbert63(in[i]);
+		}
+
+#if defined(AYA_USE_SIMD)
+		// Cell coordinates of 4 points, one axis per register
+		AYA_FORCE_INLINE void quantize4(const Point3 *p, const int &bits, __m128i q[3]) const {
+			Vector3x4 v = Vector3x4::load(p);
+			const float cells = float(1 << bits);
+			const __m128 hi = _mm_set1_ps(cells - 1.f);
+			for (int a = 0; a < 3; a++) {
+				__m128 c = _mm_mul_ps(_mm_sub_ps(v.m_val128[a], _mm_set1_ps(m_min[a])),
+					_mm_set1_ps(m_inv_extent[a] * cells));
+				q[a] = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(c, _mm_setzero_ps()), hi));
+			}
+		}
+
+		static AYA_FORCE_INLINE __m128i spread10x4(__m128i x) {
+			x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi32(x, 16)), _mm_set1_epi32(0x030000ff));
+			x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi32(x, 8)), _mm_set1_epi32(0x0300f00f));
+			x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi32(x, 4)), _mm_set1_epi32(0x030c30c3));
+			x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi32(x, 2)), _mm_set1_epi32(0x09249249));
+			return x;
+		}
+		static AYA_FORCE_INLINE __m128i interleave30(const __m128i q[3]) {
+			return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(spread10x4(q[0]), 2),
+				_mm_slli_epi32(spread10x4(q[1]), 1)), spread10x4(q[2]));
+		}
+
+		// Two 21-bit coordinates held in the low halves of the 64-bit lanes
+		static AYA_FORCE_INLINE __m128i spread21x2(__m128i x) {
+			x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi64(x, 32)), _mm_set1_epi64x(0x001f00000000ffffll));
+			x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi64(x, 16)), _mm_set1_epi64x(0x001f0000ff0000ffll));
+			x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi64(x, 8)), _mm_set1_epi64x(0x100f00f00f00f00fll));
+			x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi64(x, 4)), _mm_set1_epi64x(0x10c30c30c30c30c3ll));
+			x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi64(x, 2)), _mm_set1_epi64x(0x1249249249249249ll));
+			return x;
+		}
+		static AYA_FORCE_INLINE void interleave63(const __m128i q[3], uint64_t *out) {
+			const __m128i zero = _mm_setzero_si128();
+			for (int h = 0; h < 2; h++) {
+				__m128i x = h ? _mm_unpackhi_epi32(q[0], zero) : _mm_unpacklo_epi32(q[0], zero);
+				__m128i y = h ? _mm_unpackhi_epi32(q[1], zero) : _mm_unpacklo_epi32(q[1], zero);
+				__m128i z = h ? _mm_unpackhi_epi32(q[2], zero) : _mm_unpacklo_epi32(q[2], zero);
+				__m128i k = _mm_or_si128(_mm_or_si128(_mm_slli_epi64(spread21x2(x), 2),
+					_mm_slli_epi64(spread21x2(y), 1)), spread21x2(z));
+				_mm_storeu_si128((__m128i *)(out + 2 * h), k);
+			}
+		}
+
+		// hilbertTranspose on 4 lanes, the branches become masks
+		static AYA_FORCE_INLINE void hilbertTranspose4(__m128i v[3], const int &bits) {
+			const uint32_t top = 1u << (bits - 1);
+			for (uint32_t q = top; q > 1; q >>= 1) {
+				const __m128i q4 = _mm_set1_epi32(q);
+				const __m128i p4 = _mm_set1_epi32(q - 1);
+				// i = 0 only ever inverts
+				v[0] = _mm_xor_si128(v[0], _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(v[0], q4), q4), p4));
+				for (int i = 1; i < 3; i++) {
+					__m128i set = _mm_cmpeq_epi32(_mm_and_si128(v[i], q4), q4);
+					__m128i t = _mm_andnot_si128(set, _mm_and_si128(_mm_xor_si128(v[0], v[i]), p4));
+					v[0] = _mm_xor_si128(v[0], _mm_xor_si128(_mm_and_si128(set, p4), t));
+					v[i] = _mm_xor_si128(v[i], t);
+				}
+			}
+			v[1] = _mm_xor_si128(v[1], v[0]);
+			v[2] = _mm_xor_si128(v[2], v[1]);
+			__m128i t = _mm_setzero_si128();
+			for (uint32_t q = top; q > 1; q >>= 1) {
+				const __m128i q4 = _mm_set1_epi32(q);
+				t = _mm_xor_si128(t, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(v[2], q4), q4),
+					_mm_set1_epi32(q - 1)));
+			}
+			v[0] = _mm_xor_si128(v[0], t);
+			v[1] = _mm_xor_si128(v[1], t);
+			v[2] = _mm_xor_si128(v[2], t);
+		}
+
+		// Runtime dispatched paths, each returns how many points it handled
+		AYA_TARGET_AVX2 size_t morton30AVX2(const Point3 *in, uint32_t *out, const size_t &n) const {
+			const __m256 hi = _mm256_set1_ps(1023.f);
+			__m256 lo[3], scale[3];
+			for (int a = 0; a < 3; a++) {
+				lo[a] = _mm256_set1_ps(m_min[a]);
+				scale[a] = _mm256_set1_ps(m_inv_extent[a] * 1024.f);
+			}
+			const __m256i m16 = _mm256_set1_epi32(0x030000ff), m8 = _mm256_set1_epi32(0x0300f00f);
+			const __m256i m4 = _mm256_set1_epi32(0x030c30c3), m2 = _mm256_set1_epi32(0x09249249);
+
+			size_t i = 0;
+			for (; i + 8 <= n; i += 8) {
+				Vector3x4 v0 = Vector3x4::load(in + i), v1 = Vector3x4::load(in + i + 4);
+				__m256i x[3];
+				for (int a = 0; a < 3; a++) {
+					__m256 v = _mm256_insertf128_ps(_mm256_castps128_ps256(v0.m_val128[a]), v1.m_val128[a], 1);
+					v = _mm256_mul_ps(_mm256_sub_ps(v, lo[a]), scale[a]);
+					x[a] = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), hi));
+					x[a] = _mm256_and_si256(_mm256_or_si256(x[a], _mm256_slli_epi32(x[a], 16)), m16);
+					x[a] = _mm256_and_si256(_mm256_or_si256(x[a], _mm256_slli_epi32(x[a], 8)), m8);
+					x[a] = _mm256_and_si256(_mm256_or_si256(x[a], _mm256_slli_epi32(x[a], 4)), m4);
+					x[a] = _mm256_and_si256(_mm256_or_si256(x[a], _mm256_slli_epi32(x[a], 2)), m2);
+				}
+				__m256i key = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(x[0], 2),
+					_mm256_slli_epi32(x[1], 1)), x[2]);
+				_mm256_storeu_si256((__m256i *)(out + i), key);
+			}
+			return i;
+		}
+		AYA_TARGET_BMI2 size_t morton63BMI2(const Point3 *in, uint64_t *out, const size_t &n) const {
+			size_t i = 0;
+			for (; i + 4 <= n; i += 4) {
+				__m128i q[3];
+				quantize4(in + i, 21, q);
+				AYA_ALIGN(16) uint32_t c[3][4];
+				for (int a = 0; a < 3; a++)
+					_mm_store_si128((__m128i *)c[a], q[a]);
+				for (int k = 0; k < 4; k++)
+					out[i + k] = _pdep_u64(c[0][k], 0x4924924924924924ull) |
+						_pdep_u64(c[1][k], 0x2492492492492492ull) |
+						_pdep_u64(c[2][k], 0x1249249249249249ull);
+			}
+			return i;
+		}
+#endif
+	};
+}
+
+#endif
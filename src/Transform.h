@@ -2,44 +2,426 @@
 #define AYA_MATH_TRANSFORM_H
 
 #include "BBox.h"
-#include "Mathutility.h"
+#include "MathUtility.h"
 #include "Matrix4x4.h"
 #include "Matrix3x3.h"
 #include "Quaternion.h"
+#include "Vector3x4.h"
+#include "CpuFeatures.h"
+#include "Parallel.h"
 
-#include "..\Core\Ray.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "../Core/Ray.h"
 
 namespace Aya {
+	// Coefficients of a batched 3D transform. Output component i is
+	// m_coef[i][0] * x + m_coef[i][1] * y + m_coef[i][2] * z + m_coef[i][3], row 3 gives the
+	// homogeneous w and is only used when m_projective is set. Arrays are transposed into
+	// Vector3x4 packets and run 4, 8 or 16 wide depending on CpuFeatures::getLevel(),
+	// large arrays are split across threads.
+	class TransformKernel {
+	public:
+		float m_coef[4][4];
+		bool m_projective;
+
+		static const size_t s_parallel_grain = 1 << 15;
+
+		TransformKernel() {}
+		AYA_FORCE_INLINE TransformKernel(const Matrix4x4 &m, const bool &translate) {
+			for (int i = 0; i < 4; i++) {
+				for (int j = 0; j < 3; j++)
+					m_coef[i][j] = m[i][j];
+				m_coef[i][3] = translate ? m[i][3] : 0.f;
+			}
+			m_projective = translate &&
+				(m[3][0] != 0.f || m[3][1] != 0.f || m[3][2] != 0.f || m[3][3] != 1.f);
+		}
+		AYA_FORCE_INLINE TransformKernel(const Matrix3x3 &m, const Vector3 &trans) {
+			for (int i = 0; i < 3; i++) {
+				for (int j = 0; j < 3; j++)
+					m_coef[i][j] = m[i][j];
+				m_coef[i][3] = trans[i];
+				m_coef[3][i] = 0.f;
+			}
+			m_coef[3][3] = 1.f;
+			m_projective = false;
+		}
+
+		// Kernels applying the inverse transpose, read straight from the columns of inv
+		static AYA_FORCE_INLINE TransformKernel normalKernel(const Matrix4x4 &inv) {
+			TransformKernel ret;
+			for (int i = 0; i < 4; i++) {
+				for (int j = 0; j < 3; j++)
+					ret.m_coef[i][j] = inv[j][i];
+				ret.m_coef[i][3] = 0.f;
+			}
+			ret.m_projective = false;
+			return ret;
+		}
+		static AYA_FORCE_INLINE TransformKernel normalKernel(const Matrix3x3 &inv) {
+			TransformKernel ret;
+			for (int i = 0; i < 3; i++) {
+				for (int j = 0; j < 3; j++)
+					ret.m_coef[i][j] = inv[j][i];
+				ret.m_coef[i][3] = 0.f;
+				ret.m_coef[3][i] = 0.f;
+			}
+			ret.m_coef[3][3] = 1.f;
+			ret.m_projective = false;
+			return ret;
+		}
+
+		// Identity transforms only move the data, nothing to do when in and out alias
+		template<class T>
+		static void copy(const T *in, T *out, const size_t &n) {
+			if (in != out)
+				std::copy(in, in + n, out);
+		}
+
+		template<class T>
+		void apply(const T *in, T *out, const size_t &n) const {
+			ParallelFor(n, s_parallel_grain, [this, in, out](const size_t &begin, const size_t &end) {
+				applyRange(in + begin, out + begin, end - begin);
+			});
+		}
+
+		template<class T>
+		void applyRange(const T *in, T *out, const size_t &n) const {
+			size_t i = 0;
+#if defined(AYA_USE_SIMD)
+			const SimdLevel level = CpuFeatures::getLevel();
+#if defined(AYA_USE_FMA)
+			// AVX-512 always has FMA and GCC contracts the separate mul and add into it, so
+			// the 16-wide kernel only matches the 4-wide rounding in FMA builds
+			if (level >= SIMD_AVX512)
+				i = applyAVX512(in, out, n);
+			else
+#endif
+			if (level >= SIMD_AVX2)
+				i = applyAVX2(in, out, n);
+
+			__m128 c4[4][4];
+			for (int r = 0; r < 4; r++)
+				for (int k = 0; k < 4; k++)
+					c4[r][k] = _mm_set1_ps(m_coef[r][k]);
+
+			auto packet = [&](const T *src, T *dst) {
+				Vector3x4 v = Vector3x4::load(src);
+				__m128 o[4];
+				for (int r = 0; r < (m_projective ? 4 : 3); r++)
+					o[r] = _mm_madd_ps(c4[r][0], v.m_val128[0],
+						_mm_madd_ps(c4[r][1], v.m_val128[1],
+							_mm_madd_ps(c4[r][2], v.m_val128[2], c4[r][3])));
+				if (m_projective) {
+					o[0] = _mm_div_ps(o[0], o[3]);
+					o[1] = _mm_div_ps(o[1], o[3]);
+					o[2] = _mm_div_ps(o[2], o[3]);
+				}
+				Vector3x4(o[0], o[1], o[2]).store(dst);
+			};
+			for (; i + 4 <= n; i += 4)
+				packet(in + i, out + i);
+			if (i < n) {
+				T buf[4];
+				for (size_t k = 0; k < 4; k++)
+					buf[k] = in[i + Min(k, n - i - 1)];
+				packet(buf, buf);
+				for (size_t k = 0; i + k < n; k++)
+					out[i + k] = buf[k];
+			}
+#else
+			for (; i < n; i++) {
+				const T &v = in[i];
+				float o[4];
+				for (int r = 0; r < (m_projective ? 4 : 3); r++)
+					o[r] = m_coef[r][0] * v.x() + m_coef[r][1] * v.y() + m_coef[r][2] * v.z() + m_coef[r][3];
+				if (m_projective) {
+					float inv = 1.f / o[3];
+					o[0] *= inv;
+					o[1] *= inv;
+					o[2] *= inv;
+				}
+				out[i] = T(o[0], o[1], o[2]);
+			}
+#endif
+		}
+
 #if defined(AYA_USE_SIMD)
-	__declspec(align(16))
+	private:
+		// Runtime dispatched wide paths, each returns how many items it handled and leaves
+		// the remainder to the 4-wide loop. They fuse the multiply-adds only when the build
+		// does (AYA_USE_FMA), so a batch rounds the same on every CPU.
+		template<class T>
+		AYA_TARGET_AVX2 size_t applyAVX2(const T *in, T *out, const size_t &n) const {
+			__m256 c8[4][4];
+			for (int r = 0; r < 4; r++)
+				for (int k = 0; k < 4; k++)
+					c8[r][k] = _mm256_set1_ps(m_coef[r][k]);
+
+			size_t i = 0;
+			for (; i + 8 <= n; i += 8) {
+				Vector3x4 lo = Vector3x4::load(in + i), hi = Vector3x4::load(in + i + 4);
+				__m256 v[3], o[4];
+				for (int k = 0; k < 3; k++)
+					v[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(lo.m_val128[k]), hi.m_val128[k], 1);
+				for (int r = 0; r < (m_projective ? 4 : 3); r++)
+					o[r] = _mm256_madd_ps(c8[r][0], v[0],
+						_mm256_madd_ps(c8[r][1], v[1],
+							_mm256_madd_ps(c8[r][2], v[2], c8[r][3])));
+				if (m_projective) {
+					o[0] = _mm256_div_ps(o[0], o[3]);
+					o[1] = _mm256_div_ps(o[1], o[3]);
+					o[2] = _mm256_div_ps(o[2], o[3]);
+				}
+				Vector3x4(_mm256_castps256_ps128(o[0]), _mm256_castps256_ps128(o[1]),
+					_mm256_castps256_ps128(o[2])).store(out + i);
+				Vector3x4(_mm256_extractf128_ps(o[0], 1), _mm256_extractf128_ps(o[1], 1),
+					_mm256_extractf128_ps(o[2], 1)).store(out + i + 4);
+			}
+			return i;
+		}
+		template<class T>
+		AYA_TARGET_AVX512 size_t applyAVX512(const T *in, T *out, const size_t &n) const {
+			__m512 c16[4][4];
+			for (int r = 0; r < 4; r++)
+				for (int k = 0; k < 4; k++)
+					c16[r][k] = _mm512_set1_ps(m_coef[r][k]);
+
+			size_t i = 0;
+			for (; i + 16 <= n; i += 16) {
+				Vector3x4 p[4];
+				for (int j = 0; j < 4; j++)
+					p[j] = Vector3x4::load(in + i + 4 * j);
+				__m512 v[3], o[4];
+				for (int k = 0; k < 3; k++) {
+					v[k] = _mm512_castps128_ps512(p[0].m_val128[k]);
+					v[k] = _mm512_insertf32x4(v[k], p[1].m_val128[k], 1);
+					v[k] = _mm512_insertf32x4(v[k], p[2].m_val128[k], 2);
+					v[k] = _mm512_insertf32x4(v[k], p[3].m_val128[k], 3);
+				}
+				for (int r = 0; r < (m_projective ? 4 : 3); r++)
+					o[r] = _mm512_madd_ps(c16[r][0], v[0],
+						_mm512_madd_ps(c16[r][1], v[1],
+							_mm512_madd_ps(c16[r][2], v[2], c16[r][3])));
+				if (m_projective) {
+					o[0] = _mm512_div_ps(o[0], o[3]);
+					o[1] = _mm512_div_ps(o[1], o[3]);
+					o[2] = _mm512_div_ps(o[2], o[3]);
+				}
+				Vector3x4(_mm512_extractf32x4_ps(o[0], 0), _mm512_extractf32x4_ps(o[1], 0),
+					_mm512_extractf32x4_ps(o[2], 0)).store(out + i);
+				Vector3x4(_mm512_extractf32x4_ps(o[0], 1), _mm512_extractf32x4_ps(o[1], 1),
+					_mm512_extractf32x4_ps(o[2], 1)).store(out + i + 4);
+				Vector3x4(_mm512_extractf32x4_ps(o[0], 2), _mm512_extractf32x4_ps(o[1], 2),
+					_mm512_extractf32x4_ps(o[2], 2)).store(out + i + 8);
+				Vector3x4(_mm512_extractf32x4_ps(o[0], 3), _mm512_extractf32x4_ps(o[1], 3),
+					_mm512_extractf32x4_ps(o[2], 3)).store(out + i + 12);
+			}
+			return i;
+		}
+
+	public:
+#endif
+		// Rays go through a point kernel for the origin and a vector kernel for the direction,
+		// in blocks gathered into contiguous scratch arrays.
+		static void applyRays(const TransformKernel &point_kernel, const TransformKernel &vector_kernel,
+			const Ray *in, Ray *out, const size_t &n) {
+			ParallelFor(n, s_parallel_grain, [&](const size_t &begin, const size_t &end) {
+				const size_t block = 64;
+				Point3 ori[block];
+				Vector3 dir[block];
+				for (size_t i = begin; i < end; i += block) {
+					size_t count = Min(block, end - i);
+					for (size_t k = 0; k < count; k++) {
+						ori[k] = in[i + k].m_ori;
+						dir[k] = in[i + k].m_dir;
+					}
+					point_kernel.applyRange(ori, ori, count);
+					vector_kernel.applyRange(dir, dir, count);
+					for (size_t k = 0; k < count; k++) {
+						out[i + k] = in[i + k];
+						out[i + k].m_ori = ori[k];
+						out[i + k].m_dir = dir[k];
+					}
+				}
+			});
+		}
+	};
+
+	// State of the cached inverse of a transform
+	enum InverseState : uint32_t {
+		INVERSE_NONE = 0,
+		INVERSE_BUSY,
+		INVERSE_VALID
+	};
+
+	// Atomic holder of an InverseState. std::atomic can't be touched while constant evaluating,
+	// so with constexpr support the state is a plain word accessed through std::atomic_ref.
+	class InverseFlag {
+	public:
+		AYA_FORCE_INLINE AYA_CONSTEXPR InverseFlag(const uint32_t &state) : m_state(state) {}
+		InverseFlag(const InverseFlag &) = delete;
+
+#if defined(AYA_USE_CONSTEXPR)
+		AYA_FORCE_INLINE AYA_CONSTEXPR uint32_t load(const std::memory_order &order) const {
+			if (AYA_CONSTANT_EVALUATED())
+				return m_state;
+			return std::atomic_ref<uint32_t>(m_state).load(order);
+		}
+		AYA_FORCE_INLINE AYA_CONSTEXPR void store(const uint32_t &state, const std::memory_order &order) {
+			if (AYA_CONSTANT_EVALUATED())
+				m_state = state;
+			else
+				std::atomic_ref<uint32_t>(m_state).store(state, order);
+		}
+		AYA_FORCE_INLINE bool compare_exchange_strong(uint32_t &expected, const uint32_t &state, const std::memory_order &order) {
+			return std::atomic_ref<uint32_t>(m_state).compare_exchange_strong(expected, state, order);
+		}
+#else
+		AYA_FORCE_INLINE uint32_t load(const std::memory_order &order) const {
+			return m_state.load(order);
+		}
+		AYA_FORCE_INLINE void store(const uint32_t &state, const std::memory_order &order) {
+			m_state.store(state, order);
+		}
+		AYA_FORCE_INLINE bool compare_exchange_strong(uint32_t &expected, const uint32_t &state, const std::memory_order &order) {
+			return m_state.compare_exchange_strong(expected, state, order);
+		}
 #endif
-		class AffineTransform {
+		AYA_FORCE_INLINE AYA_CONSTEXPR InverseFlag& operator = (const uint32_t &state) {
+			store(state, std::memory_order_seq_cst);
+			return *this;
+		}
+
+	private:
+#if defined(AYA_USE_CONSTEXPR)
+		alignas(std::atomic_ref<uint32_t>::required_alignment) mutable uint32_t m_state;
+#else
+		std::atomic<uint32_t> m_state;
+#endif
+	};
+
+	// Runs compute() once to fill in a cached inverse. The first caller that moves state from
+	// INVERSE_NONE to INVERSE_BUSY does the work, concurrent callers wait until it is published.
+	template<class Func>
+	inline void LazyInverse(InverseFlag &state, const Func &compute) {
+		uint32_t expected = INVERSE_NONE;
+		if (state.compare_exchange_strong(expected, INVERSE_BUSY, std::memory_order_acquire)) {
+			compute();
+			state.store(INVERSE_VALID, std::memory_order_release);
+			return;
+		}
+		while (state.load(std::memory_order_acquire) != INVERSE_VALID)
+			std::this_thread::yield();
+	}
+
+	// Cheapest class of a transform, used to pick the kernel for apply, compose and inverse.
+	// TRANSFORM_SCALE is a diagonal linear part, TRANSFORM_RIGID an orthonormal one, both may
+	// carry a translation.
+	enum TransformKind : uint32_t {
+		TRANSFORM_IDENTITY = 0,
+		TRANSFORM_TRANSLATION,
+		TRANSFORM_SCALE,
+		TRANSFORM_RIGID,
+		TRANSFORM_AFFINE,
+		TRANSFORM_PROJECTIVE
+	};
+
+	// Kind of a * b, conservative when the product happens to be simpler
+	AYA_FORCE_INLINE AYA_CONSTEXPR TransformKind ComposeKind(const TransformKind &a, const TransformKind &b) {
+		if (a == TRANSFORM_IDENTITY) return b;
+		if (b == TRANSFORM_IDENTITY) return a;
+		TransformKind k = Max(a, b);
+		// a scale next to a rotation is neither
+		if (k == TRANSFORM_RIGID && (a == TRANSFORM_SCALE || b == TRANSFORM_SCALE))
+			return TRANSFORM_AFFINE;
+		return k;
+	}
+
+	inline AYA_CONSTEXPR TransformKind ClassifyTransform(const Matrix3x3 &m, const Vector3 &t) {
+		if (m[0][1] == 0.f && m[0][2] == 0.f && m[1][0] == 0.f &&
+			m[1][2] == 0.f && m[2][0] == 0.f && m[2][1] == 0.f) {
+			if (m[0][0] != 1.f || m[1][1] != 1.f || m[2][2] != 1.f)
+				return TRANSFORM_SCALE;
+			if (t[0] != 0.f || t[1] != 0.f || t[2] != 0.f)
+				return TRANSFORM_TRANSLATION;
+			return TRANSFORM_IDENTITY;
+		}
+
+		// orthonormal up to the rounding of a few composed rotations
+		const float eps = 16.f * AYA_EPSILON;
+		Matrix3x3 mmt = m * m.transpose();
+		for (int i = 0; i < 3; i++)
+			for (int j = 0; j < 3; j++)
+				if (Abs(mmt[i][j] - (i == j ? 1.f : 0.f)) > eps)
+					return TRANSFORM_AFFINE;
+		return TRANSFORM_RIGID;
+	}
+	inline AYA_CONSTEXPR TransformKind ClassifyTransform(const Matrix4x4 &m) {
+		if (m[3][0] != 0.f || m[3][1] != 0.f || m[3][2] != 0.f || m[3][3] != 1.f)
+			return TRANSFORM_PROJECTIVE;
+		return ClassifyTransform(Matrix3x3(m[0][0], m[0][1], m[0][2],
+			m[1][0], m[1][1], m[1][2],
+			m[2][0], m[2][1], m[2][2]),
+			Vector3(m[0][3], m[1][3], m[2][3]));
+	}
+
+		class AYA_SIMD_ALIGN AffineTransform {
 		public:
-			Matrix3x3 m_mat, m_inv;
+			// m_inv is only meaningful once m_inv_state is INVERSE_VALID (identity until then, so copies
+			// never read uninitialized memory), read it through getInverseMatrix()
+			Matrix3x3 m_mat;
+			mutable Matrix3x3 m_inv;
 			Vector3 m_trans;
+			mutable InverseFlag m_inv_state;
+			TransformKind m_kind;
 
-			AffineTransform() {
-				m_mat = m_inv = Matrix3x3().getIdentity();
+			AYA_CONSTEXPR AffineTransform() : m_inv_state(INVERSE_VALID), m_kind(TRANSFORM_IDENTITY) {
+				m_mat.setIdentity();
+				m_inv.setIdentity();
 				m_trans = Vector3(0, 0, 0);
 			}
-			explicit AYA_FORCE_INLINE AffineTransform(const Matrix3x3 &m, const Vector3 &t) :
-				m_mat(m), m_inv(m.inverse()), m_trans(t) {}
-			explicit AYA_FORCE_INLINE AffineTransform(const Matrix3x3 &m) :
-				m_mat(m), m_inv(m.inverse()), m_trans(Vector3()) {}
-			explicit AYA_FORCE_INLINE AffineTransform(const Matrix3x3 &m, const Matrix3x3 &inv, const Vector3 &t) :
-				m_mat(m), m_inv(inv), m_trans(t) {}
-			explicit AYA_FORCE_INLINE AffineTransform(const Matrix3x3 &m, const Matrix3x3 &inv) :
-				m_mat(m), m_inv(inv), m_trans(Vector3()) {}
-			explicit AYA_FORCE_INLINE AffineTransform(const Quaternion &q) { setRotation(q); }
-			explicit AYA_FORCE_INLINE AffineTransform(const Quaternion &q, const BaseVector3 &v) { setRotation(q); m_trans = v; }
-			explicit AYA_FORCE_INLINE AffineTransform(const Vector3 &t) :
-				m_mat(Matrix3x3().getIdentity()), m_inv(Matrix3x3().getIdentity()), m_trans(t) {}
-			AYA_FORCE_INLINE AffineTransform(const AffineTransform &rhs) :
-				m_mat(rhs.m_mat), m_inv(rhs.m_inv), m_trans(rhs.m_trans) {}
-			AYA_FORCE_INLINE AffineTransform& operator = (const AffineTransform &rhs) {
+			// The inverse of m is computed on first use
+			explicit AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform(const Matrix3x3 &m, const Vector3 &t) :
+				m_mat(m), m_inv(Matrix3x3().getIdentity()), m_trans(t), m_inv_state(INVERSE_NONE), m_kind(ClassifyTransform(m, t)) { bakeInverse(); }
+			explicit AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform(const Matrix3x3 &m) :
+				m_mat(m), m_inv(Matrix3x3().getIdentity()), m_trans(Vector3(0, 0, 0)), m_inv_state(INVERSE_NONE), m_kind(ClassifyTransform(m, m_trans)) { bakeInverse(); }
+			explicit AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform(const Matrix3x3 &m, const Matrix3x3 &inv, const Vector3 &t) :
+				m_mat(m), m_inv(inv), m_trans(t), m_inv_state(INVERSE_VALID), m_kind(ClassifyTransform(m, t)) {}
+			explicit AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform(const Matrix3x3 &m, const Matrix3x3 &inv) :
+				m_mat(m), m_inv(inv), m_trans(Vector3(0, 0, 0)), m_inv_state(INVERSE_VALID), m_kind(ClassifyTransform(m, m_trans)) {}
+			// Skip the classification when the caller already knows the kind
+			explicit AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform(const Matrix3x3 &m, const Vector3 &t, const TransformKind &kind) :
+				m_mat(m), m_inv(Matrix3x3().getIdentity()), m_trans(t), m_inv_state(INVERSE_NONE), m_kind(kind) { bakeInverse(); }
+			explicit AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform(const Matrix3x3 &m, const Matrix3x3 &inv, const Vector3 &t, const TransformKind &kind) :
+				m_mat(m), m_inv(inv), m_trans(t), m_inv_state(INVERSE_VALID), m_kind(kind) {}
+			explicit AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform(const Quaternion &q) : m_inv_state(INVERSE_VALID) { setRotation(q); }
+			explicit AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform(const Quaternion &q, const BaseVector3 &v) : m_inv_state(INVERSE_VALID) { setRotation(q); m_trans = v; }
+			explicit AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform(const Vector3 &t) :
+				m_mat(Matrix3x3().getIdentity()), m_inv(Matrix3x3().getIdentity()), m_trans(t), m_inv_state(INVERSE_VALID),
+				m_kind(TRANSFORM_TRANSLATION) {}
+			AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform(const AffineTransform &rhs) :
+				m_mat(rhs.m_mat), m_inv(Matrix3x3().getIdentity()), m_trans(rhs.m_trans), m_inv_state(INVERSE_NONE), m_kind(rhs.m_kind) {
+				if (!AYA_CONSTANT_EVALUATED() && rhs.hasInverse()) {
+					m_inv = rhs.m_inv;
+					m_inv_state = INVERSE_VALID;
+				}
+				bakeInverse();
+			}
+			AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform& operator = (const AffineTransform &rhs) {
 				m_mat = rhs.m_mat;
-				m_inv = rhs.m_inv;
 				m_trans = rhs.m_trans;
+				m_kind = rhs.m_kind;
+				if (!AYA_CONSTANT_EVALUATED() && rhs.hasInverse()) {
+					m_inv = rhs.m_inv;
+					m_inv_state = INVERSE_VALID;
+				}
+				else
+					m_inv_state = INVERSE_NONE;
+				bakeInverse();
 				return *this;
 			}
 #if defined(AYA_USE_SIMD)
@@ -52,41 +434,103 @@ namespace Aya {
 			}
 #endif
 
-			AYA_FORCE_INLINE AffineTransform inverse() const {
-				return AffineTransform(m_inv,
+			AYA_FORCE_INLINE AYA_CONSTEXPR TransformKind getKind() const {
+				return m_kind;
+			}
+			AYA_FORCE_INLINE AYA_CONSTEXPR bool hasInverse() const {
+				// always baked while constant evaluating, see bakeInverse()
+				if (AYA_CONSTANT_EVALUATED())
+					return true;
+				return m_inv_state.load(std::memory_order_acquire) == INVERSE_VALID;
+			}
+			// Computes and caches the inverse on first call, safe to call from several threads
+			AYA_FORCE_INLINE AYA_CONSTEXPR const Matrix3x3& getInverseMatrix() const {
+				if (!hasInverse())
+					LazyInverse(m_inv_state, [this]() {
+						m_inv = computeInverseMatrix();
+					});
+				return m_inv;
+			}
+			// Inverse of m_mat by the cheapest method the kind allows
+			AYA_FORCE_INLINE AYA_CONSTEXPR Matrix3x3 computeInverseMatrix() const {
+				switch (m_kind) {
+				case TRANSFORM_IDENTITY:
+				case TRANSFORM_TRANSLATION:
+					return Matrix3x3().getIdentity();
+				case TRANSFORM_SCALE:
+					return Matrix3x3(1.f / m_mat[0][0], 0, 0,
+						0, 1.f / m_mat[1][1], 0,
+						0, 0, 1.f / m_mat[2][2]);
+				case TRANSFORM_RIGID:
+					return m_mat.transpose();
+				default:
+					return m_mat.inverse();
+				}
+			}
+
+			AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform inverse() const {
+				if (m_kind == TRANSFORM_IDENTITY)
+					return *this;
+				if (m_kind == TRANSFORM_TRANSLATION)
+					return AffineTransform(-m_trans);
+				if (AYA_CONSTANT_EVALUATED()) {
+					const Matrix3x3 inv = computeInverseMatrix();
+					return AffineTransform(inv, m_mat, -(inv * m_trans), m_kind);
+				}
+				const Matrix3x3 &inv = getInverseMatrix();
+				return AffineTransform(inv,
 					m_mat,
-					-(m_inv * m_trans));
+					-(inv * m_trans), m_kind);
 			}
 
-			AYA_FORCE_INLINE AffineTransform operator * (const AffineTransform &t) const {
+			// Composition only multiplies the forward matrices, the inverse of the result is
+			// computed on first use
+			AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform operator * (const AffineTransform &t) const {
+				if (m_kind == TRANSFORM_IDENTITY)
+					return t;
+				if (t.m_kind == TRANSFORM_IDENTITY)
+					return *this;
+				if (m_kind == TRANSFORM_TRANSLATION && t.m_kind == TRANSFORM_TRANSLATION)
+					return AffineTransform(m_trans + t.m_trans);
 				return AffineTransform(m_mat * t.m_mat,
-					t.m_inv * m_inv,
-					(m_mat * t.m_trans) + m_trans);
+					(m_mat * t.m_trans) + m_trans, ComposeKind(m_kind, t.m_kind));
 			}
-			AYA_FORCE_INLINE AffineTransform& operator *= (const AffineTransform &t) {
-				m_mat *= t.m_mat;
-				m_inv = t.m_inv * m_inv;
+			AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform& operator *= (const AffineTransform &t) {
+				if (t.m_kind == TRANSFORM_IDENTITY)
+					return *this;
+				if (m_kind == TRANSFORM_IDENTITY)
+					return *this = t;
 				m_trans = (m_mat * t.m_trans) + m_trans;
+				if (t.m_kind != TRANSFORM_TRANSLATION) {
+					m_mat *= t.m_mat;
+					m_inv_state = INVERSE_NONE;
+				}
+				m_kind = ComposeKind(m_kind, t.m_kind);
+				bakeInverse();
 
 				return *this;
 			}
 
 
-			AYA_FORCE_INLINE AffineTransform& setTranslate(const Vector3 &delta) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform& setTranslate(const Vector3 &delta) {
 				m_trans = delta;
 				m_mat.setIdentity();
 				m_inv.setIdentity();
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_TRANSLATION;
 
 				return *this;
 			}
-			AYA_FORCE_INLINE AffineTransform& setTranslate(const float &x, const float &y, const float &z) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform& setTranslate(const float &x, const float &y, const float &z) {
 				m_trans.setValue(x, y, z);
 				m_mat.setIdentity();
 				m_inv.setIdentity();
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_TRANSLATION;
 
 				return *this;
 			}
-			AYA_FORCE_INLINE AffineTransform& setScale(const Vector3 &scale) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform& setScale(const Vector3 &scale) {
 				assert(scale.x() != 0 && scale.y() != 0 && scale.z() != 0);
 				m_mat.setValue(scale.x(), 0, 0,
 					0, scale.y(), 0,
@@ -94,11 +538,13 @@ namespace Aya {
 				m_inv.setValue(1.f / scale.x(), 0, 0,
 					0, 1.f / scale.y(), 0,
 					0, 0, 1.f / scale.z());
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_SCALE;
 				m_trans.setZero();
 
 				return *this;
 			}
-			AYA_FORCE_INLINE AffineTransform& setScale(const float &x, const float &y, const float &z) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform& setScale(const float &x, const float &y, const float &z) {
 				assert(x != 0 && y != 0 && z != 0);
 				m_mat.setValue(x, 0, 0,
 					0, y, 0,
@@ -106,39 +552,47 @@ namespace Aya {
 				m_inv.setValue(1.f / x, 0, 0,
 					0, 1.f / y, 0,
 					0, 0, 1.f / z);
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_SCALE;
 				m_trans.setZero();
 
 				return *this;
 			}
-			AYA_FORCE_INLINE AffineTransform& setRotateX(const float &angle) {
-				float sin_t = sinf(Radian(angle));
-				float cos_t = cosf(Radian(angle));
+			AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform& setRotateX(const float &angle) {
+				float sin_t, cos_t;
+				SimdMath::sincos(Radian(angle), &sin_t, &cos_t);
 				m_mat.setValue(1, 0, 0,
-					0, cos_t, sin_t,
-					0, sin_t, -cos_t);
+					0, cos_t, -sin_t,
+					0, sin_t, cos_t);
 				m_inv = m_mat.transpose();
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_RIGID;
 				m_trans.setZero();
 
 				return *this;
 			}
-			AYA_FORCE_INLINE AffineTransform& setRotateY(const float &angle) {
-				float sin_t = sinf(Radian(angle));
-				float cos_t = cosf(Radian(angle));
+			AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform& setRotateY(const float &angle) {
+				float sin_t, cos_t;
+				SimdMath::sincos(Radian(angle), &sin_t, &cos_t);
 				m_mat.setValue(cos_t, 0, sin_t,
 					0, 1, 0,
 					-sin_t, 0, cos_t);
 				m_inv = m_mat.transpose();
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_RIGID;
 				m_trans.setZero();
 
 				return *this;
 			}
-			AYA_FORCE_INLINE AffineTransform& setRotateZ(const float &angle) {
-				float sin_t = sinf(Radian(angle));
-				float cos_t = cosf(Radian(angle));
+			AYA_FORCE_INLINE AYA_CONSTEXPR AffineTransform& setRotateZ(const float &angle) {
+				float sin_t, cos_t;
+				SimdMath::sincos(Radian(angle), &sin_t, &cos_t);
 				m_mat.setValue(cos_t, -sin_t, 0,
 					sin_t, cos_t, 0,
 					0, 0, 1);
 				m_inv = m_mat.transpose();
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_RIGID;
 				m_trans.setZero();
 
 				return *this;
@@ -148,95 +602,105 @@ namespace Aya {
 				float x = a.x();
 				float y = a.y();
 				float z = a.z();
-				float s = sinf(Radian(angle));
-				float c = cosf(Radian(angle));
+				float s, c;
+				SimdMath::sincos(Radian(angle), &s, &c);
 
 				m_mat.setValue(x * x + (1.f - x * x) * c, x * y * (1.f - c) - z * s, x * z * (1.f - c) + y * s,
 					x * y * (1.f - c) + z * s, y * y + (1.f - y * y) * c, y * z * (1.f - c) - x * s,
 					x * z * (1.f - c) - y * s, y * z * (1.f - c) + x * s, z * z + (1.f - z * z) * c);
 				m_inv = m_mat.transpose();
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_RIGID;
 				m_trans.setZero();
 
 				return *this;
 			}
-			void setRotation(const Quaternion& q)
+			AYA_CONSTEXPR void setRotation(const Quaternion& q)
 			{
 				float d = q.length2();
 				assert(d != 0.f);
 				float s = 2.f / d;
 
 #if defined(AYA_USE_SIMD)
-				__m128 vs, Q = q.get128();
-				__m128i Qi = _mm_castps_si128(Q);
-				__m128 Y, Z;
-				__m128 V1, V2, V3;
-				__m128 V11, V21, V31;
-				__m128 NQ = _mm_xor_ps(Q, vMzeroMask);
-				__m128i NQi = _mm_castps_si128(NQ);
-
-				V1 = _mm_castsi128_ps(_mm_shuffle_epi32(Qi, __MM_SHUFFLE(1, 0, 2, 3)));  // Y X Z W
-				V2 = _mm_shuffle_ps(NQ, Q, __MM_SHUFFLE(0, 0, 1, 3));                 // -X -X  Y  W
-				V3 = _mm_castsi128_ps(_mm_shuffle_epi32(Qi, __MM_SHUFFLE(2, 1, 0, 3)));  // Z Y X W
-				V1 = _mm_xor_ps(V1, vMPPP);                                         //	change the sign of the first element
-
-				V11 = _mm_castsi128_ps(_mm_shuffle_epi32(Qi, __MM_SHUFFLE(1, 1, 0, 3)));  // Y Y X W
-				V21 = _mm_unpackhi_ps(Q, Q);                                         //  Z  Z  W  W
-				V31 = _mm_shuffle_ps(Q, NQ, __MM_SHUFFLE(0, 2, 0, 3));                 //  X  Z -X -W
-
-				V2 = _mm_mul_ps(V2, V1);   //
-				V1 = _mm_mul_ps(V1, V11);  //
-				V3 = _mm_mul_ps(V3, V31);  //
-
-				V11 = _mm_shuffle_ps(NQ, Q, __MM_SHUFFLE(2, 3, 1, 3));                //	-Z -W  Y  W
-				V11 = _mm_mul_ps(V11, V21);                                                    //
-				V21 = _mm_xor_ps(V21, vMPPP);                                       //	change the sign of the first element
-				V31 = _mm_shuffle_ps(Q, NQ, __MM_SHUFFLE(3, 3, 1, 3));                //	 W  W -Y -W
-				V31 = _mm_xor_ps(V31, vMPPP);                                       //	change the sign of the first element
-				Y = _mm_castsi128_ps(_mm_shuffle_epi32(NQi, __MM_SHUFFLE(3, 2, 0, 3)));  // -W -Z -X -W
-				Z = _mm_castsi128_ps(_mm_shuffle_epi32(Qi, __MM_SHUFFLE(1, 0, 1, 3)));   //  Y  X  Y  W
-
-				vs = _mm_load_ss(&s);
-				V21 = _mm_mul_ps(V21, Y);
-				V31 = _mm_mul_ps(V31, Z);
-
-				V1 = _mm_add_ps(V1, V11);
-				V2 = _mm_add_ps(V2, V21);
-				V3 = _mm_add_ps(V3, V31);
-
-				vs = _mm_splat3_ps(vs, 0);
-				//	s ready
-				V1 = _mm_mul_ps(V1, vs);
-				V2 = _mm_mul_ps(V2, vs);
-				V3 = _mm_mul_ps(V3, vs);
-
-				V1 = _mm_add_ps(V1, v1000);
-				V2 = _mm_add_ps(V2, v0100);
-				V3 = _mm_add_ps(V3, v0010);
-
-				m_mat[0] = V1;
-				m_mat[1] = V2;
-				m_mat[2] = V3;
-#else
-				float xs = q.x() * s, ys = q.y() * s, zs = q.z() * s;
-				float wx = q.w() * xs, wy = q.w() * ys, wz = q.w() * zs;
-				float xx = q.x() * xs, xy = q.x() * ys, xz = q.x() * zs;
-				float yy = q.y() * ys, yz = q.y() * zs, zz = q.z() * zs;
-
-				m_mat.setValue(
-					1.f - (yy + zz), xy - wz, xz + wy,
-					xy + wz, 1.f - (xx + zz), yz - wx,
-					xz - wy, yz + wx, 1.f - (xx + yy));
+				if (!AYA_CONSTANT_EVALUATED()) {
+					__m128 vs, Q = q.get128();
+					__m128i Qi = _mm_castps_si128(Q);
+					__m128 Y, Z;
+					__m128 V1, V2, V3;
+					__m128 V11, V21, V31;
+					__m128 NQ = _mm_xor_ps(Q, vMzeroMask);
+					__m128i NQi = _mm_castps_si128(NQ);
+
+					V1 = _mm_castsi128_ps(_mm_shuffle_epi32(Qi, __MM_SHUFFLE(1, 0, 2, 3)));  // Y X Z W
+					V2 = _mm_shuffle_ps(NQ, Q, __MM_SHUFFLE(0, 0, 1, 3));                 // -X -X  Y  W
+					V3 = _mm_castsi128_ps(_mm_shuffle_epi32(Qi, __MM_SHUFFLE(2, 1, 0, 3)));  // Z Y X W
+					V1 = _mm_xor_ps(V1, vMPPP);                                         //	change the sign of the first element
+
+					V11 = _mm_castsi128_ps(_mm_shuffle_epi32(Qi, __MM_SHUFFLE(1, 1, 0, 3)));  // Y Y X W
+					V21 = _mm_unpackhi_ps(Q, Q);                                         //  Z  Z  W  W
+					V31 = _mm_shuffle_ps(Q, NQ, __MM_SHUFFLE(0, 2, 0, 3));                 //  X  Z -X -W
+
+					V2 = _mm_mul_ps(V2, V1);   //
+					V1 = _mm_mul_ps(V1, V11);  //
+					V3 = _mm_mul_ps(V3, V31);  //
+
+					V11 = _mm_shuffle_ps(NQ, Q, __MM_SHUFFLE(2, 3, 1, 3));                //	-Z -W  Y  W
+					V11 = _mm_mul_ps(V11, V21);                                                    //
+					V21 = _mm_xor_ps(V21, vMPPP);                                       //	change the sign of the first element
+					V31 = _mm_shuffle_ps(Q, NQ, __MM_SHUFFLE(3, 3, 1, 3));                //	 W  W -Y -W
+					V31 = _mm_xor_ps(V31, vMPPP);                                       //	change the sign of the first element
+					Y = _mm_castsi128_ps(_mm_shuffle_epi32(NQi, __MM_SHUFFLE(3, 2, 0, 3)));  // -W -Z -X -W
+					Z = _mm_castsi128_ps(_mm_shuffle_epi32(Qi, __MM_SHUFFLE(1, 0, 1, 3)));   //  Y  X  Y  W
+
+					vs = _mm_load_ss(&s);
+					V21 = _mm_mul_ps(V21, Y);
+					V31 = _mm_mul_ps(V31, Z);
+
+					V1 = _mm_add_ps(V1, V11);
+					V2 = _mm_add_ps(V2, V21);
+					V3 = _mm_add_ps(V3, V31);
+
+					vs = _mm_splat3_ps(vs, 0);
+					//	s ready
+					V1 = _mm_mul_ps(V1, vs);
+					V2 = _mm_mul_ps(V2, vs);
+					V3 = _mm_mul_ps(V3, vs);
+
+					V1 = _mm_add_ps(V1, v1000);
+					V2 = _mm_add_ps(V2, v0100);
+					V3 = _mm_add_ps(V3, v0010);
+
+					m_mat[0] = V1;
+					m_mat[1] = V2;
+					m_mat[2] = V3;
+				}
+				else
 #endif
+				{
+					float xs = q.x() * s, ys = q.y() * s, zs = q.z() * s;
+					float wx = q.w() * xs, wy = q.w() * ys, wz = q.w() * zs;
+					float xx = q.x() * xs, xy = q.x() * ys, xz = q.x() * zs;
+					float yy = q.y() * ys, yz = q.y() * zs, zz = q.z() * zs;
+
+					m_mat.setValue(
+						1.f - (yy + zz), xy - wz, xz + wy,
+						xy + wz, 1.f - (xx + zz), yz - wx,
+						xz - wy, yz + wx, 1.f - (xx + yy));
+				}
 				m_inv = m_mat.transpose();
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_RIGID;
 				m_trans.setZero();
 			}
 			AYA_FORCE_INLINE AffineTransform& setEulerZYX(const float &e_x, const float &e_y, const float &e_z) {
-				float ci(cosf(Radian(e_x)));
-				float cj(cosf(Radian(e_y)));
-				float ch(cosf(Radian(e_z)));
-				float si(sinf(Radian(e_x)));
-				float sj(sinf(Radian(e_y)));
-				float sh(sinf(Radian(e_z)));
+				float angles[3] = { Radian(e_x), Radian(e_y), Radian(e_z) }, s[3], c[3];
+				SimdMath::sincos(angles, s, c, 3);
+				float ci(c[0]);
+				float cj(c[1]);
+				float ch(c[2]);
+				float si(s[0]);
+				float sj(s[1]);
+				float sh(s[2]);
 				float cc = ci * ch;
 				float cs = ci * sh;
 				float sc = si * ch;
@@ -246,6 +710,8 @@ namespace Aya {
 					cj * sh, sj * ss + cc, sj * cs - sc,
 					-sj, cj * si, cj * ci);
 				m_inv = m_mat.transpose();
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_RIGID;
 				m_trans.setZero();
 
 				return *this;
@@ -255,15 +721,31 @@ namespace Aya {
 			}
 
 			AYA_FORCE_INLINE Vector3 operator() (const Vector3 &v) const {
+				if (m_kind <= TRANSFORM_TRANSLATION)
+					return v;
 				return m_mat * v;
 			}
 			AYA_FORCE_INLINE Point3 operator() (const Point3 &p) const {
+				if (m_kind <= TRANSFORM_TRANSLATION)
+					return p + m_trans;
 				return m_mat * p + m_trans;
 			}
 			AYA_FORCE_INLINE Normal3 operator() (const Normal3 &n) const {
-				return m_inv.transpose() * n;
+				if (m_kind <= TRANSFORM_TRANSLATION)
+					return n;
+				// the inverse transpose of a rotation is itself
+				if (m_kind == TRANSFORM_RIGID)
+					return m_mat * n;
+				// (M^-1)^T * n == n * M^-1, the row-vector product needs no transpose
+				return n * getInverseMatrix();
 			}
 			AYA_FORCE_INLINE BBox operator() (const BBox &b) const {
+				if (m_kind <= TRANSFORM_TRANSLATION) {
+					BBox ret;
+					ret.m_pmin = b.m_pmin + m_trans;
+					ret.m_pmax = b.m_pmax + m_trans;
+					return ret;
+				}
 				// const AffineTransform &M = *this;
 				// BBox ret(M(Point3(b.m_pmin.x(), b.m_pmin.y(), b.m_pmin.z())));
 				// ret.unity(M(Point3(b.m_pmax.x(), b.m_pmin.y(), b.m_pmin.z())));
@@ -322,55 +804,125 @@ namespace Aya {
 				return ret;
 			}
 
+			// Batched versions of operator(), in and out may alias. The batch evaluates each component
+			// as one multiply-add chain, so it can differ from operator() in the last bits.
+			AYA_FORCE_INLINE void apply(const Point3 *in, Point3 *out, const size_t &n) const {
+				if (m_kind == TRANSFORM_IDENTITY)
+					TransformKernel::copy(in, out, n);
+				else
+					TransformKernel(m_mat, m_trans).apply(in, out, n);
+			}
+			AYA_FORCE_INLINE void apply(const Vector3 *in, Vector3 *out, const size_t &n) const {
+				if (m_kind <= TRANSFORM_TRANSLATION)
+					TransformKernel::copy(in, out, n);
+				else
+					TransformKernel(m_mat, Vector3(0.f, 0.f, 0.f)).apply(in, out, n);
+			}
+			AYA_FORCE_INLINE void apply(const Normal3 *in, Normal3 *out, const size_t &n) const {
+				if (m_kind <= TRANSFORM_TRANSLATION)
+					TransformKernel::copy(in, out, n);
+				else if (m_kind == TRANSFORM_RIGID)
+					TransformKernel(m_mat, Vector3(0.f, 0.f, 0.f)).apply(in, out, n);
+				else
+					TransformKernel::normalKernel(getInverseMatrix()).apply(in, out, n);
+			}
+			AYA_FORCE_INLINE void apply(const Ray *in, Ray *out, const size_t &n) const {
+				if (m_kind == TRANSFORM_IDENTITY)
+					TransformKernel::copy(in, out, n);
+				else
+					TransformKernel::applyRays(TransformKernel(m_mat, m_trans),
+						TransformKernel(m_mat, Vector3(0.f, 0.f, 0.f)), in, out, n);
+			}
+
 			friend inline std::ostream &operator<<(std::ostream &os, const AffineTransform &t) {
 				os << t.m_mat << ",\n";
-				os << t.m_inv << ",\n";
+				os << t.getInverseMatrix() << ",\n";
 				os << t.m_trans;
 				return os;
 			}
+
+		private:
+			// A constant-evaluated transform can neither fill the mutable cache later nor have it
+			// read back once it is a constexpr object, so the inverse is computed up front there.
+			AYA_FORCE_INLINE AYA_CONSTEXPR void bakeInverse() {
+				if (AYA_CONSTANT_EVALUATED()) {
+					m_inv = computeInverseMatrix();
+					m_inv_state = INVERSE_VALID;
+				}
+			}
 	};
 
-#if defined(AYA_USE_SIMD)
-	__declspec(align(16))
-#endif
-		class Transform {
+		class AYA_SIMD_ALIGN Transform {
 		public:
-			Matrix4x4 m_mat, m_inv;
+			// m_inv is only meaningful once m_inv_state is INVERSE_VALID (identity until then, so copies
+			// never read uninitialized memory), read it through getInverseMatrix()
+			Matrix4x4 m_mat;
+			mutable Matrix4x4 m_inv;
+			mutable InverseFlag m_inv_state;
+			TransformKind m_kind;
 
 		public:
-			Transform() {
-				m_mat = m_inv = Matrix4x4().getIdentity();
-			}
-			explicit AYA_FORCE_INLINE Transform(const Matrix4x4 &m) :
-				m_mat(m), m_inv(m.inverse()) {}
-			explicit AYA_FORCE_INLINE Transform(const Matrix4x4 &m, const Matrix4x4 &inv) :
-				m_mat(m), m_inv(inv) {}
-			explicit AYA_FORCE_INLINE Transform(const Quaternion &q) { setRotation(q); }
-			AYA_FORCE_INLINE Transform(const AffineTransform &tr) {
-				const Matrix3x3 &mat = tr.m_mat;
-				const Matrix3x3 &inv = tr.m_inv;
-				const Vector3 &trans = tr.m_trans;
-				m_mat.setValue(mat[0][0], mat[0][1], mat[0][2], trans[0],
-					mat[1][0], mat[1][1], mat[1][2], trans[1],
-					mat[2][0], mat[2][1], mat[2][2], trans[2],
-					0, 0, 0, 1);
+			AYA_CONSTEXPR Transform() : m_inv_state(INVERSE_VALID), m_kind(TRANSFORM_IDENTITY) {
+				m_mat.setIdentity();
+				m_inv.setIdentity();
+			}
+			// The inverse of m is computed on first use
+			explicit AYA_FORCE_INLINE AYA_CONSTEXPR Transform(const Matrix4x4 &m) :
+				m_mat(m), m_inv(Matrix4x4().getIdentity()), m_inv_state(INVERSE_NONE), m_kind(ClassifyTransform(m)) { bakeInverse(); }
+			explicit AYA_FORCE_INLINE AYA_CONSTEXPR Transform(const Matrix4x4 &m, const Matrix4x4 &inv) :
+				m_mat(m), m_inv(inv), m_inv_state(INVERSE_VALID), m_kind(ClassifyTransform(m)) {}
+			// Skip the classification when the caller already knows the kind
+			explicit AYA_FORCE_INLINE AYA_CONSTEXPR Transform(const Matrix4x4 &m, const TransformKind &kind) :
+				m_mat(m), m_inv(Matrix4x4().getIdentity()), m_inv_state(INVERSE_NONE), m_kind(kind) { bakeInverse(); }
+			explicit AYA_FORCE_INLINE AYA_CONSTEXPR Transform(const Matrix4x4 &m, const Matrix4x4 &inv, const TransformKind &kind) :
+				m_mat(m), m_inv(inv), m_inv_state(INVERSE_VALID), m_kind(kind) {}
+			explicit AYA_FORCE_INLINE AYA_CONSTEXPR Transform(const Quaternion &q) : m_inv_state(INVERSE_VALID) { setRotation(q); }
+			AYA_FORCE_INLINE AYA_CONSTEXPR Transform(const AffineTransform &tr) : m_inv(Matrix4x4().getIdentity()), m_inv_state(INVERSE_NONE) {
+				*this = tr;
 			}
 
-			AYA_FORCE_INLINE Transform(const Transform &rhs) :
-				m_mat(rhs.m_mat), m_inv(rhs.m_inv) {}
-			AYA_FORCE_INLINE Transform& operator = (const Transform &rhs) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Transform(const Transform &rhs) :
+				m_mat(rhs.m_mat), m_inv(Matrix4x4().getIdentity()), m_inv_state(INVERSE_NONE), m_kind(rhs.m_kind) {
+				if (!AYA_CONSTANT_EVALUATED() && rhs.hasInverse()) {
+					m_inv = rhs.m_inv;
+					m_inv_state = INVERSE_VALID;
+				}
+				bakeInverse();
+			}
+			AYA_FORCE_INLINE AYA_CONSTEXPR Transform& operator = (const Transform &rhs) {
 				m_mat = rhs.m_mat;
-				m_inv = rhs.m_inv;
+				m_kind = rhs.m_kind;
+				if (!AYA_CONSTANT_EVALUATED() && rhs.hasInverse()) {
+					m_inv = rhs.m_inv;
+					m_inv_state = INVERSE_VALID;
+				}
+				else
+					m_inv_state = INVERSE_NONE;
+				bakeInverse();
 				return *this;
 			}
-			AYA_FORCE_INLINE Transform& operator = (const AffineTransform &tr) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Transform& operator = (const AffineTransform &tr) {
 				const Matrix3x3 &mat = tr.m_mat;
-				const Matrix3x3 &inv = tr.m_inv;
 				const Vector3 &trans = tr.m_trans;
 				m_mat.setValue(mat[0][0], mat[0][1], mat[0][2], trans[0],
 					mat[1][0], mat[1][1], mat[1][2], trans[1],
 					mat[2][0], mat[2][1], mat[2][2], trans[2],
 					0, 0, 0, 1);
+				m_kind = tr.m_kind;
+
+				// only carry the inverse over when tr already has it
+				if (!AYA_CONSTANT_EVALUATED() && tr.hasInverse()) {
+					const Matrix3x3 &inv = tr.m_inv;
+					const Vector3 inv_trans = -(inv * trans);
+					m_inv.setValue(inv[0][0], inv[0][1], inv[0][2], inv_trans[0],
+						inv[1][0], inv[1][1], inv[1][2], inv_trans[1],
+						inv[2][0], inv[2][1], inv[2][2], inv_trans[2],
+						0, 0, 0, 1);
+					m_inv_state = INVERSE_VALID;
+				}
+				else
+					m_inv_state = INVERSE_NONE;
+				bakeInverse();
 
 				return *this;
 			}
@@ -384,21 +936,92 @@ namespace Aya {
 			}
 #endif
 
-			AYA_FORCE_INLINE Transform inverse() const {
-				return Transform(m_inv, m_mat);
+			AYA_FORCE_INLINE AYA_CONSTEXPR TransformKind getKind() const {
+				return m_kind;
+			}
+			AYA_FORCE_INLINE AYA_CONSTEXPR bool hasInverse() const {
+				// always baked while constant evaluating, see bakeInverse()
+				if (AYA_CONSTANT_EVALUATED())
+					return true;
+				return m_inv_state.load(std::memory_order_acquire) == INVERSE_VALID;
+			}
+			// Computes and caches the inverse on first call, safe to call from several threads
+			AYA_FORCE_INLINE AYA_CONSTEXPR const Matrix4x4& getInverseMatrix() const {
+				if (!hasInverse())
+					LazyInverse(m_inv_state, [this]() {
+						m_inv = computeInverseMatrix();
+					});
+				return m_inv;
+			}
+			// Inverse of m_mat by the cheapest method the kind allows, everything short of a
+			// projective matrix only inverts the upper 3x3 block
+			AYA_CONSTEXPR Matrix4x4 computeInverseMatrix() const {
+				const Matrix4x4 &m = m_mat;
+				Matrix3x3 inv;
+				switch (m_kind) {
+				case TRANSFORM_PROJECTIVE:
+					return m.inverse();
+				case TRANSFORM_IDENTITY:
+				case TRANSFORM_TRANSLATION:
+					inv.setIdentity();
+					break;
+				case TRANSFORM_SCALE:
+					inv.setValue(1.f / m[0][0], 0, 0,
+						0, 1.f / m[1][1], 0,
+						0, 0, 1.f / m[2][2]);
+					break;
+				case TRANSFORM_RIGID:
+					inv.setValue(m[0][0], m[1][0], m[2][0],
+						m[0][1], m[1][1], m[2][1],
+						m[0][2], m[1][2], m[2][2]);
+					break;
+				default:
+					inv = Matrix3x3(m[0][0], m[0][1], m[0][2],
+						m[1][0], m[1][1], m[1][2],
+						m[2][0], m[2][1], m[2][2]).inverse();
+					break;
+				}
+				const Vector3 t = -(inv * Vector3(m[0][3], m[1][3], m[2][3]));
+				Matrix4x4 ret;
+				ret.setValue(inv[0][0], inv[0][1], inv[0][2], t[0],
+					inv[1][0], inv[1][1], inv[1][2], t[1],
+					inv[2][0], inv[2][1], inv[2][2], t[2],
+					0, 0, 0, 1);
+				return ret;
+			}
+
+			AYA_FORCE_INLINE AYA_CONSTEXPR Transform inverse() const {
+				if (AYA_CONSTANT_EVALUATED())
+					return Transform(computeInverseMatrix(), m_mat, m_kind);
+				return Transform(getInverseMatrix(), m_mat, m_kind);
 			}
 
-			AYA_FORCE_INLINE Transform operator * (const Transform &t) const {
-				return Transform(m_mat * t.m_mat, t.m_inv * m_inv);
+			// Composition only multiplies the forward matrices, the inverse of the result is
+			// computed on first use
+			AYA_FORCE_INLINE AYA_CONSTEXPR Transform operator * (const Transform &t) const {
+				if (m_kind == TRANSFORM_IDENTITY)
+					return t;
+				if (t.m_kind == TRANSFORM_IDENTITY)
+					return *this;
+				if (m_kind == TRANSFORM_TRANSLATION && t.m_kind == TRANSFORM_TRANSLATION)
+					return Transform().setTranslate(m_mat[0][3] + t.m_mat[0][3],
+						m_mat[1][3] + t.m_mat[1][3], m_mat[2][3] + t.m_mat[2][3]);
+				return Transform(m_mat * t.m_mat, ComposeKind(m_kind, t.m_kind));
 			}
-			AYA_FORCE_INLINE Transform& operator *= (const Transform &t) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Transform& operator *= (const Transform &t) {
+				if (t.m_kind == TRANSFORM_IDENTITY)
+					return *this;
+				if (m_kind == TRANSFORM_IDENTITY)
+					return *this = t;
 				m_mat *= t.m_mat;
-				m_inv = t.m_inv * m_inv;
+				m_inv_state = INVERSE_NONE;
+				m_kind = ComposeKind(m_kind, t.m_kind);
+				bakeInverse();
 
 				return *this;
 			}
 
-			AYA_FORCE_INLINE Transform& setTranslate(const Vector3 &delta) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Transform& setTranslate(const Vector3 &delta) {
 				m_mat.setValue(1, 0, 0, delta.x(),
 					0, 1, 0, delta.y(),
 					0, 0, 1, delta.z(),
@@ -407,10 +1030,12 @@ namespace Aya {
 					0, 1, 0, -delta.y(),
 					0, 0, 1, -delta.z(),
 					0, 0, 0, 1);
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_TRANSLATION;
 
 				return *this;
 			}
-			AYA_FORCE_INLINE Transform& setTranslate(const float &x, const float &y, const float &z) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Transform& setTranslate(const float &x, const float &y, const float &z) {
 				m_mat.setValue(1, 0, 0, x,
 					0, 1, 0, y,
 					0, 0, 1, z,
@@ -419,10 +1044,12 @@ namespace Aya {
 					0, 1, 0, -y,
 					0, 0, 1, -z,
 					0, 0, 0, 1);
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_TRANSLATION;
 
 				return *this;
 			}
-			AYA_FORCE_INLINE Transform& setScale(const Vector3 &scale) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Transform& setScale(const Vector3 &scale) {
 				assert(scale.x() != 0 && scale.y() != 0 && scale.z() != 0);
 				m_mat.setValue(scale.x(), 0, 0, 0,
 					0, scale.y(), 0, 0,
@@ -432,10 +1059,12 @@ namespace Aya {
 					0, 1.f / scale.y(), 0, 0,
 					0, 0, 1.f / scale.z(), 0,
 					0, 0, 0, 1);
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_SCALE;
 
 				return *this;
 			}
-			AYA_FORCE_INLINE Transform& setScale(const float &x, const float &y, const float &z) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR Transform& setScale(const float &x, const float &y, const float &z) {
 				assert(x != 0 && y != 0 && z != 0);
 				m_mat.setValue(x, 0, 0, 0,
 					0, y, 0, 0,
@@ -445,39 +1074,47 @@ namespace Aya {
 					0, 1.f / y, 0, 0,
 					0, 0, 1.f / z, 0,
 					0, 0, 0, 1);
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_SCALE;
 
 				return *this;
 			}
-			AYA_FORCE_INLINE Transform& setRotateX(const float &angle) {
-				float sin_t = sinf(Radian(angle));
-				float cos_t = cosf(Radian(angle));
+			AYA_FORCE_INLINE AYA_CONSTEXPR Transform& setRotateX(const float &angle) {
+				float sin_t, cos_t;
+				SimdMath::sincos(Radian(angle), &sin_t, &cos_t);
 				m_mat.setValue(1, 0, 0, 0,
-					0, cos_t, sin_t, 0,
-					0, sin_t, -cos_t, 0,
+					0, cos_t, -sin_t, 0,
+					0, sin_t, cos_t, 0,
 					0, 0, 0, 1);
 				m_inv = m_mat.transpose();
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_RIGID;
 
 				return *this;
 			}
-			AYA_FORCE_INLINE Transform& setRotateY(const float &angle) {
-				float sin_t = sinf(Radian(angle));
-				float cos_t = cosf(Radian(angle));
+			AYA_FORCE_INLINE AYA_CONSTEXPR Transform& setRotateY(const float &angle) {
+				float sin_t, cos_t;
+				SimdMath::sincos(Radian(angle), &sin_t, &cos_t);
 				m_mat.setValue(cos_t, 0, sin_t, 0,
 					0, 1, 0, 0,
 					-sin_t, 0, cos_t, 0,
 					0, 0, 0, 1);
 				m_inv = m_mat.transpose();
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_RIGID;
 
 				return *this;
 			}
-			AYA_FORCE_INLINE Transform& setRotateZ(const float &angle) {
-				float sin_t = sinf(Radian(angle));
-				float cos_t = cosf(Radian(angle));
+			AYA_FORCE_INLINE AYA_CONSTEXPR Transform& setRotateZ(const float &angle) {
+				float sin_t, cos_t;
+				SimdMath::sincos(Radian(angle), &sin_t, &cos_t);
 				m_mat.setValue(cos_t, -sin_t, 0, 0,
 					sin_t, cos_t, 0, 0,
 					0, 0, 1, 0,
 					0, 0, 0, 1);
 				m_inv = m_mat.transpose();
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_RIGID;
 
 				return *this;
 			}
@@ -486,96 +1123,106 @@ namespace Aya {
 				float x = a.x();
 				float y = a.y();
 				float z = a.z();
-				float s = sinf(Radian(angle));
-				float c = cosf(Radian(angle));
+				float s, c;
+				SimdMath::sincos(Radian(angle), &s, &c);
 
 				m_mat.setValue(x * x + (1.f - x * x) * c, x * y * (1.f - c) - z * s, x * z * (1.f - c) + y * s, 0,
 					x * y * (1.f - c) + z * s, y * y + (1.f - y * y) * c, y * z * (1.f - c) - x * s, 0,
 					x * z * (1.f - c) - y * s, y * z * (1.f - c) + x * s, z * z + (1.f - z * z) * c, 0,
 					0, 0, 0, 1);
 				m_inv = m_mat.transpose();
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_RIGID;
 
 				return *this;
 			}
-			void setRotation(const Quaternion& q)
+			AYA_CONSTEXPR void setRotation(const Quaternion& q)
 			{
 				float d = q.length2();
 				assert(d != 0.f);
 				float s = 2.f / d;
 
 #if defined(AYA_USE_SIMD)
-				__m128 vs, Q = q.get128();
-				__m128i Qi = _mm_castps_si128(Q);
-				__m128 Y, Z;
-				__m128 V1, V2, V3;
-				__m128 V11, V21, V31;
-				__m128 NQ = _mm_xor_ps(Q, vMzeroMask);
-				__m128i NQi = _mm_castps_si128(NQ);
-
-				V1 = _mm_castsi128_ps(_mm_shuffle_epi32(Qi, __MM_SHUFFLE(1, 0, 2, 3)));  // Y X Z W
-				V2 = _mm_shuffle_ps(NQ, Q, __MM_SHUFFLE(0, 0, 1, 3));                 // -X -X  Y  W
-				V3 = _mm_castsi128_ps(_mm_shuffle_epi32(Qi, __MM_SHUFFLE(2, 1, 0, 3)));  // Z Y X W
-				V1 = _mm_xor_ps(V1, vMPPP);                                         //	change the sign of the first element
-
-				V11 = _mm_castsi128_ps(_mm_shuffle_epi32(Qi, __MM_SHUFFLE(1, 1, 0, 3)));  // Y Y X W
-				V21 = _mm_unpackhi_ps(Q, Q);                                         //  Z  Z  W  W
-				V31 = _mm_shuffle_ps(Q, NQ, __MM_SHUFFLE(0, 2, 0, 3));                 //  X  Z -X -W
-
-				V2 = _mm_mul_ps(V2, V1);   //
-				V1 = _mm_mul_ps(V1, V11);  //
-				V3 = _mm_mul_ps(V3, V31);  //
-
-				V11 = _mm_shuffle_ps(NQ, Q, __MM_SHUFFLE(2, 3, 1, 3));                //	-Z -W  Y  W
-				V11 = _mm_mul_ps(V11, V21);                                                    //
-				V21 = _mm_xor_ps(V21, vMPPP);                                       //	change the sign of the first element
-				V31 = _mm_shuffle_ps(Q, NQ, __MM_SHUFFLE(3, 3, 1, 3));                //	 W  W -Y -W
-				V31 = _mm_xor_ps(V31, vMPPP);                                       //	change the sign of the first element
-				Y = _mm_castsi128_ps(_mm_shuffle_epi32(NQi, __MM_SHUFFLE(3, 2, 0, 3)));  // -W -Z -X -W
-				Z = _mm_castsi128_ps(_mm_shuffle_epi32(Qi, __MM_SHUFFLE(1, 0, 1, 3)));   //  Y  X  Y  W
-
-				vs = _mm_load_ss(&s);
-				V21 = _mm_mul_ps(V21, Y);
-				V31 = _mm_mul_ps(V31, Z);
-
-				V1 = _mm_add_ps(V1, V11);
-				V2 = _mm_add_ps(V2, V21);
-				V3 = _mm_add_ps(V3, V31);
-
-				vs = _mm_splat3_ps(vs, 0);
-				//	s ready
-				V1 = _mm_mul_ps(V1, vs);
-				V2 = _mm_mul_ps(V2, vs);
-				V3 = _mm_mul_ps(V3, vs);
-
-				V1 = _mm_add_ps(V1, v1000);
-				V2 = _mm_add_ps(V2, v0100);
-				V3 = _mm_add_ps(V3, v0010);
-
-				m_mat[0] = V1;
-				m_mat[1] = V2;
-				m_mat[2] = V3;
-				m_mat[3] = v0001;
-#else
-				float xs = q.x() * s, ys = q.y() * s, zs = q.z() * s;
-				float wx = q.w() * xs, wy = q.w() * ys, wz = q.w() * zs;
-				float xx = q.x() * xs, xy = q.x() * ys, xz = q.x() * zs;
-				float yy = q.y() * ys, yz = q.y() * zs, zz = q.z() * zs;
-
-				m_mat.setValue(
-					1.f - (yy + zz), xy - wz, xz + wy, 0,
-					xy + wz, 1.f - (xx + zz), yz - wx, 0,
-					xz - wy, yz + wx, 1.f - (xx + yy), 0,
-					0, 0, 0, 1);
+				if (!AYA_CONSTANT_EVALUATED()) {
+					__m128 vs, Q = q.get128();
+					__m128i Qi = _mm_castps_si128(Q);
+					__m128 Y, Z;
+					__m128 V1, V2, V3;
+					__m128 V11, V21, V31;
+					__m128 NQ = _mm_xor_ps(Q, vMzeroMask);
+					__m128i NQi = _mm_castps_si128(NQ);
+
+					V1 = _mm_castsi128_ps(_mm_shuffle_epi32(Qi, __MM_SHUFFLE(1, 0, 2, 3)));  // Y X Z W
+					V2 = _mm_shuffle_ps(NQ, Q, __MM_SHUFFLE(0, 0, 1, 3));                 // -X -X  Y  W
+					V3 = _mm_castsi128_ps(_mm_shuffle_epi32(Qi, __MM_SHUFFLE(2, 1, 0, 3)));  // Z Y X W
+					V1 = _mm_xor_ps(V1, vMPPP);                                         //	change the sign of the first element
+
+					V11 = _mm_castsi128_ps(_mm_shuffle_epi32(Qi, __MM_SHUFFLE(1, 1, 0, 3)));  // Y Y X W
+					V21 = _mm_unpackhi_ps(Q, Q);                                         //  Z  Z  W  W
+					V31 = _mm_shuffle_ps(Q, NQ, __MM_SHUFFLE(0, 2, 0, 3));                 //  X  Z -X -W
+
+					V2 = _mm_mul_ps(V2, V1);   //
+					V1 = _mm_mul_ps(V1, V11);  //
+					V3 = _mm_mul_ps(V3, V31);  //
+
+					V11 = _mm_shuffle_ps(NQ, Q, __MM_SHUFFLE(2, 3, 1, 3));                //	-Z -W  Y  W
+					V11 = _mm_mul_ps(V11, V21);                                                    //
+					V21 = _mm_xor_ps(V21, vMPPP);                                       //	change the sign of the first element
+					V31 = _mm_shuffle_ps(Q, NQ, __MM_SHUFFLE(3, 3, 1, 3));                //	 W  W -Y -W
+					V31 = _mm_xor_ps(V31, vMPPP);                                       //	change the sign of the first element
+					Y = _mm_castsi128_ps(_mm_shuffle_epi32(NQi, __MM_SHUFFLE(3, 2, 0, 3)));  // -W -Z -X -W
+					Z = _mm_castsi128_ps(_mm_shuffle_epi32(Qi, __MM_SHUFFLE(1, 0, 1, 3)));   //  Y  X  Y  W
+
+					vs = _mm_load_ss(&s);
+					V21 = _mm_mul_ps(V21, Y);
+					V31 = _mm_mul_ps(V31, Z);
+
+					V1 = _mm_add_ps(V1, V11);
+					V2 = _mm_add_ps(V2, V21);
+					V3 = _mm_add_ps(V3, V31);
+
+					vs = _mm_splat3_ps(vs, 0);
+					//	s ready
+					V1 = _mm_mul_ps(V1, vs);
+					V2 = _mm_mul_ps(V2, vs);
+					V3 = _mm_mul_ps(V3, vs);
+
+					V1 = _mm_add_ps(V1, v1000);
+					V2 = _mm_add_ps(V2, v0100);
+					V3 = _mm_add_ps(V3, v0010);
+
+					m_mat[0] = V1;
+					m_mat[1] = V2;
+					m_mat[2] = V3;
+					m_mat[3] = v0001;
+				}
+				else
 #endif
+				{
+					float xs = q.x() * s, ys = q.y() * s, zs = q.z() * s;
+					float wx = q.w() * xs, wy = q.w() * ys, wz = q.w() * zs;
+					float xx = q.x() * xs, xy = q.x() * ys, xz = q.x() * zs;
+					float yy = q.y() * ys, yz = q.y() * zs, zz = q.z() * zs;
+
+					m_mat.setValue(
+						1.f - (yy + zz), xy - wz, xz + wy, 0,
+						xy + wz, 1.f - (xx + zz), yz - wx, 0,
+						xz - wy, yz + wx, 1.f - (xx + yy), 0,
+						0, 0, 0, 1);
+				}
 				m_inv = m_mat.transpose();
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_RIGID;
 			}
 			AYA_FORCE_INLINE Transform& setEulerZYX(const float &e_x, const float &e_y, const float &e_z) {
-				float ci(cosf(Radian(e_x)));
-				float cj(cosf(Radian(e_y)));
-				float ch(cosf(Radian(e_z)));
-				float si(sinf(Radian(e_x)));
-				float sj(sinf(Radian(e_y)));
-				float sh(sinf(Radian(e_z)));
+				float angles[3] = { Radian(e_x), Radian(e_y), Radian(e_z) }, s[3], c[3];
+				SimdMath::sincos(angles, s, c, 3);
+				float ci(c[0]);
+				float cj(c[1]);
+				float ch(c[2]);
+				float si(s[0]);
+				float sj(s[1]);
+				float sh(s[2]);
 				float cc = ci * ch;
 				float cs = ci * sh;
 				float sc = si * ch;
@@ -586,6 +1233,8 @@ namespace Aya {
 					-sj, cj * si, cj * ci, 0,
 					0, 0, 0, 1);
 				m_inv = m_mat.transpose();
+				m_inv_state = INVERSE_VALID;
+				m_kind = TRANSFORM_RIGID;
 
 				return *this;
 			}
@@ -594,11 +1243,30 @@ namespace Aya {
 			}
 
 			AYA_FORCE_INLINE Vector3 operator() (const Vector3 &v) const {
+				if (m_kind <= TRANSFORM_TRANSLATION)
+					return v;
+#if defined(AYA_USE_SIMD)
+				// build the homogeneous vector in register instead of going through memory
+				QuadWord r = m_mat * QuadWord(_mm_and_ps(v.m_val128, vFFF0fMask));
+				return Vector3(_mm_and_ps(r.m_val128, vFFF0fMask));
+#else
 				QuadWord r = m_mat * QuadWord(v.x(), v.y(), v.z(), 0.f);
 				return Vector3(r.x(), r.y(), r.z());
+#endif
 			}
 			AYA_FORCE_INLINE Point3 operator() (const Point3 &p) const {
+				if (m_kind <= TRANSFORM_TRANSLATION)
+					return Point3(p.x() + m_mat[0][3], p.y() + m_mat[1][3], p.z() + m_mat[2][3]);
+#if defined(AYA_USE_SIMD)
+				QuadWord r = m_mat * QuadWord(_mm_or_ps(_mm_and_ps(p.m_val128, vFFF0fMask), v0001));
+				if (m_kind != TRANSFORM_PROJECTIVE)
+					return Point3(_mm_and_ps(r.m_val128, vFFF0fMask));
+#else
 				QuadWord r = m_mat * QuadWord(p.x(), p.y(), p.z(), 1.f);
+				if (m_kind != TRANSFORM_PROJECTIVE)
+					return Point3(r.x(), r.y(), r.z());
+#endif
+
 				assert(r.w() != 0.f);
 				if (r.w() == 1.f)
 					return Point3(r.x(), r.y(), r.z());
@@ -608,10 +1276,39 @@ namespace Aya {
 				}
 			}
 			AYA_FORCE_INLINE Normal3 operator() (const Normal3 &n) const {
-				QuadWord r = m_inv.transpose() * QuadWord(n.x(), n.y(), n.z(), 0.f);
+				if (m_kind <= TRANSFORM_TRANSLATION)
+					return n;
+				QuadWord r;
+				// the inverse transpose of a rotation is itself
+				if (m_kind == TRANSFORM_RIGID)
+					r = m_mat * QuadWord(n.x(), n.y(), n.z(), 0.f);
+				// (M^-1)^T * n == n * M^-1, the row-vector product needs no transpose
+				else
+					r = QuadWord(n.x(), n.y(), n.z(), 0.f) * getInverseMatrix();
 				return Normal3(r.x(), r.y(), r.z());
 			}
 			AYA_FORCE_INLINE BBox operator() (const BBox &b) const {
+				if (m_kind <= TRANSFORM_TRANSLATION) {
+					const Vector3 t(m_mat[0][3], m_mat[1][3], m_mat[2][3]);
+					BBox ret;
+					ret.m_pmin = b.m_pmin + t;
+					ret.m_pmax = b.m_pmax + t;
+					return ret;
+				}
+				if (m_kind != TRANSFORM_PROJECTIVE) {
+					// Arvo: the extent along each output axis is the absolute row times the half size
+					Point3 mid = (b.m_pmax + b.m_pmin) * .5f;
+					Vector3 c = (b.m_pmax - b.m_pmin) * .5f;
+					QuadWord e = m_mat.absolute() * QuadWord(c.x(), c.y(), c.z(), 0.f);
+					Vector3 ext(e.x(), e.y(), e.z());
+					mid = (*this)(mid);
+
+					BBox ret;
+					ret.m_pmax = mid + ext;
+					ret.m_pmin = mid - ext;
+					return ret;
+				}
+
 				const Transform &M = *this;
 				BBox ret(M(Point3(b.m_pmin.x(), b.m_pmin.y(), b.m_pmin.z())));
 				ret.unity(M(Point3(b.m_pmax.x(), b.m_pmin.y(), b.m_pmin.z())));
@@ -642,12 +1339,51 @@ namespace Aya {
 				return ret;
 			}
 
+			// Batched versions of operator(), in and out may alias. The batch evaluates each component
+			// as one multiply-add chain, so it can differ from operator() in the last bits.
+			AYA_FORCE_INLINE void apply(const Point3 *in, Point3 *out, const size_t &n) const {
+				if (m_kind == TRANSFORM_IDENTITY)
+					TransformKernel::copy(in, out, n);
+				else
+					TransformKernel(m_mat, true).apply(in, out, n);
+			}
+			AYA_FORCE_INLINE void apply(const Vector3 *in, Vector3 *out, const size_t &n) const {
+				if (m_kind <= TRANSFORM_TRANSLATION)
+					TransformKernel::copy(in, out, n);
+				else
+					TransformKernel(m_mat, false).apply(in, out, n);
+			}
+			AYA_FORCE_INLINE void apply(const Normal3 *in, Normal3 *out, const size_t &n) const {
+				if (m_kind <= TRANSFORM_TRANSLATION)
+					TransformKernel::copy(in, out, n);
+				else if (m_kind == TRANSFORM_RIGID)
+					TransformKernel(m_mat, false).apply(in, out, n);
+				else
+					TransformKernel::normalKernel(getInverseMatrix()).apply(in, out, n);
+			}
+			AYA_FORCE_INLINE void apply(const Ray *in, Ray *out, const size_t &n) const {
+				if (m_kind == TRANSFORM_IDENTITY)
+					TransformKernel::copy(in, out, n);
+				else
+					TransformKernel::applyRays(TransformKernel(m_mat, true), TransformKernel(m_mat, false), in, out, n);
+			}
+
 			friend inline std::ostream &operator<<(std::ostream &os, const Transform &t) {
 				os << t.m_mat << ",\n";
-				os << t.m_inv;
+				os << t.getInverseMatrix();
 
 				return os;
 			}
+
+		private:
+			// A constant-evaluated transform can neither fill the mutable cache later nor have it
+			// read back once it is a constexpr object, so the inverse is computed up front there.
+			AYA_FORCE_INLINE AYA_CONSTEXPR void bakeInverse() {
+				if (AYA_CONSTANT_EVALUATED()) {
+					m_inv = computeInverseMatrix();
+					m_inv_state = INVERSE_VALID;
+				}
+			}
 	};
 }
 #endif
\ No newline at end of file
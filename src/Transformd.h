@@ -0,0 +1,240 @@
+#ifndef AYA_MATH_TRANSFORMD_H
+#define AYA_MATH_TRANSFORMD_H
+
+#include "Transform.h"
+#include "Vector3d.h"
+#include "Matrix4x4d.h"
+
+namespace Aya {
+		// Double precision Transform for large-world placement. Compose in double, then hand
+		// the renderer a float Transform relative to a local origin with toLocal().
+		class AYA_ALIGN(32) Transformd {
+		public:
+			// m_inv is only meaningful once m_inv_state is INVERSE_VALID (identity until then, so copies
+			// never read uninitialized memory), read it through getInverseMatrix()
+			Matrix4x4d m_mat;
+			mutable Matrix4x4d m_inv;
+			mutable InverseFlag m_inv_state;
+
+		public:
+			Transformd() : m_inv_state(INVERSE_VALID) {
+				m_mat.setIdentity();
+				m_inv.setIdentity();
+			}
+			// The inverse of m is computed on first use
+			explicit AYA_FORCE_INLINE Transformd(const Matrix4x4d &m) :
+				m_mat(m), m_inv_state(INVERSE_NONE) {
+				m_inv.setIdentity();
+			}
+			explicit AYA_FORCE_INLINE Transformd(const Matrix4x4d &m, const Matrix4x4d &inv) :
+				m_mat(m), m_inv(inv), m_inv_state(INVERSE_VALID) {}
+			explicit AYA_FORCE_INLINE Transformd(const Transform &t) :
+				m_mat(t.m_mat), m_inv(t.getInverseMatrix()), m_inv_state(INVERSE_VALID) {}
+
+			AYA_FORCE_INLINE Transformd(const Transformd &rhs) :
+				m_mat(rhs.m_mat), m_inv_state(INVERSE_NONE) {
+				if (rhs.hasInverse()) {
+					m_inv = rhs.m_inv;
+					m_inv_state = INVERSE_VALID;
+				}
+				else
+					m_inv.setIdentity();
+			}
+			AYA_FORCE_INLINE Transformd& operator = (const Transformd &rhs) {
+				m_mat = rhs.m_mat;
+				if (rhs.hasInverse()) {
+					m_inv = rhs.m_inv;
+					m_inv_state = INVERSE_VALID;
+				}
+				else
+					m_inv_state = INVERSE_NONE;
+				return *this;
+			}
+#if defined(AYA_USE_AVX)
+			AYA_FORCE_INLINE void  *operator new(size_t i) {
+				return _mm_malloc(i, 32);
+			}
+
+			AYA_FORCE_INLINE void operator delete(void *p) {
+				_mm_free(p);
+			}
+#endif
+
+			AYA_FORCE_INLINE bool hasInverse() const {
+				return m_inv_state.load(std::memory_order_acquire) == INVERSE_VALID;
+			}
+			// Computes and caches the inverse on first call, safe to call from several threads
+			AYA_FORCE_INLINE const Matrix4x4d& getInverseMatrix() const {
+				if (!hasInverse())
+					LazyInverse(m_inv_state, [this]() {
+						m_inv = m_mat.inverse();
+					});
+				return m_inv;
+			}
+			AYA_FORCE_INLINE Transformd inverse() const {
+				return Transformd(getInverseMatrix(), m_mat);
+			}
+
+			AYA_FORCE_INLINE Transformd operator * (const Transformd &t) const {
+				return Transformd(m_mat * t.m_mat);
+			}
+			AYA_FORCE_INLINE Transformd& operator *= (const Transformd &t) {
+				m_mat *= t.m_mat;
+				m_inv_state = INVERSE_NONE;
+				return *this;
+			}
+
+			// Float transform into the frame centred at origin, T(-origin) * this. The
+			// translation is folded in double, so only the local offset gets rounded.
+			AYA_FORCE_INLINE Transform toLocal(const Point3d &origin) const {
+				Matrix4x4d m = m_mat;
+				Matrix4x4d inv = getInverseMatrix();
+				for (int i = 0; i < 3; i++) {
+					// row i -= origin[i] * row 3, and column 3 of the inverse += inv * origin
+					m[i][0] -= origin[i] * m_mat[3][0];
+					m[i][1] -= origin[i] * m_mat[3][1];
+					m[i][2] -= origin[i] * m_mat[3][2];
+					m[i][3] -= origin[i] * m_mat[3][3];
+				}
+				for (int i = 0; i < 4; i++)
+					inv[i][3] += inv[i][0] * origin[0] + inv[i][1] * origin[1] + inv[i][2] * origin[2];
+				return Transform(m.toFloat(), inv.toFloat());
+			}
+
+			AYA_FORCE_INLINE Transformd& setTranslate(const Vector3d &delta) {
+				return setTranslate(delta.x(), delta.y(), delta.z());
+			}
+			AYA_FORCE_INLINE Transformd& setTranslate(const double &x, const double &y, const double &z) {
+				m_mat.setValue(1, 0, 0, x,
+					0, 1, 0, y,
+					0, 0, 1, z,
+					0, 0, 0, 1);
+				m_inv.setValue(1, 0, 0, -x,
+					0, 1, 0, -y,
+					0, 0, 1, -z,
+					0, 0, 0, 1);
+				m_inv_state = INVERSE_VALID;
+
+				return *this;
+			}
+			AYA_FORCE_INLINE Transformd& setScale(const Vector3d &scale) {
+				return setScale(scale.x(), scale.y(), scale.z());
+			}
+			AYA_FORCE_INLINE Transformd& setScale(const double &x, const double &y, const double &z) {
+				assert(x != 0 && y != 0 && z != 0);
+				m_mat.setValue(x, 0, 0, 0,
+					0, y, 0, 0,
+					0, 0, z, 0,
+					0, 0, 0, 1);
+				m_inv.setValue(1. / x, 0, 0, 0,
+					0, 1. / y, 0, 0,
+					0, 0, 1. / z, 0,
+					0, 0, 0, 1);
+				m_inv_state = INVERSE_VALID;
+
+				return *this;
+			}
+			AYA_FORCE_INLINE Transformd& setRotateX(const double &angle) {
+				double sin_t = sin(angle * (M_PI / 180.));
+				double cos_t = cos(angle * (M_PI / 180.));
+				m_mat.setValue(1, 0, 0, 0,
+					0, cos_t, -sin_t, 0,
+					0, sin_t, cos_t, 0,
+					0, 0, 0, 1);
+				m_inv = m_mat.transpose();
+				m_inv_state = INVERSE_VALID;
+
+				return *this;
+			}
+			AYA_FORCE_INLINE Transformd& setRotateY(const double &angle) {
+				double sin_t = sin(angle * (M_PI / 180.));
+				double cos_t = cos(angle * (M_PI / 180.));
+				m_mat.setValue(cos_t, 0, sin_t, 0,
+					0, 1, 0, 0,
+					-sin_t, 0, cos_t, 0,
+					0, 0, 0, 1);
+				m_inv = m_mat.transpose();
+				m_inv_state = INVERSE_VALID;
+
+				return *this;
+			}
+			AYA_FORCE_INLINE Transformd& setRotateZ(const double &angle) {
+				double sin_t = sin(angle * (M_PI / 180.));
+				double cos_t = cos(angle * (M_PI / 180.));
+				m_mat.setValue(cos_t, -sin_t, 0, 0,
+					sin_t, cos_t, 0, 0,
+					0, 0, 1, 0,
+					0, 0, 0, 1);
+				m_inv = m_mat.transpose();
+				m_inv_state = INVERSE_VALID;
+
+				return *this;
+			}
+
+			AYA_FORCE_INLINE Vector3d operator() (const Vector3d &v) const {
+				QuadWordd r = m_mat * v;
+				return Vector3d(r.x(), r.y(), r.z());
+			}
+			AYA_FORCE_INLINE Point3d operator() (const Point3d &p) const {
+#if defined(AYA_USE_AVX)
+				QuadWordd r = m_mat * QuadWordd(_mm256_blend_pd(p.m_val256, vd0001, 0x8));
+#else
+				QuadWordd r = m_mat * QuadWordd(p.x(), p.y(), p.z(), 1.);
+#endif
+				assert(r.w() != 0.);
+				if (r.w() == 1.)
+					return Point3d(r.x(), r.y(), r.z());
+				double inv = 1. / r.w();
+				return Point3d(r.x() * inv, r.y() * inv, r.z() * inv);
+			}
+
+			AYA_FORCE_INLINE Normal3d operator() (const Normal3d &n) const {
+				// (M^-1)^T * n, each output component is a column of the inverse dotted with n
+				const Matrix4x4d &inv = getInverseMatrix();
+				return Normal3d(inv[0][0] * n.x() + inv[1][0] * n.y() + inv[2][0] * n.z(),
+					inv[0][1] * n.x() + inv[1][1] * n.y() + inv[2][1] * n.z(),
+					inv[0][2] * n.x() + inv[1][2] * n.y() + inv[2][2] * n.z());
+			}
+
+			// Float boxes and rays are carried through in double and rounded once at the end
+			AYA_FORCE_INLINE BBox operator() (const BBox &b) const {
+				const Transformd &M = *this;
+				BBox ret(M(Point3d(b.m_pmin.x(), b.m_pmin.y(), b.m_pmin.z())).toFloat());
+				ret.unity(M(Point3d(b.m_pmax.x(), b.m_pmin.y(), b.m_pmin.z())).toFloat());
+				ret.unity(M(Point3d(b.m_pmin.x(), b.m_pmax.y(), b.m_pmin.z())).toFloat());
+				ret.unity(M(Point3d(b.m_pmin.x(), b.m_pmin.y(), b.m_pmax.z())).toFloat());
+				ret.unity(M(Point3d(b.m_pmin.x(), b.m_pmax.y(), b.m_pmax.z())).toFloat());
+				ret.unity(M(Point3d(b.m_pmax.x(), b.m_pmax.y(), b.m_pmin.z())).toFloat());
+				ret.unity(M(Point3d(b.m_pmax.x(), b.m_pmin.y(), b.m_pmax.z())).toFloat());
+				ret.unity(M(Point3d(b.m_pmax.x(), b.m_pmax.y(), b.m_pmax.z())).toFloat());
+				return ret;
+			}
+			AYA_FORCE_INLINE Ray operator() (const Ray &r) const {
+				Ray ret = r;
+				ret.m_ori = (*this)(Point3d(r.m_ori)).toFloat();
+				ret.m_dir = (*this)(Vector3d(r.m_dir)).toFloat();
+
+				return ret;
+			}
+			AYA_FORCE_INLINE RayDifferential operator() (const RayDifferential &r) const {
+				RayDifferential ret = r;
+				ret.m_ori = (*this)(Point3d(r.m_ori)).toFloat();
+				ret.m_dir = (*this)(Vector3d(r.m_dir)).toFloat();
+				ret.m_rx_ori = (*this)(Point3d(r.m_rx_ori)).toFloat();
+				ret.m_ry_ori = (*this)(Point3d(r.m_ry_ori)).toFloat();
+				ret.m_rx_dir = (*this)(Vector3d(r.m_rx_dir)).toFloat();
+				ret.m_ry_dir = (*this)(Vector3d(r.m_ry_dir)).toFloat();
+
+				return ret;
+			}
+
+			friend inline std::ostream &operator<<(std::ostream &os, const Transformd &t) {
+				os << t.m_mat << ",\n";
+				os << t.getInverseMatrix();
+
+				return os;
+			}
+	};
+}
+
+#endif
@@ -78,19 +78,19 @@ namespace Aya {
 			return *this;
 		}
 		AYA_FORCE_INLINE Vector2 operator << (const uint32_t &v) const {
-			return Vector2(x << v.x, y << v.y);
+			return Vector2(x << v, y << v);
 		}
 		AYA_FORCE_INLINE Vector2 & operator <<= (const uint32_t &v) {
-			x <<= v.x;
-			y <<= v.y;
+			x <<= v;
+			y <<= v;
 			return *this;
 		}
 		AYA_FORCE_INLINE Vector2 operator >> (const uint32_t &v) const {
-			return Vector2(x >> v.x, y >> v.y);
+			return Vector2(x >> v, y >> v);
 		}
 		AYA_FORCE_INLINE Vector2 & operator >>= (const uint32_t &v) {
-			x >>= v.x;
-			y >>= v.y;
+			x >>= v;
+			y >>= v;
 			return *this;
 		}
 
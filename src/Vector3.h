@@ -2,6 +2,7 @@
 #define AYA_MATH_VECTOR3_H
 
 #include "MathUtility.h"
+#include "SimdMath.h"
 
 #if defined(AYA_USE_SIMD)
 /* expands to the following value */
@@ -42,13 +43,23 @@
 #define _mm_swizzle(_a, x, y, z, w) _mm_swizzle_mask(_a, __MM_SHUFFLE(x, y, z, w))
 #define _mm_swizzle1(_a, x) _mm_swizzle_mask(_a, __MM_SHUFFLE(x, x, x, x))
 #define _mm_shuffle2(_a, _b, x, y, z, w)    _mm_shuffle_ps(_a, _b, __MM_SHUFFLE(x, y, z, w))
+
+/* _a * _b + _c and _a * _b - _c, fused when FMA is available */
+#if defined(AYA_USE_FMA)
+#define _mm_madd_ps(_a, _b, _c) _mm_fmadd_ps((_a), (_b), (_c))
+#define _mm_msub_ps(_a, _b, _c) _mm_fmsub_ps((_a), (_b), (_c))
+#define _mm256_madd_ps(_a, _b, _c) _mm256_fmadd_ps((_a), (_b), (_c))
+#define _mm512_madd_ps(_a, _b, _c) _mm512_fmadd_ps((_a), (_b), (_c))
+#else
+#define _mm_madd_ps(_a, _b, _c) _mm_add_ps(_mm_mul_ps((_a), (_b)), (_c))
+#define _mm_msub_ps(_a, _b, _c) _mm_sub_ps(_mm_mul_ps((_a), (_b)), (_c))
+#define _mm256_madd_ps(_a, _b, _c) _mm256_add_ps(_mm256_mul_ps((_a), (_b)), (_c))
+#define _mm512_madd_ps(_a, _b, _c) _mm512_add_ps(_mm512_mul_ps((_a), (_b)), (_c))
+#endif
 #endif
 
 namespace Aya {
-#if defined(AYA_USE_SIMD)
-	__declspec(align(16))
-#endif
-		class QuadWord {
+		class AYA_SIMD_ALIGN QuadWord {
 #if defined(AYA_USE_SIMD)
 		public:
 			union {
@@ -73,8 +84,8 @@ namespace Aya {
 #endif
 
 		public:
-			QuadWord() {}
-			AYA_FORCE_INLINE QuadWord(const float &x, const float &y, const float &z, const float &w) {
+			AYA_CONSTEXPR QuadWord() {}
+			AYA_FORCE_INLINE AYA_CONSTEXPR QuadWord(const float &x, const float &y, const float &z, const float &w) {
 				m_val[0] = x;
 				m_val[1] = y;
 				m_val[2] = z;
@@ -95,32 +106,46 @@ namespace Aya {
 			AYA_FORCE_INLINE QuadWord(const __m128 &v128) {
 				m_val128 = v128;
 			}
-			AYA_FORCE_INLINE QuadWord(const QuadWord &rhs) {
-				m_val128 = rhs.m_val128;
+			AYA_FORCE_INLINE AYA_CONSTEXPR QuadWord(const QuadWord &rhs) {
+				copyFrom(rhs);
 			}
-			AYA_FORCE_INLINE QuadWord& operator = (const QuadWord &rhs) {
-				m_val128 = rhs.m_val128;
+			AYA_FORCE_INLINE AYA_CONSTEXPR QuadWord& operator = (const QuadWord &rhs) {
+				copyFrom(rhs);
 				return *this;
 			}
 #endif
-
-			AYA_FORCE_INLINE void setX(const float &x) { m_val[0] = x; }
-			AYA_FORCE_INLINE void setY(const float &y) { m_val[1] = y; }
-			AYA_FORCE_INLINE void setZ(const float &z) { m_val[2] = z; }
-			AYA_FORCE_INLINE void setW(const float &w) { m_val[3] = w; }
-			AYA_FORCE_INLINE const float& getX() const { return m_val[0]; }
-			AYA_FORCE_INLINE const float& getY() const { return m_val[1]; }
-			AYA_FORCE_INLINE const float& getZ() const { return m_val[2]; }
-			AYA_FORCE_INLINE const float& x() const { return m_val[0]; }
-			AYA_FORCE_INLINE const float& y() const { return m_val[1]; }
-			AYA_FORCE_INLINE const float& z() const { return m_val[2]; }
-			AYA_FORCE_INLINE const float& w() const { return m_val[3]; }
-
-			AYA_FORCE_INLINE float operator [](const int &p) const {
+			// Whole-register copy, element-wise while constant evaluating since the
+			// compiler only tracks the float lanes there.
+			AYA_FORCE_INLINE AYA_CONSTEXPR void copyFrom(const QuadWord &rhs) {
+#if defined(AYA_USE_SIMD)
+				if (!AYA_CONSTANT_EVALUATED()) {
+					m_val128 = rhs.m_val128;
+					return;
+				}
+#endif
+				m_val[0] = rhs.m_val[0];
+				m_val[1] = rhs.m_val[1];
+				m_val[2] = rhs.m_val[2];
+				m_val[3] = rhs.m_val[3];
+			}
+
+			AYA_FORCE_INLINE AYA_CONSTEXPR void setX(const float &x) { m_val[0] = x; }
+			AYA_FORCE_INLINE AYA_CONSTEXPR void setY(const float &y) { m_val[1] = y; }
+			AYA_FORCE_INLINE AYA_CONSTEXPR void setZ(const float &z) { m_val[2] = z; }
+			AYA_FORCE_INLINE AYA_CONSTEXPR void setW(const float &w) { m_val[3] = w; }
+			AYA_FORCE_INLINE AYA_CONSTEXPR const float& getX() const { return m_val[0]; }
+			AYA_FORCE_INLINE AYA_CONSTEXPR const float& getY() const { return m_val[1]; }
+			AYA_FORCE_INLINE AYA_CONSTEXPR const float& getZ() const { return m_val[2]; }
+			AYA_FORCE_INLINE AYA_CONSTEXPR const float& x() const { return m_val[0]; }
+			AYA_FORCE_INLINE AYA_CONSTEXPR const float& y() const { return m_val[1]; }
+			AYA_FORCE_INLINE AYA_CONSTEXPR const float& z() const { return m_val[2]; }
+			AYA_FORCE_INLINE AYA_CONSTEXPR const float& w() const { return m_val[3]; }
+
+			AYA_FORCE_INLINE AYA_CONSTEXPR float operator [](const int &p) const {
 				assert(p >= 0 && p <= 3);
 				return m_val[p];
 			}
-			AYA_FORCE_INLINE float &operator [](const int &p) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR float &operator [](const int &p) {
 				assert(p >= 0 && p <= 3);
 				return m_val[p];
 			}
@@ -135,22 +160,20 @@ namespace Aya {
 			}
 	};
 
-#if defined(AYA_USE_SIMD)
-	__declspec(align(16))
-#endif
-		class BaseVector3 : public QuadWord {
+		class AYA_SIMD_ALIGN BaseVector3 : public QuadWord {
 #if defined(AYA_DEBUG)
 		private:
-			AYA_FORCE_INLINE void numericValid(int x) {
-				assert(!isnan(m_val[0]) && !isnan(m_val[1]) && !isnan(m_val[2]));
+			AYA_FORCE_INLINE AYA_CONSTEXPR void numericValid(int x) {
+				if (!AYA_CONSTANT_EVALUATED())
+					assert(!isnan(m_val[0]) && !isnan(m_val[1]) && !isnan(m_val[2]));
 			}
 #else
 #define numericValid
 #endif
 
 		public:
-			BaseVector3() {}
-			AYA_FORCE_INLINE BaseVector3(const float &x, const float &y, const float &z) {
+			AYA_CONSTEXPR BaseVector3() {}
+			AYA_FORCE_INLINE AYA_CONSTEXPR BaseVector3(const float &x, const float &y, const float &z) {
 				m_val[0] = x;
 				m_val[1] = y;
 				m_val[2] = z;
@@ -162,15 +185,15 @@ namespace Aya {
 			AYA_FORCE_INLINE BaseVector3(const __m128 &v128) {
 				m_val128 = v128;
 			}
-			AYA_FORCE_INLINE BaseVector3(const BaseVector3 &rhs) {
-				m_val128 = rhs.m_val128;
+			AYA_FORCE_INLINE AYA_CONSTEXPR BaseVector3(const BaseVector3 &rhs) {
+				copyFrom(rhs);
 			}
-			AYA_FORCE_INLINE BaseVector3& operator = (const BaseVector3 &rhs) {
-				m_val128 = rhs.m_val128;
+			AYA_FORCE_INLINE AYA_CONSTEXPR BaseVector3& operator = (const BaseVector3 &rhs) {
+				copyFrom(rhs);
 				return *this;
 			}
 #endif
-			AYA_FORCE_INLINE void setValue(const float &x, const float &y, const float &z) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR void setValue(const float &x, const float &y, const float &z) {
 				m_val[0] = x;
 				m_val[1] = y;
 				m_val[2] = z;
@@ -178,160 +201,189 @@ namespace Aya {
 				numericValid(1);
 			}
 
-			AYA_FORCE_INLINE bool operator == (const BaseVector3 &v) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR bool operator == (const BaseVector3 &v) const {
 #if defined(AYA_USE_SIMD)
-				return (0xf == _mm_movemask_ps((__m128)_mm_cmpeq_ps(m_val128, v.m_val128)));
-#else
+				if (!AYA_CONSTANT_EVALUATED()) {
+					return (0xf == _mm_movemask_ps((__m128)_mm_cmpeq_ps(m_val128, v.m_val128)));
+				}
+#endif
 				return ((m_val[0] == v.m_val[0]) &&
 					(m_val[1] == v.m_val[1]) &&
 					(m_val[2] == v.m_val[2]) &&
 					(m_val[3] == v.m_val[3]));
-#endif
 			}
-			AYA_FORCE_INLINE bool operator != (const BaseVector3 &v) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR bool operator != (const BaseVector3 &v) const {
 				return !((*this) == v);
 			}
 
-			AYA_FORCE_INLINE void setMax(const BaseVector3 &v) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR void setMax(const BaseVector3 &v) {
 #if defined(AYA_USE_SIMD)
-				m_val128 = _mm_max_ps(m_val128, v.m_val128);
-#else
-				SetMax(m_val[0], v.m_val[0]);
-				SetMax(m_val[1], v.m_val[1]);
-				SetMax(m_val[2], v.m_val[2]);
+				if (!AYA_CONSTANT_EVALUATED()) {
+					m_val128 = _mm_max_ps(m_val128, v.m_val128);
+				}
+				else
 #endif
+				{
+					SetMax(m_val[0], v.m_val[0]);
+					SetMax(m_val[1], v.m_val[1]);
+					SetMax(m_val[2], v.m_val[2]);
+				}
 			}
-			AYA_FORCE_INLINE void setMin(const BaseVector3 &v) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR void setMin(const BaseVector3 &v) {
 #if defined(AYA_USE_SIMD)
-				m_val128 = _mm_min_ps(m_val128, v.m_val128);
-#else
-				SetMin(m_val[0], v.m_val[0]);
-				SetMin(m_val[1], v.m_val[1]);
-				SetMin(m_val[2], v.m_val[2]);
+				if (!AYA_CONSTANT_EVALUATED()) {
+					m_val128 = _mm_min_ps(m_val128, v.m_val128);
+				}
+				else
 #endif
+				{
+					SetMin(m_val[0], v.m_val[0]);
+					SetMin(m_val[1], v.m_val[1]);
+					SetMin(m_val[2], v.m_val[2]);
+				}
 			}
-			AYA_FORCE_INLINE void setZero() {
+			AYA_FORCE_INLINE AYA_CONSTEXPR void setZero() {
 #if defined(AYA_USE_SIMD)
-				m_val128 = _mm_xor_ps(m_val128, m_val128);
-#else
-				m_val[0] = 0.f;
-				m_val[1] = 0.f;
-				m_val[2] = 0.f;
-				m_val[3] = 0.f;
+				if (!AYA_CONSTANT_EVALUATED()) {
+					m_val128 = _mm_xor_ps(m_val128, m_val128);
+				}
+				else
 #endif
+				{
+					m_val[0] = 0.f;
+					m_val[1] = 0.f;
+					m_val[2] = 0.f;
+					m_val[3] = 0.f;
+				}
 			}
 
-			AYA_FORCE_INLINE bool isZero() const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR bool isZero() const {
 				return (m_val[0] == 0.f && m_val[1] == 0.f && m_val[2] == 0.f);
 			}
-			AYA_FORCE_INLINE bool fuzzyZero() const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR bool fuzzyZero() const {
 				return length2() < AYA_EPSILON * AYA_EPSILON;
 			}
 
-			AYA_FORCE_INLINE BaseVector3 operator + (const BaseVector3 &v) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR BaseVector3 operator + (const BaseVector3 &v) const {
 #if defined(AYA_USE_SIMD)
-				return BaseVector3(_mm_add_ps(m_val128, v.m_val128));
-#else
+				if (!AYA_CONSTANT_EVALUATED()) {
+					return BaseVector3(_mm_add_ps(m_val128, v.m_val128));
+				}
+#endif
 				return BaseVector3(m_val[0] + v.m_val[0],
 					m_val[1] + v.m_val[1],
 					m_val[2] + v.m_val[2]);
-#endif
 			}
-			AYA_FORCE_INLINE BaseVector3 & operator += (const BaseVector3 &v) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR BaseVector3 & operator += (const BaseVector3 &v) {
 #if defined(AYA_USE_SIMD)
-				m_val128 = _mm_add_ps(m_val128, v.m_val128);
-#else
-				m_val[0] += v.m_val[0];
-				m_val[1] += v.m_val[1];
-				m_val[2] += v.m_val[2];
+				if (!AYA_CONSTANT_EVALUATED()) {
+					m_val128 = _mm_add_ps(m_val128, v.m_val128);
+				}
+				else
 #endif
+				{
+					m_val[0] += v.m_val[0];
+					m_val[1] += v.m_val[1];
+					m_val[2] += v.m_val[2];
+				}
 				numericValid(1);
 				return *this;
 			}
-			AYA_FORCE_INLINE BaseVector3 operator - (const BaseVector3 &v) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR BaseVector3 operator - (const BaseVector3 &v) const {
 #if defined(AYA_USE_SIMD)
-				return BaseVector3(_mm_sub_ps(m_val128, v.m_val128));
-#else
+				if (!AYA_CONSTANT_EVALUATED()) {
+					return BaseVector3(_mm_sub_ps(m_val128, v.m_val128));
+				}
+#endif
 				return BaseVector3(m_val[0] - v.m_val[0],
 					m_val[1] - v.m_val[1],
 					m_val[2] - v.m_val[2]);
-#endif
 			}
-			AYA_FORCE_INLINE BaseVector3 & operator -= (const BaseVector3 &v) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR BaseVector3 & operator -= (const BaseVector3 &v) {
 #if defined(AYA_USE_SIMD)
-				m_val128 = _mm_sub_ps(m_val128, v.m_val128);
-#else
-				m_val[0] -= v.m_val[0];
-				m_val[1] -= v.m_val[1];
-				m_val[2] -= v.m_val[2];
+				if (!AYA_CONSTANT_EVALUATED()) {
+					m_val128 = _mm_sub_ps(m_val128, v.m_val128);
+				}
+				else
 #endif
+				{
+					m_val[0] -= v.m_val[0];
+					m_val[1] -= v.m_val[1];
+					m_val[2] -= v.m_val[2];
+				}
 				numericValid(1);
 				return *this;
 			}
-			AYA_FORCE_INLINE BaseVector3 operator- () const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR BaseVector3 operator- () const {
 #if defined(AYA_USE_SIMD)
-				__m128 r = _mm_xor_ps(m_val128, vMzeroMask);
-				return BaseVector3(_mm_and_ps(r, vFFF0fMask));
-#else
-				return BaseVector3(-m_val[0], -m_val[1], -m_val[2]);
+				if (!AYA_CONSTANT_EVALUATED()) {
+					__m128 r = _mm_xor_ps(m_val128, vMzeroMask);
+					return BaseVector3(_mm_and_ps(r, vFFF0fMask));
+				}
 #endif
+				return BaseVector3(-m_val[0], -m_val[1], -m_val[2]);
 			}
-			AYA_FORCE_INLINE BaseVector3 operator * (const float &s) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR BaseVector3 operator * (const float &s) const {
 #if defined(AYA_USE_SIMD)
-				__m128 vs = _mm_load_ss(&s);
-				vs = _mm_pshufd_ps(vs, 0x80);
-				return BaseVector3(_mm_mul_ps(m_val128, vs));
-#else
+				if (!AYA_CONSTANT_EVALUATED()) {
+					__m128 vs = _mm_load_ss(&s);
+					vs = _mm_pshufd_ps(vs, 0x80);
+					return BaseVector3(_mm_mul_ps(m_val128, vs));
+				}
+#endif
 				return BaseVector3(m_val[0] * s,
 					m_val[1] * s,
 					m_val[2] * s);
-#endif
 
 			}
-			AYA_FORCE_INLINE friend BaseVector3 operator * (const float &s, const BaseVector3 &v) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR friend BaseVector3 operator * (const float &s, const BaseVector3 &v) {
 				return v * s;
 			}
-			AYA_FORCE_INLINE BaseVector3 & operator *= (const float &s) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR BaseVector3 & operator *= (const float &s) {
 #if defined(AYA_USE_SIMD)
-				__m128 vs = _mm_load_ss(&s);
-				vs = _mm_pshufd_ps(vs, 0x80);
-				m_val128 = _mm_mul_ps(m_val128, vs);
-#else
-				m_val[0] *= s;
-				m_val[1] *= s;
-				m_val[2] *= s;
+				if (!AYA_CONSTANT_EVALUATED()) {
+					__m128 vs = _mm_load_ss(&s);
+					vs = _mm_pshufd_ps(vs, 0x80);
+					m_val128 = _mm_mul_ps(m_val128, vs);
+				}
+				else
 #endif
+				{
+					m_val[0] *= s;
+					m_val[1] *= s;
+					m_val[2] *= s;
+				}
 				numericValid(1);
 				return *this;
 			}
-			AYA_FORCE_INLINE BaseVector3 operator / (const float &s) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR BaseVector3 operator / (const float &s) const {
 				assert(s != 0.f);
 				BaseVector3 ret;
 				ret = (*this) * (1.f / s);
 				return ret;
 			}
-			AYA_FORCE_INLINE BaseVector3 & operator /= (const float &s) {
+			AYA_FORCE_INLINE AYA_CONSTEXPR BaseVector3 & operator /= (const float &s) {
 				assert(s != 0.f);
 				return *this *= (1.f / s);
 			}
 
-			AYA_FORCE_INLINE float dot(const BaseVector3 &v) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR float dot(const BaseVector3 &v) const {
 #if defined(AYA_USE_SIMD)
-				__m128 vd = _mm_mul_ps(m_val128, v.m_val128);
-				__m128 z = _mm_movehl_ps(vd, vd);
-				__m128 y = _mm_pshufd_ps(vd, 0x55);
-				vd = _mm_add_ss(vd, y);
-				vd = _mm_add_ss(vd, z);
-				return _mm_cvtss_f32(vd);
-
-#else
+				if (!AYA_CONSTANT_EVALUATED()) {
+					__m128 vd = _mm_mul_ps(m_val128, v.m_val128);
+					__m128 z = _mm_movehl_ps(vd, vd);
+					__m128 y = _mm_pshufd_ps(vd, 0x55);
+					vd = _mm_add_ss(vd, y);
+					vd = _mm_add_ss(vd, z);
+					return _mm_cvtss_f32(vd);
+				}
+#endif
 				return	m_val[0] * v.m_val[0] +
 					m_val[1] * v.m_val[1] +
 					m_val[2] * v.m_val[2];
-#endif
 			}
 
-			AYA_FORCE_INLINE float length2() const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR float length2() const {
 				return dot(*this);
 			}
 			AYA_FORCE_INLINE float length() const {
@@ -342,7 +394,7 @@ namespace Aya {
 				if (d > AYA_EPSILON) return Sqrt(d);
 				return 0.f;
 			}
-			AYA_FORCE_INLINE float distance2(const BaseVector3 &p) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR float distance2(const BaseVector3 &p) const {
 				return (p - (*this)).length2();
 			}
 			AYA_FORCE_INLINE float distance(const BaseVector3 &p) const {
@@ -397,74 +449,110 @@ namespace Aya {
 #endif
 			}
 
-			AYA_FORCE_INLINE BaseVector3 cross(const BaseVector3 &v) const {
+			AYA_FORCE_INLINE AYA_CONSTEXPR BaseVector3 cross(const BaseVector3 &v) const {
 #if defined(AYA_USE_SIMD)
-				__m128 T, V;
+				if (!AYA_CONSTANT_EVALUATED()) {
+					__m128 T, V;
 
-				T = _mm_pshufd_ps(m_val128, __MM_SHUFFLE(1, 2, 0, 3)); //			(Y Z X 0)
-				V = _mm_pshufd_ps(v.m_val128, __MM_SHUFFLE(1, 2, 0, 3)); //		(Y Z X 0)
+					T = _mm_pshufd_ps(m_val128, __MM_SHUFFLE(1, 2, 0, 3)); //			(Y Z X 0)
+					V = _mm_pshufd_ps(v.m_val128, __MM_SHUFFLE(1, 2, 0, 3)); //		(Y Z X 0)
 
-				V = _mm_mul_ps(V, m_val128);
-				T = _mm_mul_ps(T, v.m_val128);
-				V = _mm_sub_ps(V, T);
+					V = _mm_mul_ps(V, m_val128);
+					T = _mm_mul_ps(T, v.m_val128);
+					V = _mm_sub_ps(V, T);
 
-				V = _mm_pshufd_ps(V, __MM_SHUFFLE(1, 2, 0, 3));
-				return BaseVector3(V);
-#else
+					V = _mm_pshufd_ps(V, __MM_SHUFFLE(1, 2, 0, 3));
+					return BaseVector3(V);
+				}
+#endif
 				return BaseVector3(
 					m_val[1] * v.m_val[2] - m_val[2] * v.m_val[1],
 					m_val[2] * v.m_val[0] - m_val[0] * v.m_val[2],
 					m_val[0] * v.m_val[1] - m_val[1] * v.m_val[0]);
-#endif
 			}
 
-			AYA_FORCE_INLINE BaseVector3 dot3(const BaseVector3 &v0, const BaseVector3 &v1, const BaseVector3 &v2) const {
-#if defined(AYA_USE_SIMD)
-				__m128 a0 = _mm_mul_ps(v0.m_val128, m_val128);
-				__m128 a1 = _mm_mul_ps(v1.m_val128, m_val128);
-				__m128 a2 = _mm_mul_ps(v2.m_val128, m_val128);
-				__m128 b0 = _mm_unpacklo_ps(a0, a1);
-				__m128 b1 = _mm_unpackhi_ps(a0, a1);
-				__m128 b2 = _mm_unpacklo_ps(a2, _mm_setzero_ps());
-				__m128 r = _mm_add_ps(_mm_movelh_ps(b0, b2), _mm_movehl_ps(b2, b0));
-				a2 = _mm_and_ps(a2, vxyzMaskf);
-				r = _mm_add_ps(r, _mm_castpd_ps(_mm_move_sd(_mm_castps_pd(a2), _mm_castps_pd(b1))));
-				return BaseVector3(r);
-#else
-				return BaseVector3(dot(v0), dot(v1), dot(v2));
+			AYA_FORCE_INLINE AYA_CONSTEXPR BaseVector3 dot3(const BaseVector3 &v0, const BaseVector3 &v1, const BaseVector3 &v2) const {
+#if defined(AYA_USE_FMA)
+				if (!AYA_CONSTANT_EVALUATED()) {
+					// transpose v0, v1, v2 into columns, then one multiply and two fused adds
+					__m128 t0 = _mm_unpacklo_ps(v0.m_val128, v1.m_val128);	// x0 x1 y0 y1
+					__m128 t1 = _mm_unpackhi_ps(v0.m_val128, v1.m_val128);	// z0 z1 * *
+					__m128 t2 = _mm_unpacklo_ps(v2.m_val128, _mm_setzero_ps());	// x2 0 y2 0
+					__m128 t3 = _mm_unpackhi_ps(v2.m_val128, _mm_setzero_ps());	// z2 0 * 0
+					__m128 r = _mm_mul_ps(_mm_movelh_ps(t1, t3), _mm_splat_ps(m_val128, 2));
+					r = _mm_madd_ps(_mm_movehl_ps(t2, t0), _mm_splat_ps(m_val128, 1), r);
+					r = _mm_madd_ps(_mm_movelh_ps(t0, t2), _mm_splat_ps(m_val128, 0), r);
+					return BaseVector3(r);
+				}
+#elif defined(AYA_USE_SIMD)
+				if (!AYA_CONSTANT_EVALUATED()) {
+					__m128 a0 = _mm_mul_ps(v0.m_val128, m_val128);
+					__m128 a1 = _mm_mul_ps(v1.m_val128, m_val128);
+					__m128 a2 = _mm_mul_ps(v2.m_val128, m_val128);
+					__m128 b0 = _mm_unpacklo_ps(a0, a1);
+					__m128 b1 = _mm_unpackhi_ps(a0, a1);
+					__m128 b2 = _mm_unpacklo_ps(a2, _mm_setzero_ps());
+					__m128 r = _mm_add_ps(_mm_movelh_ps(b0, b2), _mm_movehl_ps(b2, b0));
+					a2 = _mm_and_ps(a2, vxyzMaskf);
+					r = _mm_add_ps(r, _mm_castpd_ps(_mm_move_sd(_mm_castps_pd(a2), _mm_castps_pd(b1))));
+					return BaseVector3(r);
+				}
 #endif
+				return BaseVector3(dot(v0), dot(v1), dot(v2));
 			}
 
 			static AYA_FORCE_INLINE BaseVector3 sphericalDirection(float sin_theta, float cos_theta, float phi) {
-				return BaseVector3(sin_theta * std::cosf(phi),
+				float sin_phi, cos_phi;
+				SimdMath::sincos(phi, &sin_phi, &cos_phi);
+				return BaseVector3(sin_theta * cos_phi,
 					cos_theta,
-					sin_theta * std::sinf(phi));
+					sin_theta * sin_phi);
 			}
 			static AYA_FORCE_INLINE BaseVector3 sphericalDirection(float sin_theta, float cos_theta,
 				float phi, const BaseVector3& vX,
 				const BaseVector3& vY, const BaseVector3& vZ)
 			{
-				return sin_theta * std::cosf(phi) * vX +
+				float sin_phi, cos_phi;
+				SimdMath::sincos(phi, &sin_phi, &cos_phi);
+				return sin_theta * cos_phi * vX +
 					cos_theta * vY + 
-					sin_theta * std::sinf(phi) * vZ;
+					sin_theta * sin_phi * vZ;
 			}
 			static AYA_FORCE_INLINE float sphericalTheta(const BaseVector3& v) {
-				return std::acosf(Clamp(v.y(), -1.f, 1.f));
+				return SimdMath::acos(Clamp(v.y(), -1.f, 1.f));
 			}
 			static AYA_FORCE_INLINE float sphericalPhi(const BaseVector3& v) {
-				float p = std::atan2f(v.z(), v.x());
-				return (p < 0.f) ? p + float(M_PI) * 2.f : p;
+				float p = SimdMath::atan2(v.z(), v.x());
+				p = (p < 0.f) ? p + float(M_PI) * 2.f : p;
+				// a tiny negative angle rounds to 2pi when wrapped, keep the result in [0, 2pi)
+				return (p < float(M_PI) * 2.f) ? p : 0.f;
 			}
+			// Completes the unit vector x to a right handed orthonormal basis (x, y, z) without
+			// branches (Duff et al. 2017). y and z are bit for bit the m_x and m_y of Frame(x).
 			static AYA_FORCE_INLINE void coordinateSystem(const BaseVector3 &x, BaseVector3 *y, BaseVector3 *z) {
-				if (Abs(x.x()) > Abs(x.y())) {
-					float inv = 1.f / Sqrt(x.x() * x.x() + x.z() * x.z());
-					*y = BaseVector3(-x.z() * inv, 0.f, x.x() * inv);
-				}
-				else {
-					float inv = 1.f / Sqrt(x.y() * x.y() + x.z() * x.z());
-					*y = BaseVector3(0.f, x.z() * inv, -x.y() * inv);
-				}
-				*z = x.cross(*y);
+				SimdMath::Scalar ty[3], tz[3];
+				coordinateSystemKernel(SimdMath::toScalar(x.x()), SimdMath::toScalar(x.y()), SimdMath::toScalar(x.z()), ty, tz);
+				*y = BaseVector3(SimdMath::fromScalar(ty[0]), SimdMath::fromScalar(ty[1]), SimdMath::fromScalar(ty[2]));
+				*z = BaseVector3(SimdMath::fromScalar(tz[0]), SimdMath::fromScalar(tz[1]), SimdMath::fromScalar(tz[2]));
+			}
+			// Tangents x and y of the unit vector (nx, ny, nz) on any SimdMath lane type:
+			//   s = copysign(1, nz), a = -1 / (s + nz), b = nx * ny * a
+			//   x = (1 + s * nx^2 * a, s * b, -s * nx)
+			//   y = (b, s + ny^2 * a, -ny)
+			template<class V>
+			static AYA_FORCE_INLINE void coordinateSystemKernel(const V &nx, const V &ny, const V &nz, V *x, V *y) {
+				const V sign_bit = SimdMath::splatBits(nx, 0x80000000u);
+				const V one = SimdMath::splat(nx, 1.f);
+				const V s = SimdMath::bitOr(SimdMath::bitAnd(nz, sign_bit), one);
+				const V a = SimdMath::div(SimdMath::splat(nx, -1.f), SimdMath::add(s, nz));
+				const V b = SimdMath::mul(SimdMath::mul(nx, ny), a);
+				const V snx = SimdMath::mul(s, nx);
+				x[0] = SimdMath::madd(snx, SimdMath::mul(nx, a), one);
+				x[1] = SimdMath::mul(s, b);
+				x[2] = SimdMath::bitXor(snx, sign_bit);
+				y[0] = b;
+				y[1] = SimdMath::madd(ny, SimdMath::mul(ny, a), s);
+				y[2] = SimdMath::bitXor(ny, sign_bit);
 			}
 
 			friend inline std::ostream &operator<<(std::ostream &os, const BaseVector3 &v) {
@@ -476,13 +564,10 @@ namespace Aya {
 			}
 	};
 
-#if defined(AYA_USE_SIMD)
-	__declspec(align(16))
-#endif
-		class Vector3 : public BaseVector3 {
+		class AYA_SIMD_ALIGN Vector3 : public BaseVector3 {
 		public:
-			Vector3() {}
-			AYA_FORCE_INLINE Vector3(const float &x, const float &y, const float &z) {
+			AYA_CONSTEXPR Vector3() {}
+			AYA_FORCE_INLINE AYA_CONSTEXPR Vector3(const float &x, const float &y, const float &z) {
 				m_val[0] = x;
 				m_val[1] = y;
 				m_val[2] = z;
@@ -502,35 +587,28 @@ namespace Aya {
 			AYA_FORCE_INLINE Vector3(const __m128 &v128) {
 				m_val128 = v128;
 			}
-			AYA_FORCE_INLINE Vector3(const BaseVector3 &rhs) {
-				m_val128 = rhs.m_val128;
+			AYA_FORCE_INLINE AYA_CONSTEXPR Vector3(const BaseVector3 &rhs) {
+				copyFrom(rhs);
 			}
-			AYA_FORCE_INLINE Vector3& operator =(const BaseVector3 &rhs) {
-				m_val128 = rhs.m_val128;
+			AYA_FORCE_INLINE AYA_CONSTEXPR Vector3& operator =(const BaseVector3 &rhs) {
+				copyFrom(rhs);
 				return *this;
 			}
 #else
-			AYA_FORCE_INLINE Vector3(const BaseVector3 &rhs) {
-				m_val[0] = rhs.m_val[0];
-				m_val[1] = rhs.m_val[1];
-				m_val[2] = rhs.m_val[2];
+			AYA_FORCE_INLINE AYA_CONSTEXPR Vector3(const BaseVector3 &rhs) {
+				copyFrom(rhs);
 			}
-			AYA_FORCE_INLINE Vector3& operator =(const BaseVector3 &rhs) {
-				m_val[0] = rhs.m_val[0];
-				m_val[1] = rhs.m_val[1];
-				m_val[2] = rhs.m_val[2];
+			AYA_FORCE_INLINE AYA_CONSTEXPR Vector3& operator =(const BaseVector3 &rhs) {
+				copyFrom(rhs);
 				return *this;
 			}
 #endif
 	};
 
-#if defined(AYA_USE_SIMD)
-	__declspec(align(16))
-#endif
-		class Point3 : public BaseVector3 {
+		class AYA_SIMD_ALIGN Point3 : public BaseVector3 {
 		public:
-			Point3() {}
-			AYA_FORCE_INLINE Point3(const float &x, const float &y, const float &z) {
+			AYA_CONSTEXPR Point3() {}
+			AYA_FORCE_INLINE AYA_CONSTEXPR Point3(const float &x, const float &y, const float &z) {
 				m_val[0] = x;
 				m_val[1] = y;
 				m_val[2] = z;
@@ -550,35 +628,28 @@ namespace Aya {
 			AYA_FORCE_INLINE Point3(const __m128 &v128) {
 				m_val128 = v128;
 			}
-			AYA_FORCE_INLINE Point3(const BaseVector3 &rhs) {
-				m_val128 = rhs.m_val128;
+			AYA_FORCE_INLINE AYA_CONSTEXPR Point3(const BaseVector3 &rhs) {
+				copyFrom(rhs);
 			}
-			AYA_FORCE_INLINE Point3& operator =(const BaseVector3 &rhs) {
-				m_val128 = rhs.m_val128;
+			AYA_FORCE_INLINE AYA_CONSTEXPR Point3& operator =(const BaseVector3 &rhs) {
+				copyFrom(rhs);
 				return *this;
 			}
 #else
-			AYA_FORCE_INLINE Point3(const BaseVector3 &rhs) {
-				m_val[0] = rhs.m_val[0];
-				m_val[1] = rhs.m_val[1];
-				m_val[2] = rhs.m_val[2];
+			AYA_FORCE_INLINE AYA_CONSTEXPR Point3(const BaseVector3 &rhs) {
+				copyFrom(rhs);
 			}
-			AYA_FORCE_INLINE Point3& operator =(const BaseVector3 &rhs) {
-				m_val[0] = rhs.m_val[0];
-				m_val[1] = rhs.m_val[1];
-				m_val[2] = rhs.m_val[2];
+			AYA_FORCE_INLINE AYA_CONSTEXPR Point3& operator =(const BaseVector3 &rhs) {
+				copyFrom(rhs);
 				return *this;
 			}
 #endif
 	};
 
-#if defined(AYA_USE_SIMD)
-	__declspec(align(16))
-#endif
-		class Normal3 : public BaseVector3 {
+		class AYA_SIMD_ALIGN Normal3 : public BaseVector3 {
 		public:
-			Normal3() {}
-			AYA_FORCE_INLINE Normal3(const float &x, const float &y, const float &z) {
+			AYA_CONSTEXPR Normal3() {}
+			AYA_FORCE_INLINE AYA_CONSTEXPR Normal3(const float &x, const float &y, const float &z) {
 				m_val[0] = x;
 				m_val[1] = y;
 				m_val[2] = z;
@@ -598,23 +669,19 @@ namespace Aya {
 			AYA_FORCE_INLINE Normal3(const __m128 &v128) {
 				m_val128 = v128;
 			}
-			AYA_FORCE_INLINE Normal3(const BaseVector3 &rhs) {
-				m_val128 = rhs.m_val128;
+			AYA_FORCE_INLINE AYA_CONSTEXPR Normal3(const BaseVector3 &rhs) {
+				copyFrom(rhs);
 			}
-			AYA_FORCE_INLINE Normal3& operator =(const BaseVector3 &rhs) {
-				m_val128 = rhs.m_val128;
+			AYA_FORCE_INLINE AYA_CONSTEXPR Normal3& operator =(const BaseVector3 &rhs) {
+				copyFrom(rhs);
 				return *this;
 			}
 #else
-			AYA_FORCE_INLINE Normal3(const BaseVector3 &rhs) {
-				m_val[0] = rhs.m_val[0];
-				m_val[1] = rhs.m_val[1];
-				m_val[2] = rhs.m_val[2];
+			AYA_FORCE_INLINE AYA_CONSTEXPR Normal3(const BaseVector3 &rhs) {
+				copyFrom(rhs);
 			}
-			AYA_FORCE_INLINE Normal3& operator =(const BaseVector3 &rhs) {
-				m_val[0] = rhs.m_val[0];
-				m_val[1] = rhs.m_val[1];
-				m_val[2] = rhs.m_val[2];
+			AYA_FORCE_INLINE AYA_CONSTEXPR Normal3& operator =(const BaseVector3 &rhs) {
+				copyFrom(rhs);
 				return *this;
 			}
 #endif
@@ -0,0 +1,459 @@
+#ifndef AYA_MATH_VECTOR3D_H
+#define AYA_MATH_VECTOR3D_H
+
+#include "Vector3.h"
+
+#if defined(AYA_USE_AVX)
+#if defined(AYA_USE_FMA)
+#define _mm256_madd_pd(_a, _b, _c) _mm256_fmadd_pd((_a), (_b), (_c))
+#else
+#define _mm256_madd_pd(_a, _b, _c) _mm256_add_pd(_mm256_mul_pd((_a), (_b)), (_c))
+#endif
+#define vd1000 (_mm256_set_pd(0.0, 0.0, 0.0, 1.0))
+#define vd0100 (_mm256_set_pd(0.0, 0.0, 1.0, 0.0))
+#define vd0010 (_mm256_set_pd(0.0, 1.0, 0.0, 0.0))
+#define vd0001 (_mm256_set_pd(1.0, 0.0, 0.0, 0.0))
+#define vdMzeroMask (_mm256_set1_pd(-0.0))
+#endif
+
+// Double precision counterparts of QuadWord and the Vector3 family, 4 doubles in a __m256d
+// when AVX is on. For large-world positions, rebase them to a float local origin before
+// rendering.
+namespace Aya {
+		class AYA_ALIGN(32) QuadWordd {
+#if defined(AYA_USE_AVX)
+		public:
+			union {
+				double m_val[4];
+				__m256d m_val256;
+			};
+
+			AYA_FORCE_INLINE __m256d get256() const {
+				return m_val256;
+			}
+			AYA_FORCE_INLINE void set256(const __m256d &v256) {
+				m_val256 = v256;
+			}
+#else
+		public:
+			double m_val[4];
+#endif
+
+		public:
+			QuadWordd() {}
+			AYA_FORCE_INLINE QuadWordd(const double &x, const double &y, const double &z, const double &w) {
+				m_val[0] = x;
+				m_val[1] = y;
+				m_val[2] = z;
+				m_val[3] = w;
+			}
+			AYA_FORCE_INLINE explicit QuadWordd(const QuadWord &q) {
+#if defined(AYA_USE_AVX)
+				m_val256 = _mm256_cvtps_pd(q.m_val128);
+#else
+				m_val[0] = q.m_val[0];
+				m_val[1] = q.m_val[1];
+				m_val[2] = q.m_val[2];
+				m_val[3] = q.m_val[3];
+#endif
+			}
+
+#if defined(AYA_USE_AVX)
+			AYA_FORCE_INLINE void  *operator new(size_t i) {
+				return _mm_malloc(i, 32);
+			}
+
+			AYA_FORCE_INLINE void operator delete(void *p) {
+				_mm_free(p);
+			}
+
+			AYA_FORCE_INLINE QuadWordd(const __m256d &v256) {
+				m_val256 = v256;
+			}
+			AYA_FORCE_INLINE QuadWordd(const QuadWordd &rhs) {
+				m_val256 = rhs.m_val256;
+			}
+			AYA_FORCE_INLINE QuadWordd& operator = (const QuadWordd &rhs) {
+				m_val256 = rhs.m_val256;
+				return *this;
+			}
+#endif
+
+			// Rounds to float
+			AYA_FORCE_INLINE QuadWord toFloat() const {
+#if defined(AYA_USE_AVX)
+				return QuadWord(_mm256_cvtpd_ps(m_val256));
+#else
+				return QuadWord((float)m_val[0], (float)m_val[1], (float)m_val[2], (float)m_val[3]);
+#endif
+			}
+
+			AYA_FORCE_INLINE void setX(const double &x) { m_val[0] = x; }
+			AYA_FORCE_INLINE void setY(const double &y) { m_val[1] = y; }
+			AYA_FORCE_INLINE void setZ(const double &z) { m_val[2] = z; }
+			AYA_FORCE_INLINE void setW(const double &w) { m_val[3] = w; }
+			AYA_FORCE_INLINE const double& x() const { return m_val[0]; }
+			AYA_FORCE_INLINE const double& y() const { return m_val[1]; }
+			AYA_FORCE_INLINE const double& z() const { return m_val[2]; }
+			AYA_FORCE_INLINE const double& w() const { return m_val[3]; }
+
+			AYA_FORCE_INLINE double operator [](const int &p) const {
+				assert(p >= 0 && p <= 3);
+				return m_val[p];
+			}
+			AYA_FORCE_INLINE double &operator [](const int &p) {
+				assert(p >= 0 && p <= 3);
+				return m_val[p];
+			}
+
+			friend inline std::ostream &operator<<(std::ostream &os, const QuadWordd &v) {
+				os << "[ " << v.m_val[0]
+					<< ", " << v.m_val[1]
+					<< ", " << v.m_val[2]
+					<< ", " << v.m_val[3]
+					<< " ]";
+				return os;
+			}
+	};
+
+		class AYA_ALIGN(32) BaseVector3d : public QuadWordd {
+		public:
+			BaseVector3d() {}
+			AYA_FORCE_INLINE BaseVector3d(const double &x, const double &y, const double &z) {
+				m_val[0] = x;
+				m_val[1] = y;
+				m_val[2] = z;
+				m_val[3] = .0;
+			}
+			AYA_FORCE_INLINE explicit BaseVector3d(const BaseVector3 &v) : QuadWordd(v) {}
+
+#if defined(AYA_USE_AVX)
+			AYA_FORCE_INLINE BaseVector3d(const __m256d &v256) {
+				m_val256 = v256;
+			}
+			AYA_FORCE_INLINE BaseVector3d(const BaseVector3d &rhs) : QuadWordd(rhs) {}
+			AYA_FORCE_INLINE BaseVector3d& operator = (const BaseVector3d &rhs) {
+				m_val256 = rhs.m_val256;
+				return *this;
+			}
+#endif
+			AYA_FORCE_INLINE void setValue(const double &x, const double &y, const double &z) {
+				m_val[0] = x;
+				m_val[1] = y;
+				m_val[2] = z;
+				m_val[3] = .0;
+			}
+
+			AYA_FORCE_INLINE BaseVector3 toFloat() const {
+#if defined(AYA_USE_AVX)
+				return BaseVector3(_mm256_cvtpd_ps(m_val256));
+#else
+				return BaseVector3((float)m_val[0], (float)m_val[1], (float)m_val[2]);
+#endif
+			}
+
+			AYA_FORCE_INLINE bool operator == (const BaseVector3d &v) const {
+#if defined(AYA_USE_AVX)
+				return (0xf == _mm256_movemask_pd(_mm256_cmp_pd(m_val256, v.m_val256, _CMP_EQ_OQ)));
+#else
+				return ((m_val[0] == v.m_val[0]) &&
+					(m_val[1] == v.m_val[1]) &&
+					(m_val[2] == v.m_val[2]) &&
+					(m_val[3] == v.m_val[3]));
+#endif
+			}
+			AYA_FORCE_INLINE bool operator != (const BaseVector3d &v) const {
+				return !((*this) == v);
+			}
+
+			AYA_FORCE_INLINE void setMax(const BaseVector3d &v) {
+#if defined(AYA_USE_AVX)
+				m_val256 = _mm256_max_pd(m_val256, v.m_val256);
+#else
+				SetMax(m_val[0], v.m_val[0]);
+				SetMax(m_val[1], v.m_val[1]);
+				SetMax(m_val[2], v.m_val[2]);
+#endif
+			}
+			AYA_FORCE_INLINE void setMin(const BaseVector3d &v) {
+#if defined(AYA_USE_AVX)
+				m_val256 = _mm256_min_pd(m_val256, v.m_val256);
+#else
+				SetMin(m_val[0], v.m_val[0]);
+				SetMin(m_val[1], v.m_val[1]);
+				SetMin(m_val[2], v.m_val[2]);
+#endif
+			}
+			AYA_FORCE_INLINE void setZero() {
+#if defined(AYA_USE_AVX)
+				m_val256 = _mm256_setzero_pd();
+#else
+				m_val[0] = 0.;
+				m_val[1] = 0.;
+				m_val[2] = 0.;
+				m_val[3] = 0.;
+#endif
+			}
+
+			AYA_FORCE_INLINE BaseVector3d operator + (const BaseVector3d &v) const {
+#if defined(AYA_USE_AVX)
+				return BaseVector3d(_mm256_add_pd(m_val256, v.m_val256));
+#else
+				return BaseVector3d(m_val[0] + v.m_val[0],
+					m_val[1] + v.m_val[1],
+					m_val[2] + v.m_val[2]);
+#endif
+			}
+			AYA_FORCE_INLINE BaseVector3d & operator += (const BaseVector3d &v) {
+#if defined(AYA_USE_AVX)
+				m_val256 = _mm256_add_pd(m_val256, v.m_val256);
+#else
+				m_val[0] += v.m_val[0];
+				m_val[1] += v.m_val[1];
+				m_val[2] += v.m_val[2];
+#endif
+				return *this;
+			}
+			AYA_FORCE_INLINE BaseVector3d operator - (const BaseVector3d &v) const {
+#if defined(AYA_USE_AVX)
+				return BaseVector3d(_mm256_sub_pd(m_val256, v.m_val256));
+#else
+				return BaseVector3d(m_val[0] - v.m_val[0],
+					m_val[1] - v.m_val[1],
+					m_val[2] - v.m_val[2]);
+#endif
+			}
+			AYA_FORCE_INLINE BaseVector3d & operator -= (const BaseVector3d &v) {
+#if defined(AYA_USE_AVX)
+				m_val256 = _mm256_sub_pd(m_val256, v.m_val256);
+#else
+				m_val[0] -= v.m_val[0];
+				m_val[1] -= v.m_val[1];
+				m_val[2] -= v.m_val[2];
+#endif
+				return *this;
+			}
+			AYA_FORCE_INLINE BaseVector3d operator- () const {
+#if defined(AYA_USE_AVX)
+				__m256d r = _mm256_xor_pd(m_val256, vdMzeroMask);
+				return BaseVector3d(_mm256_blend_pd(r, _mm256_setzero_pd(), 0x8));
+#else
+				return BaseVector3d(-m_val[0], -m_val[1], -m_val[2]);
+#endif
+			}
+			AYA_FORCE_INLINE BaseVector3d operator * (const double &s) const {
+#if defined(AYA_USE_AVX)
+				return BaseVector3d(_mm256_mul_pd(m_val256, _mm256_set1_pd(s)));
+#else
+				return BaseVector3d(m_val[0] * s,
+					m_val[1] * s,
+					m_val[2] * s);
+#endif
+			}
+			AYA_FORCE_INLINE friend BaseVector3d operator * (const double &s, const BaseVector3d &v) {
+				return v * s;
+			}
+			AYA_FORCE_INLINE BaseVector3d & operator *= (const double &s) {
+#if defined(AYA_USE_AVX)
+				m_val256 = _mm256_mul_pd(m_val256, _mm256_set1_pd(s));
+#else
+				m_val[0] *= s;
+				m_val[1] *= s;
+				m_val[2] *= s;
+#endif
+				return *this;
+			}
+			AYA_FORCE_INLINE BaseVector3d operator / (const double &s) const {
+				assert(s != 0.);
+				return (*this) * (1. / s);
+			}
+			AYA_FORCE_INLINE BaseVector3d & operator /= (const double &s) {
+				assert(s != 0.);
+				return *this *= (1. / s);
+			}
+
+			AYA_FORCE_INLINE double dot(const BaseVector3d &v) const {
+#if defined(AYA_USE_AVX)
+				__m256d vd = _mm256_blend_pd(_mm256_mul_pd(m_val256, v.m_val256), _mm256_setzero_pd(), 0x8);
+				__m128d s = _mm_add_pd(_mm256_castpd256_pd128(vd), _mm256_extractf128_pd(vd, 1));	// x+z y
+				s = _mm_add_sd(s, _mm_unpackhi_pd(s, s));
+				return _mm_cvtsd_f64(s);
+#else
+				return	m_val[0] * v.m_val[0] +
+					m_val[1] * v.m_val[1] +
+					m_val[2] * v.m_val[2];
+#endif
+			}
+
+			AYA_FORCE_INLINE double length2() const {
+				return dot(*this);
+			}
+			AYA_FORCE_INLINE double length() const {
+				return sqrt(length2());
+			}
+			AYA_FORCE_INLINE double distance2(const BaseVector3d &p) const {
+				return (p - (*this)).length2();
+			}
+			AYA_FORCE_INLINE double distance(const BaseVector3d &p) const {
+				return (p - (*this)).length();
+			}
+			AYA_FORCE_INLINE BaseVector3d normalize() const {
+				return *this / length();
+			}
+			AYA_FORCE_INLINE void normalized() {
+				*this /= length();
+			}
+
+			AYA_FORCE_INLINE BaseVector3d cross(const BaseVector3d &v) const {
+				return BaseVector3d(
+					m_val[1] * v.m_val[2] - m_val[2] * v.m_val[1],
+					m_val[2] * v.m_val[0] - m_val[0] * v.m_val[2],
+					m_val[0] * v.m_val[1] - m_val[1] * v.m_val[0]);
+			}
+
+			friend inline std::ostream &operator<<(std::ostream &os, const BaseVector3d &v) {
+				os << "[ " << v.m_val[0]
+					<< ", " << v.m_val[1]
+					<< ", " << v.m_val[2]
+					<< " ]";
+				return os;
+			}
+	};
+
+		class AYA_ALIGN(32) Vector3d : public BaseVector3d {
+		public:
+			Vector3d() {}
+			AYA_FORCE_INLINE Vector3d(const double &x, const double &y, const double &z) {
+				m_val[0] = x;
+				m_val[1] = y;
+				m_val[2] = z;
+				m_val[3] = .0;
+			}
+			AYA_FORCE_INLINE explicit Vector3d(const Vector3 &v) : BaseVector3d(v) {}
+			AYA_FORCE_INLINE Vector3 toFloat() const {
+				return Vector3(BaseVector3d::toFloat());
+			}
+
+#if defined(AYA_USE_AVX)
+			AYA_FORCE_INLINE Vector3d(const __m256d &v256) {
+				m_val256 = v256;
+			}
+			AYA_FORCE_INLINE Vector3d(const BaseVector3d &rhs) {
+				m_val256 = rhs.m_val256;
+			}
+			AYA_FORCE_INLINE Vector3d& operator =(const BaseVector3d &rhs) {
+				m_val256 = rhs.m_val256;
+				return *this;
+			}
+#else
+			AYA_FORCE_INLINE Vector3d(const BaseVector3d &rhs) {
+				m_val[0] = rhs.m_val[0];
+				m_val[1] = rhs.m_val[1];
+				m_val[2] = rhs.m_val[2];
+				m_val[3] = rhs.m_val[3];
+			}
+			AYA_FORCE_INLINE Vector3d& operator =(const BaseVector3d &rhs) {
+				m_val[0] = rhs.m_val[0];
+				m_val[1] = rhs.m_val[1];
+				m_val[2] = rhs.m_val[2];
+				m_val[3] = rhs.m_val[3];
+				return *this;
+			}
+#endif
+	};
+
+		class AYA_ALIGN(32) Point3d : public BaseVector3d {
+		public:
+			Point3d() {}
+			AYA_FORCE_INLINE Point3d(const double &x, const double &y, const double &z) {
+				m_val[0] = x;
+				m_val[1] = y;
+				m_val[2] = z;
+				m_val[3] = .0;
+			}
+			AYA_FORCE_INLINE explicit Point3d(const Point3 &p) : BaseVector3d(p) {}
+			AYA_FORCE_INLINE Point3 toFloat() const {
+				return Point3(BaseVector3d::toFloat());
+			}
+
+			// Float position relative to origin, the difference is taken in double so only the
+			// local offset gets rounded
+			AYA_FORCE_INLINE Point3 toLocal(const Point3d &origin) const {
+				return Point3(((*this) - origin).toFloat());
+			}
+			static AYA_FORCE_INLINE Point3d fromLocal(const Point3 &p, const Point3d &origin) {
+				return origin + BaseVector3d(p);
+			}
+
+#if defined(AYA_USE_AVX)
+			AYA_FORCE_INLINE Point3d(const __m256d &v256) {
+				m_val256 = v256;
+			}
+			AYA_FORCE_INLINE Point3d(const BaseVector3d &rhs) {
+				m_val256 = rhs.m_val256;
+			}
+			AYA_FORCE_INLINE Point3d& operator =(const BaseVector3d &rhs) {
+				m_val256 = rhs.m_val256;
+				return *this;
+			}
+#else
+			AYA_FORCE_INLINE Point3d(const BaseVector3d &rhs) {
+				m_val[0] = rhs.m_val[0];
+				m_val[1] = rhs.m_val[1];
+				m_val[2] = rhs.m_val[2];
+				m_val[3] = rhs.m_val[3];
+			}
+			AYA_FORCE_INLINE Point3d& operator =(const BaseVector3d &rhs) {
+				m_val[0] = rhs.m_val[0];
+				m_val[1] = rhs.m_val[1];
+				m_val[2] = rhs.m_val[2];
+				m_val[3] = rhs.m_val[3];
+				return *this;
+			}
+#endif
+	};
+
+		class AYA_ALIGN(32) Normal3d : public BaseVector3d {
+		public:
+			Normal3d() {}
+			AYA_FORCE_INLINE Normal3d(const double &x, const double &y, const double &z) {
+				m_val[0] = x;
+				m_val[1] = y;
+				m_val[2] = z;
+				m_val[3] = .0;
+			}
+			AYA_FORCE_INLINE explicit Normal3d(const Normal3 &n) : BaseVector3d(n) {}
+			AYA_FORCE_INLINE Normal3 toFloat() const {
+				return Normal3(BaseVector3d::toFloat());
+			}
+
+#if defined(AYA_USE_AVX)
+			AYA_FORCE_INLINE Normal3d(const __m256d &v256) {
+				m_val256 = v256;
+			}
+			AYA_FORCE_INLINE Normal3d(const BaseVector3d &rhs) {
+				m_val256 = rhs.m_val256;
+			}
+			AYA_FORCE_INLINE Normal3d& operator =(const BaseVector3d &rhs) {
+				m_val256 = rhs.m_val256;
+				return *this;
+			}
+#else
+			AYA_FORCE_INLINE Normal3d(const BaseVector3d &rhs) {
+				m_val[0] = rhs.m_val[0];
+				m_val[1] = rhs.m_val[1];
+				m_val[2] = rhs.m_val[2];
+				m_val[3] = rhs.m_val[3];
+			}
+			AYA_FORCE_INLINE Normal3d& operator =(const BaseVector3d &rhs) {
+				m_val[0] = rhs.m_val[0];
+				m_val[1] = rhs.m_val[1];
+				m_val[2] = rhs.m_val[2];
+				m_val[3] = rhs.m_val[3];
+				return *this;
+			}
+#endif
+	};
+}
+
+#endif
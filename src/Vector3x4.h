@@ -0,0 +1,328 @@
+#ifndef AYA_MATH_VECTOR3X4_H
+#define AYA_MATH_VECTOR3X4_H
+
+#include "Vector3.h"
+
+namespace Aya {
+	// Four BaseVector3 in structure-of-arrays layout, lane i of m_val[0..2] is (x, y, z) of vector i.
+	// Per-lane scalar results (dot, length2, ...) are returned as a QuadWord.
+		class AYA_SIMD_ALIGN Vector3x4 {
+		public:
+#if defined(AYA_USE_SIMD)
+			union {
+				float m_val[3][4];
+				__m128 m_val128[3];
+			};
+#else
+			float m_val[3][4];
+#endif
+
+		public:
+			Vector3x4() {}
+			AYA_FORCE_INLINE Vector3x4(const QuadWord &x, const QuadWord &y, const QuadWord &z) {
+#if defined(AYA_USE_SIMD)
+				m_val128[0] = x.m_val128;
+				m_val128[1] = y.m_val128;
+				m_val128[2] = z.m_val128;
+#else
+				for (int i = 0; i < 4; i++) {
+					m_val[0][i] = x[i];
+					m_val[1][i] = y[i];
+					m_val[2][i] = z[i];
+				}
+#endif
+			}
+			explicit AYA_FORCE_INLINE Vector3x4(const BaseVector3 &v) {
+#if defined(AYA_USE_SIMD)
+				m_val128[0] = _mm_splat_ps(v.m_val128, 0);
+				m_val128[1] = _mm_splat_ps(v.m_val128, 1);
+				m_val128[2] = _mm_splat_ps(v.m_val128, 2);
+#else
+				for (int i = 0; i < 4; i++) {
+					m_val[0][i] = v.x();
+					m_val[1][i] = v.y();
+					m_val[2][i] = v.z();
+				}
+#endif
+			}
+			AYA_FORCE_INLINE Vector3x4(const BaseVector3 &v0, const BaseVector3 &v1,
+				const BaseVector3 &v2, const BaseVector3 &v3) {
+				setValue(v0, v1, v2, v3);
+			}
+
+#if defined(AYA_USE_SIMD)
+			AYA_FORCE_INLINE Vector3x4(const __m128 &x, const __m128 &y, const __m128 &z) {
+				m_val128[0] = x;
+				m_val128[1] = y;
+				m_val128[2] = z;
+			}
+			AYA_FORCE_INLINE Vector3x4(const Vector3x4 &rhs) {
+				m_val128[0] = rhs.m_val128[0];
+				m_val128[1] = rhs.m_val128[1];
+				m_val128[2] = rhs.m_val128[2];
+			}
+			AYA_FORCE_INLINE Vector3x4& operator = (const Vector3x4 &rhs) {
+				m_val128[0] = rhs.m_val128[0];
+				m_val128[1] = rhs.m_val128[1];
+				m_val128[2] = rhs.m_val128[2];
+				return *this;
+			}
+
+			AYA_FORCE_INLINE void  *operator new(size_t i) {
+				return _mm_malloc(i, 16);
+			}
+
+			AYA_FORCE_INLINE void operator delete(void *p) {
+				_mm_free(p);
+			}
+#endif
+
+			AYA_FORCE_INLINE void setValue(const BaseVector3 &v0, const BaseVector3 &v1,
+				const BaseVector3 &v2, const BaseVector3 &v3) {
+#if defined(AYA_USE_SIMD)
+				__m128 t0 = _mm_unpacklo_ps(v0.m_val128, v2.m_val128); // x0 x2 y0 y2
+				__m128 t1 = _mm_unpackhi_ps(v0.m_val128, v2.m_val128); // z0 z2 w0 w2
+				__m128 t2 = _mm_unpacklo_ps(v1.m_val128, v3.m_val128); // x1 x3 y1 y3
+				__m128 t3 = _mm_unpackhi_ps(v1.m_val128, v3.m_val128); // z1 z3 w1 w3
+
+				m_val128[0] = _mm_unpacklo_ps(t0, t2);
+				m_val128[1] = _mm_unpackhi_ps(t0, t2);
+				m_val128[2] = _mm_unpacklo_ps(t1, t3);
+#else
+				const BaseVector3 *v[4] = { &v0, &v1, &v2, &v3 };
+				for (int i = 0; i < 4; i++) {
+					m_val[0][i] = v[i]->x();
+					m_val[1][i] = v[i]->y();
+					m_val[2][i] = v[i]->z();
+				}
+#endif
+			}
+
+			// Gather 4 consecutive Point3/Vector3/Normal3 from p
+			template<class T>
+			static AYA_FORCE_INLINE Vector3x4 load(const T *p) {
+				return Vector3x4(p[0], p[1], p[2], p[3]);
+			}
+			// Scatter the 4 lanes into consecutive Point3/Vector3/Normal3 at p, w is cleared
+			template<class T>
+			AYA_FORCE_INLINE void store(T *p) const {
+#if defined(AYA_USE_SIMD)
+				__m128 zero = _mm_setzero_ps();
+				__m128 t0 = _mm_unpacklo_ps(m_val128[0], m_val128[2]); // x0 z0 x1 z1
+				__m128 t1 = _mm_unpackhi_ps(m_val128[0], m_val128[2]); // x2 z2 x3 z3
+				__m128 t2 = _mm_unpacklo_ps(m_val128[1], zero);        // y0 0  y1 0
+				__m128 t3 = _mm_unpackhi_ps(m_val128[1], zero);        // y2 0  y3 0
+
+				p[0].m_val128 = _mm_unpacklo_ps(t0, t2);
+				p[1].m_val128 = _mm_unpackhi_ps(t0, t2);
+				p[2].m_val128 = _mm_unpacklo_ps(t1, t3);
+				p[3].m_val128 = _mm_unpackhi_ps(t1, t3);
+#else
+				for (int i = 0; i < 4; i++)
+					p[i] = T(m_val[0][i], m_val[1][i], m_val[2][i]);
+#endif
+			}
+			AYA_FORCE_INLINE BaseVector3 getVector(const int &i) const {
+				assert(i >= 0 && i < 4);
+				return BaseVector3(m_val[0][i], m_val[1][i], m_val[2][i]);
+			}
+
+			AYA_FORCE_INLINE QuadWord x() const { return getAxis(0); }
+			AYA_FORCE_INLINE QuadWord y() const { return getAxis(1); }
+			AYA_FORCE_INLINE QuadWord z() const { return getAxis(2); }
+			AYA_FORCE_INLINE QuadWord getAxis(const int &a) const {
+				assert(a >= 0 && a < 3);
+#if defined(AYA_USE_SIMD)
+				return QuadWord(m_val128[a]);
+#else
+				return QuadWord(m_val[a][0], m_val[a][1], m_val[a][2], m_val[a][3]);
+#endif
+			}
+
+			AYA_FORCE_INLINE void setMax(const Vector3x4 &v) {
+#if defined(AYA_USE_SIMD)
+				m_val128[0] = _mm_max_ps(m_val128[0], v.m_val128[0]);
+				m_val128[1] = _mm_max_ps(m_val128[1], v.m_val128[1]);
+				m_val128[2] = _mm_max_ps(m_val128[2], v.m_val128[2]);
+#else
+				for (int a = 0; a < 3; a++)
+					for (int i = 0; i < 4; i++)
+						SetMax(m_val[a][i], v.m_val[a][i]);
+#endif
+			}
+			AYA_FORCE_INLINE void setMin(const Vector3x4 &v) {
+#if defined(AYA_USE_SIMD)
+				m_val128[0] = _mm_min_ps(m_val128[0], v.m_val128[0]);
+				m_val128[1] = _mm_min_ps(m_val128[1], v.m_val128[1]);
+				m_val128[2] = _mm_min_ps(m_val128[2], v.m_val128[2]);
+#else
+				for (int a = 0; a < 3; a++)
+					for (int i = 0; i < 4; i++)
+						SetMin(m_val[a][i], v.m_val[a][i]);
+#endif
+			}
+			AYA_FORCE_INLINE void setZero() {
+#if defined(AYA_USE_SIMD)
+				m_val128[0] = m_val128[1] = m_val128[2] = _mm_setzero_ps();
+#else
+				for (int a = 0; a < 3; a++)
+					for (int i = 0; i < 4; i++)
+						m_val[a][i] = 0.f;
+#endif
+			}
+
+			AYA_FORCE_INLINE Vector3x4 operator + (const Vector3x4 &v) const {
+#if defined(AYA_USE_SIMD)
+				return Vector3x4(_mm_add_ps(m_val128[0], v.m_val128[0]),
+					_mm_add_ps(m_val128[1], v.m_val128[1]),
+					_mm_add_ps(m_val128[2], v.m_val128[2]));
+#else
+				Vector3x4 ret;
+				for (int a = 0; a < 3; a++)
+					for (int i = 0; i < 4; i++)
+						ret.m_val[a][i] = m_val[a][i] + v.m_val[a][i];
+				return ret;
+#endif
+			}
+			AYA_FORCE_INLINE Vector3x4 & operator += (const Vector3x4 &v) {
+				return *this = *this + v;
+			}
+			AYA_FORCE_INLINE Vector3x4 operator - (const Vector3x4 &v) const {
+#if defined(AYA_USE_SIMD)
+				return Vector3x4(_mm_sub_ps(m_val128[0], v.m_val128[0]),
+					_mm_sub_ps(m_val128[1], v.m_val128[1]),
+					_mm_sub_ps(m_val128[2], v.m_val128[2]));
+#else
+				Vector3x4 ret;
+				for (int a = 0; a < 3; a++)
+					for (int i = 0; i < 4; i++)
+						ret.m_val[a][i] = m_val[a][i] - v.m_val[a][i];
+				return ret;
+#endif
+			}
+			AYA_FORCE_INLINE Vector3x4 & operator -= (const Vector3x4 &v) {
+				return *this = *this - v;
+			}
+			AYA_FORCE_INLINE Vector3x4 operator- () const {
+#if defined(AYA_USE_SIMD)
+				return Vector3x4(_mm_xor_ps(m_val128[0], vMzeroMask),
+					_mm_xor_ps(m_val128[1], vMzeroMask),
+					_mm_xor_ps(m_val128[2], vMzeroMask));
+#else
+				Vector3x4 ret;
+				for (int a = 0; a < 3; a++)
+					for (int i = 0; i < 4; i++)
+						ret.m_val[a][i] = -m_val[a][i];
+				return ret;
+#endif
+			}
+			// Per-lane scale
+			AYA_FORCE_INLINE Vector3x4 operator * (const QuadWord &s) const {
+#if defined(AYA_USE_SIMD)
+				return Vector3x4(_mm_mul_ps(m_val128[0], s.m_val128),
+					_mm_mul_ps(m_val128[1], s.m_val128),
+					_mm_mul_ps(m_val128[2], s.m_val128));
+#else
+				Vector3x4 ret;
+				for (int a = 0; a < 3; a++)
+					for (int i = 0; i < 4; i++)
+						ret.m_val[a][i] = m_val[a][i] * s[i];
+				return ret;
+#endif
+			}
+			AYA_FORCE_INLINE Vector3x4 operator * (const float &s) const {
+#if defined(AYA_USE_SIMD)
+				return (*this) * QuadWord(_mm_set1_ps(s));
+#else
+				return (*this) * QuadWord(s, s, s, s);
+#endif
+			}
+			AYA_FORCE_INLINE friend Vector3x4 operator * (const float &s, const Vector3x4 &v) {
+				return v * s;
+			}
+			AYA_FORCE_INLINE Vector3x4 & operator *= (const float &s) {
+				return *this = *this * s;
+			}
+			AYA_FORCE_INLINE Vector3x4 operator / (const float &s) const {
+				assert(s != 0.f);
+				return (*this) * (1.f / s);
+			}
+			AYA_FORCE_INLINE Vector3x4 & operator /= (const float &s) {
+				assert(s != 0.f);
+				return *this *= (1.f / s);
+			}
+
+			AYA_FORCE_INLINE QuadWord dot(const Vector3x4 &v) const {
+#if defined(AYA_USE_SIMD)
+				__m128 d = _mm_mul_ps(m_val128[0], v.m_val128[0]);
+				d = _mm_add_ps(d, _mm_mul_ps(m_val128[1], v.m_val128[1]));
+				d = _mm_add_ps(d, _mm_mul_ps(m_val128[2], v.m_val128[2]));
+				return QuadWord(d);
+#else
+				QuadWord ret;
+				for (int i = 0; i < 4; i++)
+					ret[i] = m_val[0][i] * v.m_val[0][i] +
+					m_val[1][i] * v.m_val[1][i] +
+					m_val[2][i] * v.m_val[2][i];
+				return ret;
+#endif
+			}
+			AYA_FORCE_INLINE QuadWord length2() const {
+				return dot(*this);
+			}
+			AYA_FORCE_INLINE QuadWord length() const {
+#if defined(AYA_USE_SIMD)
+				return QuadWord(_mm_sqrt_ps(length2().m_val128));
+#else
+				QuadWord l2 = length2();
+				return QuadWord(Sqrt(l2[0]), Sqrt(l2[1]), Sqrt(l2[2]), Sqrt(l2[3]));
+#endif
+			}
+
+			AYA_FORCE_INLINE Vector3x4 cross(const Vector3x4 &v) const {
+#if defined(AYA_USE_SIMD)
+				return Vector3x4(
+					_mm_sub_ps(_mm_mul_ps(m_val128[1], v.m_val128[2]), _mm_mul_ps(m_val128[2], v.m_val128[1])),
+					_mm_sub_ps(_mm_mul_ps(m_val128[2], v.m_val128[0]), _mm_mul_ps(m_val128[0], v.m_val128[2])),
+					_mm_sub_ps(_mm_mul_ps(m_val128[0], v.m_val128[1]), _mm_mul_ps(m_val128[1], v.m_val128[0])));
+#else
+				Vector3x4 ret;
+				for (int i = 0; i < 4; i++) {
+					ret.m_val[0][i] = m_val[1][i] * v.m_val[2][i] - m_val[2][i] * v.m_val[1][i];
+					ret.m_val[1][i] = m_val[2][i] * v.m_val[0][i] - m_val[0][i] * v.m_val[2][i];
+					ret.m_val[2][i] = m_val[0][i] * v.m_val[1][i] - m_val[1][i] * v.m_val[0][i];
+				}
+				return ret;
+#endif
+			}
+
+			AYA_FORCE_INLINE Vector3x4 normalize() const {
+#if defined(AYA_USE_SIMD)
+				__m128 vd = length2().m_val128;
+
+				// one Newton-Raphson step on rsqrt, same as BaseVector3::normalize
+				__m128 y = _mm_rsqrt_ps(vd);
+				vd = _mm_mul_ps(_mm_mul_ps(vd, v0_5), _mm_mul_ps(y, y));
+				y = _mm_mul_ps(y, _mm_sub_ps(v1_5, vd));
+
+				return (*this) * QuadWord(y);
+#else
+				QuadWord l = length();
+				return (*this) * QuadWord(1.f / l[0], 1.f / l[1], 1.f / l[2], 1.f / l[3]);
+#endif
+			}
+			AYA_FORCE_INLINE void normalized() {
+				*this = normalize();
+			}
+
+			friend inline std::ostream &operator<<(std::ostream &os, const Vector3x4 &v) {
+				os << "[" << v.getVector(0) << ",\n";
+				os << " " << v.getVector(1) << ",\n";
+				os << " " << v.getVector(2) << ",\n";
+				os << " " << v.getVector(3) << "]";
+				return os;
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef AYA_MATH_VECTOR3X8_H
+#define AYA_MATH_VECTOR3X8_H
+
+#include "Vector3x4.h"
+
+#if defined(AYA_USE_AVX)
+namespace Aya {
+	// Eight BaseVector3 in structure-of-arrays layout, the AVX counterpart of Vector3x4.
+	// Per-lane scalar results are returned as raw __m256.
+		class AYA_ALIGN(32) Vector3x8 {
+		public:
+			union {
+				float m_val[3][8];
+				__m256 m_val256[3];
+			};
+
+		public:
+			Vector3x8() {}
+			AYA_FORCE_INLINE Vector3x8(const __m256 &x, const __m256 &y, const __m256 &z) {
+				m_val256[0] = x;
+				m_val256[1] = y;
+				m_val256[2] = z;
+			}
+			explicit AYA_FORCE_INLINE Vector3x8(const BaseVector3 &v) {
+				m_val256[0] = _mm256_set1_ps(v.x());
+				m_val256[1] = _mm256_set1_ps(v.y());
+				m_val256[2] = _mm256_set1_ps(v.z());
+			}
+			AYA_FORCE_INLINE Vector3x8(const Vector3x4 &lo, const Vector3x4 &hi) {
+				m_val256[0] = _mm256_insertf128_ps(_mm256_castps128_ps256(lo.m_val128[0]), hi.m_val128[0], 1);
+				m_val256[1] = _mm256_insertf128_ps(_mm256_castps128_ps256(lo.m_val128[1]), hi.m_val128[1], 1);
+				m_val256[2] = _mm256_insertf128_ps(_mm256_castps128_ps256(lo.m_val128[2]), hi.m_val128[2], 1);
+			}
+			AYA_FORCE_INLINE Vector3x8(const Vector3x8 &rhs) {
+				m_val256[0] = rhs.m_val256[0];
+				m_val256[1] = rhs.m_val256[1];
+				m_val256[2] = rhs.m_val256[2];
+			}
+			AYA_FORCE_INLINE Vector3x8& operator = (const Vector3x8 &rhs) {
+				m_val256[0] = rhs.m_val256[0];
+				m_val256[1] = rhs.m_val256[1];
+				m_val256[2] = rhs.m_val256[2];
+				return *this;
+			}
+
+			AYA_FORCE_INLINE void  *operator new(size_t i) {
+				return _mm_malloc(i, 32);
+			}
+
+			AYA_FORCE_INLINE void operator delete(void *p) {
+				_mm_free(p);
+			}
+
+			// Gather 8 consecutive Point3/Vector3/Normal3 from p
+			template<class T>
+			static AYA_FORCE_INLINE Vector3x8 load(const T *p) {
+				return Vector3x8(Vector3x4::load(p), Vector3x4::load(p + 4));
+			}
+			// Scatter the 8 lanes into consecutive Point3/Vector3/Normal3 at p, w is cleared
+			template<class T>
+			AYA_FORCE_INLINE void store(T *p) const {
+				getLow().store(p);
+				getHigh().store(p + 4);
+			}
+			AYA_FORCE_INLINE Vector3x4 getLow() const {
+				return Vector3x4(_mm256_castps256_ps128(m_val256[0]),
+					_mm256_castps256_ps128(m_val256[1]),
+					_mm256_castps256_ps128(m_val256[2]));
+			}
+			AYA_FORCE_INLINE Vector3x4 getHigh() const {
+				return Vector3x4(_mm256_extractf128_ps(m_val256[0], 1),
+					_mm256_extractf128_ps(m_val256[1], 1),
+					_mm256_extractf128_ps(m_val256[2], 1));
+			}
+			AYA_FORCE_INLINE BaseVector3 getVector(const int &i) const {
+				assert(i >= 0 && i < 8);
+				return BaseVector3(m_val[0][i], m_val[1][i], m_val[2][i]);
+			}
+
+			AYA_FORCE_INLINE __m256 x() const { return m_val256[0]; }
+			AYA_FORCE_INLINE __m256 y() const { return m_val256[1]; }
+			AYA_FORCE_INLINE __m256 z() const { return m_val256[2]; }
+
+			AYA_FORCE_INLINE void setMax(const Vector3x8 &v) {
+				m_val256[0] = _mm256_max_ps(m_val256[0], v.m_val256[0]);
+				m_val256[1] = _mm256_max_ps(m_val256[1], v.m_val256[1]);
+				m_val256[2] = _mm256_max_ps(m_val256[2], v.m_val256[2]);
+			}
+			AYA_FORCE_INLINE void setMin(const Vector3x8 &v) {
+				m_val256[0] = _mm256_min_ps(m_val256[0], v.m_val256[0]);
+				m_val256[1] = _mm256_min_ps(m_val256[1], v.m_val256[1]);
+				m_val256[2] = _mm256_min_ps(m_val256[2], v.m_val256[2]);
+			}
+			AYA_FORCE_INLINE void setZero() {
+				m_val256[0] = m_val256[1] = m_val256[2] = _mm256_setzero_ps();
+			}
+
+			AYA_FORCE_INLINE Vector3x8 operator + (const Vector3x8 &v) const {
+				return Vector3x8(_mm256_add_ps(m_val256[0], v.m_val256[0]),
+					_mm256_add_ps(m_val256[1], v.m_val256[1]),
+					_mm256_add_ps(m_val256[2], v.m_val256[2]));
+			}
+			AYA_FORCE_INLINE Vector3x8 & operator += (const Vector3x8 &v) {
+				return *this = *this + v;
+			}
+			AYA_FORCE_INLINE Vector3x8 operator - (const Vector3x8 &v) const {
+				return Vector3x8(_mm256_sub_ps(m_val256[0], v.m_val256[0]),
+					_mm256_sub_ps(m_val256[1], v.m_val256[1]),
+					_mm256_sub_ps(m_val256[2], v.m_val256[2]));
+			}
+			AYA_FORCE_INLINE Vector3x8 & operator -= (const Vector3x8 &v) {
+				return *this = *this - v;
+			}
+			AYA_FORCE_INLINE Vector3x8 operator- () const {
+				const __m256 mzero = _mm256_set1_ps(-0.f);
+				return Vector3x8(_mm256_xor_ps(m_val256[0], mzero),
+					_mm256_xor_ps(m_val256[1], mzero),
+					_mm256_xor_ps(m_val256[2], mzero));
+			}
+			// Per-lane scale
+			AYA_FORCE_INLINE Vector3x8 operator * (const __m256 &s) const {
+				return Vector3x8(_mm256_mul_ps(m_val256[0], s),
+					_mm256_mul_ps(m_val256[1], s),
+					_mm256_mul_ps(m_val256[2], s));
+			}
+			AYA_FORCE_INLINE Vector3x8 operator * (const float &s) const {
+				return (*this) * _mm256_set1_ps(s);
+			}
+			AYA_FORCE_INLINE friend Vector3x8 operator * (const float &s, const Vector3x8 &v) {
+				return v * s;
+			}
+			AYA_FORCE_INLINE Vector3x8 & operator *= (const float &s) {
+				return *this = *this * s;
+			}
+			AYA_FORCE_INLINE Vector3x8 operator / (const float &s) const {
+				assert(s != 0.f);
+				return (*this) * (1.f / s);
+			}
+			AYA_FORCE_INLINE Vector3x8 & operator /= (const float &s) {
+				assert(s != 0.f);
+				return *this *= (1.f / s);
+			}
+
+			AYA_FORCE_INLINE __m256 dot(const Vector3x8 &v) const {
+				__m256 d = _mm256_mul_ps(m_val256[0], v.m_val256[0]);
+				d = _mm256_add_ps(d, _mm256_mul_ps(m_val256[1], v.m_val256[1]));
+				return _mm256_add_ps(d, _mm256_mul_ps(m_val256[2], v.m_val256[2]));
+			}
+			AYA_FORCE_INLINE __m256 length2() const {
+				return dot(*this);
+			}
+			AYA_FORCE_INLINE __m256 length() const {
+				return _mm256_sqrt_ps(length2());
+			}
+
+			AYA_FORCE_INLINE Vector3x8 cross(const Vector3x8 &v) const {
+				return Vector3x8(
+					_mm256_sub_ps(_mm256_mul_ps(m_val256[1], v.m_val256[2]), _mm256_mul_ps(m_val256[2], v.m_val256[1])),
+					_mm256_sub_ps(_mm256_mul_ps(m_val256[2], v.m_val256[0]), _mm256_mul_ps(m_val256[0], v.m_val256[2])),
+					_mm256_sub_ps(_mm256_mul_ps(m_val256[0], v.m_val256[1]), _mm256_mul_ps(m_val256[1], v.m_val256[0])));
+			}
+
+			AYA_FORCE_INLINE Vector3x8 normalize() const {
+				__m256 vd = length2();
+
+				// one Newton-Raphson step on rsqrt, same as BaseVector3::normalize
+				__m256 y = _mm256_rsqrt_ps(vd);
+				vd = _mm256_mul_ps(_mm256_mul_ps(vd, _mm256_set1_ps(0.5f)), _mm256_mul_ps(y, y));
+				y = _mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(1.5f), vd));
+
+				return (*this) * y;
+			}
+			AYA_FORCE_INLINE void normalized() {
+				*this = normalize();
+			}
+
+			friend inline std::ostream &operator<<(std::ostream &os, const Vector3x8 &v) {
+				os << v.getLow() << ",\n" << v.getHigh();
+				return os;
+			}
+	};
+}
+#endif
+
+#endif
@@ -0,0 +1,254 @@
+#ifndef AYA_MATH_WARP_H
+#define AYA_MATH_WARP_H
+
+#include "Vector2.h"
+#include "Vector3x4.h"
+#include "Vector3x8.h"
+#include "SimdMath.h"
+#include "Parallel.h"
+
+namespace Aya {
+	// Warps of uniform samples u in [0, 1)^2 onto sampling domains, with the matching densities.
+	// Directions are in the local frame with z as the pole or normal (see Frame):
+	//
+	//   uniformSphere      pdf 1 / 4pi per solid angle
+	//   uniformHemisphere  z >= 0, pdf 1 / 2pi
+	//   cosineHemisphere   z >= 0, Malley's method over concentricDisk, pdf cos(theta) / pi
+	//   uniformCone        around z with cos(theta) >= cos_theta_max, pdf 1 / (2pi (1 - cos_theta_max))
+	//   concentricDisk     Shirley-Chiu mapping onto the unit disk, pdf 1 / pi per area
+	//   uniformTriangle    barycentrics (b0, b1), b2 = 1 - b0 - b1, with the low distortion split
+	//                      of Heitz, pdf 1 / area of the triangle
+	//
+	// Batches take the two sample dimensions as separate arrays and run 8 or 4 samples per
+	// packet, large arrays are split across threads. Single samples go through the same
+	// kernels and match the batches bit for bit.
+	class Warp {
+	public:
+		static const size_t s_parallel_grain = 1 << 14;
+
+	public:
+		static AYA_FORCE_INLINE BaseVector3 uniformSphere(const Vector2f &u) {
+			return direction(UniformSphereKernel(), u);
+		}
+		static AYA_FORCE_INLINE float uniformSpherePdf() {
+			return float(0.25 * M_1_PI);
+		}
+		static AYA_FORCE_INLINE BaseVector3 uniformHemisphere(const Vector2f &u) {
+			return direction(UniformHemisphereKernel(), u);
+		}
+		static AYA_FORCE_INLINE float uniformHemispherePdf() {
+			return float(0.5 * M_1_PI);
+		}
+		static AYA_FORCE_INLINE BaseVector3 cosineHemisphere(const Vector2f &u) {
+			return direction(CosineHemisphereKernel(), u);
+		}
+		static AYA_FORCE_INLINE float cosineHemispherePdf(const float &cos_theta) {
+			return cos_theta * float(M_1_PI);
+		}
+		static AYA_FORCE_INLINE BaseVector3 uniformCone(const Vector2f &u, const float &cos_theta_max) {
+			return direction(UniformConeKernel(cos_theta_max), u);
+		}
+		static AYA_FORCE_INLINE float uniformConePdf(const float &cos_theta_max) {
+			return 1.f / (float(2. * M_PI) * (1.f - cos_theta_max));
+		}
+		static AYA_FORCE_INLINE Vector2f concentricDisk(const Vector2f &u) {
+			return planar(ConcentricDiskKernel(), u);
+		}
+		static AYA_FORCE_INLINE float concentricDiskPdf() {
+			return float(M_1_PI);
+		}
+		static AYA_FORCE_INLINE Vector2f uniformTriangle(const Vector2f &u) {
+			return planar(UniformTriangleKernel(), u);
+		}
+		static AYA_FORCE_INLINE float uniformTrianglePdf(const float &area) {
+			return 1.f / area;
+		}
+
+		// Batched versions writing Point3/Vector3/Normal3 arrays, pdf may be nullptr
+		template<class T>
+		static void uniformSphere(const float *u0, const float *u1, T *out, float *pdf, const size_t &n) {
+			directions(UniformSphereKernel(), u0, u1, out, pdf, n);
+		}
+		template<class T>
+		static void uniformHemisphere(const float *u0, const float *u1, T *out, float *pdf, const size_t &n) {
+			directions(UniformHemisphereKernel(), u0, u1, out, pdf, n);
+		}
+		template<class T>
+		static void cosineHemisphere(const float *u0, const float *u1, T *out, float *pdf, const size_t &n) {
+			directions(CosineHemisphereKernel(), u0, u1, out, pdf, n);
+		}
+		template<class T>
+		static void uniformCone(const float *u0, const float *u1, const float &cos_theta_max, T *out, float *pdf, const size_t &n) {
+			directions(UniformConeKernel(cos_theta_max), u0, u1, out, pdf, n);
+		}
+		// Batched 2D warps, the two output coordinates are separate arrays as well
+		static void concentricDisk(const float *u0, const float *u1, float *x, float *y, const size_t &n) {
+			planars(ConcentricDiskKernel(), u0, u1, x, y, n);
+		}
+		static void uniformTriangle(const float *u0, const float *u1, float *b0, float *b1, const size_t &n) {
+			planars(UniformTriangleKernel(), u0, u1, b0, b1, n);
+		}
+
+	private:
+		// Kernels run on one lane type V (SimdMath::Scalar, __m128 or __m256). The direction
+		// kernels also return the pdf of the sample.
+		struct ConcentricDiskKernel {
+			template<class V>
+			AYA_FORCE_INLINE void operator() (const V &u0, const V &u1, V *x, V *y) const {
+				const V zero = SimdMath::splat(u0, 0.f);
+				const V one = SimdMath::splat(u0, 1.f);
+				const V a = SimdMath::madd(u0, SimdMath::splat(u0, 2.f), SimdMath::splat(u0, -1.f));
+				const V b = SimdMath::madd(u1, SimdMath::splat(u0, 2.f), SimdMath::splat(u0, -1.f));
+				// r = a, phi = pi/4 b/a when |a| > |b|, else r = b, phi = pi/2 - pi/4 a/b
+				const V wide = SimdMath::cmpGt(SimdMath::abs(a), SimdMath::abs(b));
+				const V r = SimdMath::select(wide, a, b);
+				const V den = SimdMath::select(SimdMath::cmpEq(r, zero), one, r);
+				const V q = SimdMath::mul(SimdMath::div(SimdMath::select(wide, b, a), den), SimdMath::splat(u0, float(M_PI * 0.25)));
+				const V phi = SimdMath::select(wide, q, SimdMath::sub(SimdMath::splat(u0, float(M_PI * 0.5)), q));
+				V s, c;
+				SimdMath::sincos(phi, &s, &c);
+				*x = SimdMath::mul(r, c);
+				*y = SimdMath::mul(r, s);
+			}
+		};
+		struct UniformTriangleKernel {
+			template<class V>
+			AYA_FORCE_INLINE void operator() (const V &u0, const V &u1, V *b0, V *b1) const {
+				// halve the smaller coordinate and shift the larger one by it
+				const V half = SimdMath::splat(u0, 0.5f);
+				const V lower = SimdMath::cmpLt(u0, u1);
+				const V h0 = SimdMath::mul(u0, half), h1 = SimdMath::mul(u1, half);
+				*b0 = SimdMath::select(lower, h0, SimdMath::sub(u0, h1));
+				*b1 = SimdMath::select(lower, SimdMath::sub(u1, h0), h1);
+			}
+		};
+		struct UniformSphereKernel {
+			template<class V>
+			AYA_FORCE_INLINE void operator() (const V &u0, const V &u1, V *x, V *y, V *z, V *pdf) const {
+				const V cos_theta = SimdMath::madd(u0, SimdMath::splat(u0, -2.f), SimdMath::splat(u0, 1.f));
+				ring(u1, cos_theta, x, y);
+				*z = cos_theta;
+				*pdf = SimdMath::splat(u0, uniformSpherePdf());
+			}
+		};
+		struct UniformHemisphereKernel {
+			template<class V>
+			AYA_FORCE_INLINE void operator() (const V &u0, const V &u1, V *x, V *y, V *z, V *pdf) const {
+				ring(u1, u0, x, y);
+				*z = u0;
+				*pdf = SimdMath::splat(u0, uniformHemispherePdf());
+			}
+		};
+		struct CosineHemisphereKernel {
+			template<class V>
+			AYA_FORCE_INLINE void operator() (const V &u0, const V &u1, V *x, V *y, V *z, V *pdf) const {
+				ConcentricDiskKernel()(u0, u1, x, y);
+				const V r2 = SimdMath::madd(*x, *x, SimdMath::mul(*y, *y));
+				*z = SimdMath::sqrt(SimdMath::max(SimdMath::sub(SimdMath::splat(u0, 1.f), r2), SimdMath::splat(u0, 0.f)));
+				*pdf = SimdMath::mul(*z, SimdMath::splat(u0, float(M_1_PI)));
+			}
+		};
+		struct UniformConeKernel {
+			float m_cos_theta_max, m_pdf;
+
+			explicit AYA_FORCE_INLINE UniformConeKernel(const float &cos_theta_max) :
+				m_cos_theta_max(cos_theta_max), m_pdf(uniformConePdf(cos_theta_max)) {}
+
+			template<class V>
+			AYA_FORCE_INLINE void operator() (const V &u0, const V &u1, V *x, V *y, V *z, V *pdf) const {
+				// cos(theta) = (1 - u0) + u0 cos_theta_max
+				const V one = SimdMath::splat(u0, 1.f);
+				const V cos_theta = SimdMath::madd(u0, SimdMath::splat(u0, m_cos_theta_max - 1.f), one);
+				ring(u1, cos_theta, x, y);
+				*z = cos_theta;
+				*pdf = SimdMath::splat(u0, m_pdf);
+			}
+		};
+
+		// (x, y) of the direction at height cos_theta and azimuth 2pi u
+		template<class V>
+		static AYA_FORCE_INLINE void ring(const V &u, const V &cos_theta, V *x, V *y) {
+			const V sin_theta = SimdMath::sqrt(SimdMath::max(
+				SimdMath::sub(SimdMath::splat(u, 1.f), SimdMath::mul(cos_theta, cos_theta)), SimdMath::splat(u, 0.f)));
+			V s, c;
+			SimdMath::sincos(SimdMath::mul(u, SimdMath::splat(u, float(2. * M_PI))), &s, &c);
+			*x = SimdMath::mul(sin_theta, c);
+			*y = SimdMath::mul(sin_theta, s);
+		}
+
+		template<class K>
+		static AYA_FORCE_INLINE BaseVector3 direction(const K &kernel, const Vector2f &u) {
+			SimdMath::Scalar x, y, z, pdf;
+			kernel(SimdMath::toScalar(u.x), SimdMath::toScalar(u.y), &x, &y, &z, &pdf);
+			return BaseVector3(SimdMath::fromScalar(x), SimdMath::fromScalar(y), SimdMath::fromScalar(z));
+		}
+		template<class K>
+		static AYA_FORCE_INLINE Vector2f planar(const K &kernel, const Vector2f &u) {
+			SimdMath::Scalar x, y;
+			kernel(SimdMath::toScalar(u.x), SimdMath::toScalar(u.y), &x, &y);
+			return Vector2f(SimdMath::fromScalar(x), SimdMath::fromScalar(y));
+		}
+
+		template<class K, class T>
+		static void directions(const K &kernel, const float *u0, const float *u1, T *out, float *pdf, const size_t &n) {
+			ParallelFor(n, s_parallel_grain, [=](const size_t &begin, const size_t &end) {
+				size_t i = begin;
+#if defined(AYA_USE_AVX)
+				for (; i + 8 <= end; i += 8) {
+					__m256 x, y, z, p;
+					kernel(_mm256_loadu_ps(u0 + i), _mm256_loadu_ps(u1 + i), &x, &y, &z, &p);
+					Vector3x8(x, y, z).store(out + i);
+					if (pdf)
+						_mm256_storeu_ps(pdf + i, p);
+				}
+#endif
+#if defined(AYA_USE_SIMD)
+				for (; i + 4 <= end; i += 4) {
+					__m128 x, y, z, p;
+					kernel(_mm_loadu_ps(u0 + i), _mm_loadu_ps(u1 + i), &x, &y, &z, &p);
+					Vector3x4(x, y, z).store(out + i);
+					if (pdf)
+						_mm_storeu_ps(pdf + i, p);
+				}
+#endif
+				for (; i < end; i++) {
+					SimdMath::Scalar x, y, z, p;
+					kernel(SimdMath::toScalar(u0[i]), SimdMath::toScalar(u1[i]), &x, &y, &z, &p);
+					out[i] = T(SimdMath::fromScalar(x), SimdMath::fromScalar(y), SimdMath::fromScalar(z));
+					if (pdf)
+						pdf[i] = SimdMath::fromScalar(p);
+				}
+			});
+		}
+		template<class K>
+		static void planars(const K &kernel, const float *u0, const float *u1, float *x, float *y, const size_t &n) {
+			ParallelFor(n, s_parallel_grain, [=](const size_t &begin, const size_t &end) {
+				size_t i = begin;
+#if defined(AYA_USE_AVX)
+				for (; i + 8 <= end; i += 8) {
+					__m256 a, b;
+					kernel(_mm256_loadu_ps(u0 + i), _mm256_loadu_ps(u1 + i), &a, &b);
+					_mm256_storeu_ps(x + i, a);
+					_mm256_storeu_ps(y + i, b);
+				}
+#endif
+#if defined(AYA_USE_SIMD)
+				for (; i + 4 <= end; i += 4) {
+					__m128 a, b;
+					kernel(_mm_loadu_ps(u0 + i), _mm_loadu_ps(u1 + i), &a, &b);
+					_mm_storeu_ps(x + i, a);
+					_mm_storeu_ps(y + i, b);
+				}
+#endif
+				for (; i < end; i++) {
+					SimdMath::Scalar a, b;
+					kernel(SimdMath::toScalar(u0[i]), SimdMath::toScalar(u1[i]), &a, &b);
+					x[i] = SimdMath::fromScalar(a);
+					y[i] = SimdMath::fromScalar(b);
+				}
+			});
+		}
+	};
+}
+
+#endif